@@ -0,0 +1,90 @@
+#include "barramento_i2c.h"
+
+void barramento_i2c_init(barramento_i2c_t *b, i2c_backend_t backend, uint32_t baudrate, uint64_t (*relogio_us)(void)) {
+    b->backend = backend;
+    b->relogio_us = relogio_us;
+    b->baudrate = baudrate;
+    for (int i = 0; i < BARRAMENTO_MAX_TRANSACOES; i++)
+        b->ocupado[i] = false;
+    b->proxima_ordem = 0;
+    b->transacoes = 0;
+    b->erros = 0;
+    b->maior_transacao_us = 0;
+}
+
+bool barramento_i2c_enfileirar(barramento_i2c_t *b, const i2c_transacao_t *t) {
+    for (int i = 0; i < BARRAMENTO_MAX_TRANSACOES; i++) {
+        if (!b->ocupado[i]) {
+            b->fila[i] = *t;
+            b->ordem[i] = b->proxima_ordem++;
+            b->ocupado[i] = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Escolhe a transação de maior prioridade; empate vai para a mais antiga
+static int escolher(const barramento_i2c_t *b) {
+    int melhor = -1;
+    for (int i = 0; i < BARRAMENTO_MAX_TRANSACOES; i++) {
+        if (!b->ocupado[i])
+            continue;
+        if (melhor < 0 ||
+            b->fila[i].prioridade < b->fila[melhor].prioridade ||
+            (b->fila[i].prioridade == b->fila[melhor].prioridade &&
+             (int32_t)(b->ordem[i] - b->ordem[melhor]) < 0))
+            melhor = i;
+    }
+    return melhor;
+}
+
+// Limite de tempo: o dobro da duração nominal (9 bits por byte + endereço) com folga fixa
+static uint32_t timeout_us(const barramento_i2c_t *b, size_t len) {
+    return (uint32_t)(((len + 1) * 9u * 1000000u) / b->baudrate) * 2u + 500u;
+}
+
+bool barramento_i2c_executar_proxima(barramento_i2c_t *b) {
+    int i = escolher(b);
+    if (i < 0)
+        return false;
+    // Copia e libera o slot antes de chamar callbacks, que podem enfileirar a próxima etapa
+    i2c_transacao_t t = b->fila[i];
+    b->ocupado[i] = false;
+
+    if (t.preparar)
+        t.preparar(t.ctx);
+    uint64_t inicio = b->relogio_us();
+    int resultado;
+    if (t.leitura)
+        resultado = b->backend.ler(b->backend.ctx, t.endereco, t.dados, t.len, timeout_us(b, t.len));
+    else
+        resultado = b->backend.escrever(b->backend.ctx, t.endereco, t.dados, t.len, timeout_us(b, t.len));
+    uint64_t fim = b->relogio_us();
+
+    uint32_t duracao = (uint32_t)(fim - inicio);
+    if (duracao > b->maior_transacao_us)
+        b->maior_transacao_us = duracao;
+    b->transacoes++;
+    if (resultado < 0)
+        b->erros++;
+    if (t.concluido)
+        t.concluido(t.ctx, resultado, fim);
+    return true;
+}
+
+void barramento_i2c_processar(barramento_i2c_t *b, uint32_t orcamento_us) {
+    uint64_t inicio = b->relogio_us();
+    while (b->relogio_us() - inicio < orcamento_us) {
+        if (!barramento_i2c_executar_proxima(b))
+            break;
+    }
+}
+
+bool barramento_i2c_ocioso(const barramento_i2c_t *b) {
+    for (int i = 0; i < BARRAMENTO_MAX_TRANSACOES; i++) {
+        if (b->ocupado[i])
+            return false;
+    }
+    return true;
+}
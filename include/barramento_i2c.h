@@ -0,0 +1,66 @@
+#ifndef BARRAMENTO_I2C_H
+#define BARRAMENTO_I2C_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//===============================================
+// Gerenciador do barramento I2C compartilhado (OLED + sensores)
+//
+// Todo acesso ao barramento passa por uma fila de transações com
+// prioridade. Cada transação é curta (o OLED envia o quadro em pedaços),
+// então uma transação de alta prioridade espera no máximo um pedaço.
+// O acesso físico fica atrás de um backend (hardware ou simulado), o que
+// permite rodar drivers e escalonador fora do RP2040.
+//===============================================
+#define BARRAMENTO_MAX_TRANSACOES 16
+
+typedef enum {
+    I2C_PRIO_ALTA = 0,     // Sensores com prazo de leitura
+    I2C_PRIO_NORMAL,
+    I2C_PRIO_BAIXA,        // Atualização do OLED
+    I2C_NUM_PRIORIDADES
+} i2c_prioridade_t;
+
+typedef struct {
+    // Retornam o número de bytes transferidos ou valor negativo em erro/NACK
+    int (*escrever)(void *ctx, uint8_t endereco, const uint8_t *dados, size_t len, uint32_t timeout_us);
+    int (*ler)(void *ctx, uint8_t endereco, uint8_t *dados, size_t len, uint32_t timeout_us);
+    void *ctx;
+} i2c_backend_t;
+
+typedef void (*i2c_preparar_t)(void *ctx);
+typedef void (*i2c_concluido_t)(void *ctx, int resultado, uint64_t instante_us);
+
+typedef struct {
+    uint8_t endereco;
+    uint8_t prioridade;        // i2c_prioridade_t
+    bool leitura;
+    uint8_t *dados;            // Origem (escrita) ou destino (leitura)
+    size_t len;
+    i2c_preparar_t preparar;   // Opcional: chamado logo antes da transferência
+    i2c_concluido_t concluido; // Opcional: chamado com o resultado
+    void *ctx;
+} i2c_transacao_t;
+
+typedef struct {
+    i2c_backend_t backend;
+    uint64_t (*relogio_us)(void);
+    uint32_t baudrate;
+    i2c_transacao_t fila[BARRAMENTO_MAX_TRANSACOES];
+    uint32_t ordem[BARRAMENTO_MAX_TRANSACOES];   // Desempate FIFO dentro da prioridade
+    bool ocupado[BARRAMENTO_MAX_TRANSACOES];
+    uint32_t proxima_ordem;
+    uint32_t transacoes;
+    uint32_t erros;
+    uint32_t maior_transacao_us;
+} barramento_i2c_t;
+
+void barramento_i2c_init(barramento_i2c_t *b, i2c_backend_t backend, uint32_t baudrate, uint64_t (*relogio_us)(void));
+bool barramento_i2c_enfileirar(barramento_i2c_t *b, const i2c_transacao_t *t);
+bool barramento_i2c_executar_proxima(barramento_i2c_t *b);
+void barramento_i2c_processar(barramento_i2c_t *b, uint32_t orcamento_us);
+bool barramento_i2c_ocioso(const barramento_i2c_t *b);
+
+#endif
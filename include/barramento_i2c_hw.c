@@ -0,0 +1,23 @@
+#include "barramento_i2c_hw.h"
+#include "hardware/timer.h"
+
+static int escrever_hw(void *ctx, uint8_t endereco, const uint8_t *dados, size_t len, uint32_t timeout_us) {
+    return i2c_write_timeout_us((i2c_inst_t *)ctx, endereco, dados, len, false, timeout_us);
+}
+
+static int ler_hw(void *ctx, uint8_t endereco, uint8_t *dados, size_t len, uint32_t timeout_us) {
+    return i2c_read_timeout_us((i2c_inst_t *)ctx, endereco, dados, len, false, timeout_us);
+}
+
+i2c_backend_t barramento_i2c_backend_hw(i2c_inst_t *i2c) {
+    i2c_backend_t backend = {
+        .escrever = escrever_hw,
+        .ler = ler_hw,
+        .ctx = i2c,
+    };
+    return backend;
+}
+
+uint64_t barramento_i2c_relogio_hw(void) {
+    return time_us_64();
+}
@@ -0,0 +1,11 @@
+#ifndef BARRAMENTO_I2C_HW_H
+#define BARRAMENTO_I2C_HW_H
+
+#include "barramento_i2c.h"
+#include "hardware/i2c.h"
+
+// Backend do barramento sobre o periférico I2C do RP2040 (com tempo limite)
+i2c_backend_t barramento_i2c_backend_hw(i2c_inst_t *i2c);
+uint64_t barramento_i2c_relogio_hw(void);
+
+#endif
@@ -0,0 +1,147 @@
+#include "bench.h"
+#include "calibracao.h"
+#include "zonas.h"
+#include "hardware/structs/xip_ctrl.h"
+#include <stdio.h>
+
+static volatile float sumidouro;   // Impede que o compilador descarte as conversões
+
+//===============================================
+// Custo por amostra da conversão ADC -> unidade, varrendo os 4096 códigos:
+//   - float: conversão linear original ((adc / 4095) * fundo de escala)
+//   - tabela: busca + interpolação direta nos pontos de calibração
+//   - LUT: tabela segmentada pré-calculada (com e sem interpolação)
+//===============================================
+void bench_calibracao(void) {
+    const int n = CAL_ADC_MAX + 1;
+    for (int c = 0; c < CAL_NUM_CANAIS; c++) {
+        const cal_tabela_t *tabela = calibracao_tabela((cal_canal_t)c);
+        float fundo = tabela->pontos[tabela->num_pontos - 1].valor;
+
+        uint32_t t0 = bench_ciclos();
+        for (int adc = 0; adc < n; adc++)
+            sumidouro = (adc / 4095.0f) * fundo;
+        uint32_t ciclos_float = bench_decorrido(t0);
+
+        t0 = bench_ciclos();
+        for (int adc = 0; adc < n; adc++)
+            sumidouro = calibracao_avaliar(tabela, (uint16_t)adc);
+        uint32_t ciclos_tabela = bench_decorrido(t0);
+
+        t0 = bench_ciclos();
+        for (int adc = 0; adc < n; adc++)
+            sumidouro = calibracao_converter((cal_canal_t)c, (uint16_t)adc);
+        uint32_t ciclos_lut = bench_decorrido(t0);
+
+        t0 = bench_ciclos();
+        for (int adc = 0; adc < n; adc++)
+            sumidouro = calibracao_converter_bruto((cal_canal_t)c, (uint16_t)adc);
+        uint32_t ciclos_bruto = bench_decorrido(t0);
+
+        printf("cal canal %d: float %lu, tabela %lu, lut %lu, lut s/ interp %lu ciclos/amostra\n",
+               c,
+               (unsigned long)(ciclos_float / n),
+               (unsigned long)(ciclos_tabela / n),
+               (unsigned long)(ciclos_lut / n),
+               (unsigned long)(ciclos_bruto / n));
+    }
+}
+
+//===============================================
+// Custo de um ciclo de zonas_processar para 1..NUM_ZONAS zonas, em ciclos
+// por ciclo e por zona. Medidas alternam entre as faixas para exercitar
+// os dois lados de cada comparação.
+//===============================================
+static zonas_t zonas_bench;
+static zona_limites_t limites_bench;
+
+void bench_zonas(void) {
+    const int repeticoes = 64;
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        for (int z = 0; z < NUM_ZONAS; z++) {
+            limites_bench.inferior[s][z] = 10.0f;
+            limites_bench.superior[s][z] = 20.0f;
+            zonas_bench.valor[s][z] = (float)((s + z) % 3) * 10.0f + 5.0f;
+        }
+    }
+    for (int n = 1; n <= NUM_ZONAS; n++) {
+        zonas_init(&zonas_bench, NULL);
+        uint32_t t0 = bench_ciclos();
+        for (int r = 0; r < repeticoes; r++)
+            zonas_processar(&zonas_bench, &limites_bench, (uint8_t)n);
+        uint32_t ciclos = bench_decorrido(t0) / repeticoes;
+        printf("zonas %2d: %lu ciclos/ciclo, %lu ciclos/zona\n",
+               n, (unsigned long)ciclos, (unsigned long)(ciclos / n));
+    }
+}
+
+typedef struct {
+    uint32_t amostras;
+    uint32_t minimo;
+    uint32_t maximo;
+    uint64_t soma;
+    uint32_t acessos_xip;
+    uint32_t acertos_xip;
+    // Valores no início da medição em andamento
+    uint32_t ciclos0;
+    uint32_t acessos0;
+    uint32_t acertos0;
+} bench_medida_t;
+
+static bench_medida_t medidas[NUM_ESTAGIOS];
+static const char *const NOME_ESTAGIO[NUM_ESTAGIOS] = {
+    "leitura", "classificacao", "desenho", "matriz", "barramento",
+};
+
+void bench_estagio_inicio(bench_estagio_t estagio) {
+    bench_medida_t *m = &medidas[estagio];
+    m->acessos0 = xip_ctrl_hw->ctr_acc;
+    m->acertos0 = xip_ctrl_hw->ctr_hit;
+    m->ciclos0 = bench_ciclos();
+}
+
+void bench_estagio_fim(bench_estagio_t estagio) {
+    bench_medida_t *m = &medidas[estagio];
+    uint32_t ciclos = bench_decorrido(m->ciclos0);
+    m->acessos_xip += xip_ctrl_hw->ctr_acc - m->acessos0;
+    m->acertos_xip += xip_ctrl_hw->ctr_hit - m->acertos0;
+    if (m->amostras == 0 || ciclos < m->minimo)
+        m->minimo = ciclos;
+    if (ciclos > m->maximo)
+        m->maximo = ciclos;
+    m->soma += ciclos;
+    m->amostras++;
+}
+
+// Imprime e zera as estatísticas de cada estágio
+void bench_relatorio(uint32_t irq_ciclos_max) {
+#ifdef FRUITLIFE_RAM_HOT
+    const int ram_hot = 1;
+#else
+    const int ram_hot = 0;
+#endif
+#ifdef FRUITLIFE_COPY_TO_RAM
+    const int copy_to_ram = 1;
+#else
+    const int copy_to_ram = 0;
+#endif
+    printf("bench: RAM_HOT=%d COPY_TO_RAM=%d irq_max=%lu ciclos\n",
+           ram_hot, copy_to_ram, (unsigned long)irq_ciclos_max);
+    for (int e = 0; e < NUM_ESTAGIOS; e++) {
+        bench_medida_t *m = &medidas[e];
+        if (m->amostras == 0)
+            continue;
+        uint32_t falhas = m->acessos_xip - m->acertos_xip;
+        printf("  %-13s n=%lu med=%lu min=%lu max=%lu jitter=%lu xip acc=%lu hit=%lu falha=%lu\n",
+               NOME_ESTAGIO[e],
+               (unsigned long)m->amostras,
+               (unsigned long)(m->soma / m->amostras),
+               (unsigned long)m->minimo,
+               (unsigned long)m->maximo,
+               (unsigned long)(m->maximo - m->minimo),
+               (unsigned long)m->acessos_xip,
+               (unsigned long)m->acertos_xip,
+               (unsigned long)falhas);
+        *m = (bench_medida_t){0};
+    }
+}
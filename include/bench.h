@@ -0,0 +1,48 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include "hardware/structs/systick.h"
+
+//===============================================
+// Medição de ciclos com o SysTick (decrescente, 24 bits, clk_sys).
+// O SysTick precisa estar habilitado com recarga 0x00FFFFFF.
+//===============================================
+static inline uint32_t bench_ciclos(void) {
+    return systick_hw->cvr;
+}
+
+static inline uint32_t bench_decorrido(uint32_t inicio) {
+    return (inicio - systick_hw->cvr) & 0x00FFFFFFu;
+}
+
+// Benchmarks executados na inicialização quando FRUITLIFE_BENCH está definido
+void bench_calibracao(void);
+void bench_zonas(void);
+
+//===============================================
+// Estágios do laço principal: ciclos (mínimo, médio, máximo e jitter) e
+// contadores da cache XIP (acessos e acertos) acumulados por estágio.
+//===============================================
+typedef enum {
+    ESTAGIO_LEITURA = 0,     // ADC + conversão por LUT
+    ESTAGIO_CLASSIFICACAO,
+    ESTAGIO_DESENHO,         // Framebuffer do OLED
+    ESTAGIO_MATRIZ,          // WS2812
+    ESTAGIO_BARRAMENTO,      // Transações I2C
+    NUM_ESTAGIOS
+} bench_estagio_t;
+
+void bench_estagio_inicio(bench_estagio_t estagio);
+void bench_estagio_fim(bench_estagio_t estagio);
+void bench_relatorio(uint32_t irq_ciclos_max);
+
+#ifdef FRUITLIFE_BENCH
+#define BENCH_INICIO(estagio) bench_estagio_inicio(estagio)
+#define BENCH_FIM(estagio) bench_estagio_fim(estagio)
+#else
+#define BENCH_INICIO(estagio) ((void)0)
+#define BENCH_FIM(estagio) ((void)0)
+#endif
+
+#endif
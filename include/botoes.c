@@ -0,0 +1,113 @@
+#include "botoes.h"
+#include "secoes.h"
+#include <string.h>
+
+// Tudo o que botoes_amostrar chama roda na IRQ do amostrador: com
+// FRUITLIFE_RAM_HOT vai para a SRAM junto com ela, sem buscas na XIP
+
+static void FUNCAO_RAPIDA(emitir)(botoes_t *bt, uint8_t tipo, uint8_t botao, uint8_t mascara, uint16_t repeticoes, uint32_t agora_ms) {
+    evento_botao_t ev = {
+        .tipo = tipo,
+        .botao = botao,
+        .mascara = mascara,
+        .repeticoes = repeticoes,
+        .tempo_ms = agora_ms,
+    };
+    bt->emitir(&ev);
+}
+
+void botoes_init(botoes_t *bt, uint8_t n, uint8_t mascara_repeticao, botoes_emitir_t emitir_cb) {
+    memset(bt, 0, sizeof(*bt));
+    bt->n = n > BOTOES_MAX ? BOTOES_MAX : n;
+    bt->mascara_repeticao = mascara_repeticao;
+    bt->emitir = emitir_cb;
+}
+
+static void FUNCAO_RAPIDA(ao_pressionar)(botoes_t *bt, uint8_t i, uint32_t agora_ms) {
+    botao_estado_t *s = &bt->b[i];
+    uint8_t bit = (uint8_t)(1u << i);
+    s->estavel = true;
+    s->longo_emitido = false;
+    s->repeticoes = 0;
+    s->t_pressionado = agora_ms;
+    s->t_proxima_rep = agora_ms + BOTOES_REP_ATRASO_MS;
+    s->intervalo_rep = BOTOES_REP_INICIAL_MS;
+
+    if (bt->mascara_estavel) {
+        // Outro botão já está pressionado: vira combo e suprime os individuais
+        bt->mascara_estavel |= bit;
+        for (uint8_t j = 0; j < bt->n; j++) {
+            if (bt->mascara_estavel & (1u << j))
+                bt->b[j].em_combo = true;
+        }
+        emitir(bt, BOTAO_EV_COMBO, i, bt->mascara_estavel, 0, agora_ms);
+    } else {
+        bt->mascara_estavel |= bit;
+        emitir(bt, BOTAO_EV_PRESSIONADO, i, bit, 0, agora_ms);
+    }
+}
+
+static void FUNCAO_RAPIDA(ao_soltar)(botoes_t *bt, uint8_t i, uint32_t agora_ms) {
+    botao_estado_t *s = &bt->b[i];
+    uint8_t bit = (uint8_t)(1u << i);
+    s->estavel = false;
+    bt->mascara_estavel &= (uint8_t)~bit;
+    if (s->em_combo) {
+        s->em_combo = false;
+        return;
+    }
+    emitir(bt, BOTAO_EV_SOLTO, i, bit, s->repeticoes, agora_ms);
+    if (!s->longo_emitido)
+        emitir(bt, BOTAO_EV_CLIQUE, i, bit, 0, agora_ms);
+}
+
+static void FUNCAO_RAPIDA(enquanto_pressionado)(botoes_t *bt, uint8_t i, uint32_t agora_ms) {
+    botao_estado_t *s = &bt->b[i];
+    uint8_t bit = (uint8_t)(1u << i);
+    if (s->em_combo)
+        return;
+    if (!s->longo_emitido && agora_ms - s->t_pressionado >= BOTOES_LONGO_MS) {
+        s->longo_emitido = true;
+        emitir(bt, BOTAO_EV_LONGO, i, bit, s->repeticoes, agora_ms);
+    }
+    if ((bt->mascara_repeticao & bit) && (int32_t)(agora_ms - s->t_proxima_rep) >= 0) {
+        s->repeticoes++;
+        emitir(bt, BOTAO_EV_REPETICAO, i, bit, s->repeticoes, agora_ms);
+        // Cada repetição encurta o intervalo em 25% até o mínimo
+        s->t_proxima_rep += s->intervalo_rep;
+        s->intervalo_rep = s->intervalo_rep * 3 / 4;
+        if (s->intervalo_rep < BOTOES_REP_MINIMO_MS)
+            s->intervalo_rep = BOTOES_REP_MINIMO_MS;
+    }
+}
+
+void FUNCAO_RAPIDA(botoes_amostrar)(botoes_t *bt, uint8_t pressionados, uint32_t agora_ms) {
+    for (uint8_t i = 0; i < bt->n; i++) {
+        botao_estado_t *s = &bt->b[i];
+        bool bruto = (pressionados >> i) & 1u;
+
+        // Integrador: sobe enquanto a leitura difere do estado estável e
+        // desce quando concorda, de modo que um repique isolado não zera a
+        // contagem nem o instante da primeira borda.
+        if (bruto != s->estavel) {
+            if (s->integrador == 0)
+                s->t_borda = agora_ms;
+            if (++s->integrador >= BOTOES_AMOSTRAS_DEBOUNCE) {
+                s->integrador = 0;
+                uint32_t latencia = agora_ms - s->t_borda;
+                if (latencia > bt->latencia_max_ms)
+                    bt->latencia_max_ms = latencia;
+                if (bruto)
+                    ao_pressionar(bt, i, agora_ms);
+                else
+                    ao_soltar(bt, i, agora_ms);
+                continue;
+            }
+        } else if (s->integrador > 0) {
+            s->integrador--;
+        }
+
+        if (s->estavel)
+            enquanto_pressionado(bt, i, agora_ms);
+    }
+}
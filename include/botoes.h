@@ -0,0 +1,67 @@
+#ifndef BOTOES_H
+#define BOTOES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Motor de entrada dos botões
+//
+// Alimentado por um amostrador periódico (não por bordas): cada botão tem
+// seu próprio integrador de debounce, então um botão ruidoso não bloqueia
+// os outros. Gera eventos de pressionar, soltar, clique, pressão longa,
+// auto-repetição acelerada e combinações (dois ou mais botões juntos).
+// Não depende do SDK, apenas da máscara de botões e do tempo em ms.
+//===============================================
+#define BOTOES_MAX 8
+
+#define BOTOES_AMOSTRAS_DEBOUNCE 4    // Amostras consecutivas para trocar de estado
+#define BOTOES_LONGO_MS 800           // Pressão longa
+#define BOTOES_REP_ATRASO_MS 500      // Primeira repetição
+#define BOTOES_REP_INICIAL_MS 250     // Intervalo da segunda repetição
+#define BOTOES_REP_MINIMO_MS 40       // Intervalo mínimo (aceleração máxima)
+
+typedef enum {
+    BOTAO_EV_PRESSIONADO,
+    BOTAO_EV_SOLTO,
+    BOTAO_EV_CLIQUE,       // Solto antes de BOTOES_LONGO_MS
+    BOTAO_EV_LONGO,
+    BOTAO_EV_REPETICAO,
+    BOTAO_EV_COMBO         // mascara contém todos os botões pressionados
+} botao_evento_tipo_t;
+
+typedef struct {
+    uint8_t tipo;          // botao_evento_tipo_t
+    uint8_t botao;         // Índice do botão que gerou o evento
+    uint8_t mascara;       // Botões envolvidos (bit i = botão i)
+    uint16_t repeticoes;   // Quantidade de repetições desde a pressão
+    uint32_t tempo_ms;     // Instante da amostra que gerou o evento
+} evento_botao_t;
+
+typedef void (*botoes_emitir_t)(const evento_botao_t *ev);
+
+typedef struct {
+    uint8_t integrador;
+    bool estavel;           // Estado após debounce
+    bool em_combo;          // Participa de um combo: eventos individuais suprimidos
+    bool longo_emitido;
+    uint32_t t_borda;       // Primeira amostra bruta diferente do estado estável
+    uint32_t t_pressionado;
+    uint32_t t_proxima_rep;
+    uint32_t intervalo_rep;
+    uint16_t repeticoes;
+} botao_estado_t;
+
+typedef struct {
+    botao_estado_t b[BOTOES_MAX];
+    uint8_t n;
+    uint8_t mascara_repeticao;  // Botões com auto-repetição
+    uint8_t mascara_estavel;
+    uint32_t latencia_max_ms;   // Pior caso entre a primeira borda e o evento
+    botoes_emitir_t emitir;
+} botoes_t;
+
+void botoes_init(botoes_t *bt, uint8_t n, uint8_t mascara_repeticao, botoes_emitir_t emitir);
+void botoes_amostrar(botoes_t *bt, uint8_t pressionados, uint32_t agora_ms);
+
+#endif
@@ -0,0 +1,96 @@
+#include "calibracao.h"
+#include "secoes.h"
+
+static cal_tabela_t tabelas[CAL_NUM_CANAIS];
+static float lut_base[CAL_NUM_CANAIS][CAL_SEGMENTOS];
+static float lut_inclinacao[CAL_NUM_CANAIS][CAL_SEGMENTOS];
+
+// Fundo de escala dos potenciômetros (equivalente à conversão linear original)
+static const float FUNDO_ESCALA[CAL_NUM_CANAIS] = {
+    [CAL_ETILENO] = 10.0f,
+    [CAL_TEMP] = 40.0f,
+    [CAL_UMIDADE] = 100.0f,
+    [CAL_CO2] = 1000.0f,
+};
+
+void calibracao_init(void) {
+    for (int c = 0; c < CAL_NUM_CANAIS; c++) {
+        cal_tabela_t padrao = {
+            .pontos = { {0, 0.0f}, {CAL_ADC_MAX, FUNDO_ESCALA[c]} },
+            .num_pontos = 2,
+            .ganho = 1.0f,
+            .offset = 0.0f,
+        };
+        calibracao_carregar((cal_canal_t)c, &padrao);
+    }
+}
+
+// Interpolação linear entre os pontos; fora da faixa extrapola pelo trecho da ponta
+static float avaliar_curva(const cal_tabela_t *tabela, uint16_t adc) {
+    const cal_ponto_t *p = tabela->pontos;
+    uint8_t i = 1;
+    while (i < tabela->num_pontos - 1 && adc > p[i].adc)
+        i++;
+    float t = ((float)adc - p[i - 1].adc) / (float)(p[i].adc - p[i - 1].adc);
+    return p[i - 1].valor + t * (p[i].valor - p[i - 1].valor);
+}
+
+float calibracao_avaliar(const cal_tabela_t *tabela, uint16_t adc) {
+    return avaliar_curva(tabela, adc) * tabela->ganho + tabela->offset;
+}
+
+bool calibracao_carregar(cal_canal_t canal, const cal_tabela_t *tabela) {
+    if (canal >= CAL_NUM_CANAIS || tabela->num_pontos < 2 || tabela->num_pontos > CAL_MAX_PONTOS)
+        return false;
+    for (uint8_t i = 1; i < tabela->num_pontos; i++) {
+        if (tabela->pontos[i].adc <= tabela->pontos[i - 1].adc)
+            return false;
+    }
+    tabelas[canal] = *tabela;
+
+    // Pré-cálculo: valor no início de cada trecho e inclinação por contagem
+    const float passo = (float)(1u << CAL_SEGMENTO_BITS);
+    float inicio = calibracao_avaliar(tabela, 0);
+    for (int s = 0; s < CAL_SEGMENTOS; s++) {
+        uint32_t adc_fim = (uint32_t)(s + 1) << CAL_SEGMENTO_BITS;
+        float fim = calibracao_avaliar(tabela, (uint16_t)(adc_fim > 0xFFFF ? 0xFFFF : adc_fim));
+        lut_base[canal][s] = inicio;
+        lut_inclinacao[canal][s] = (fim - inicio) / passo;
+        inicio = fim;
+    }
+    return true;
+}
+
+const cal_tabela_t *calibracao_tabela(cal_canal_t canal) {
+    return &tabelas[canal];
+}
+
+bool calibracao_ajustar(cal_canal_t canal, const cal_ponto_t *pontos, uint8_t n) {
+    if (canal >= CAL_NUM_CANAIS || n < 1 || n > 2)
+        return false;
+    cal_tabela_t t = tabelas[canal];
+    float c0 = avaliar_curva(&t, pontos[0].adc);
+    if (n == 2) {
+        float c1 = avaliar_curva(&t, pontos[1].adc);
+        if (c1 == c0)
+            return false;
+        float ganho = (pontos[1].valor - pontos[0].valor) / (c1 - c0);
+        if (!(ganho >= CAL_GANHO_MIN && ganho <= CAL_GANHO_MAX))
+            return false;
+        t.ganho = ganho;
+    }
+    t.offset = pontos[0].valor - c0 * t.ganho;
+    return calibracao_carregar(canal, &t);
+}
+
+float FUNCAO_RAPIDA(calibracao_converter)(cal_canal_t canal, uint16_t adc) {
+    if (adc > CAL_ADC_MAX) adc = CAL_ADC_MAX;
+    uint32_t s = adc >> CAL_SEGMENTO_BITS;
+    uint32_t f = adc & ((1u << CAL_SEGMENTO_BITS) - 1);
+    return lut_base[canal][s] + lut_inclinacao[canal][s] * (float)f;
+}
+
+float calibracao_converter_bruto(cal_canal_t canal, uint16_t adc) {
+    if (adc > CAL_ADC_MAX) adc = CAL_ADC_MAX;
+    return lut_base[canal][adc >> CAL_SEGMENTO_BITS];
+}
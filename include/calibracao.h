@@ -0,0 +1,60 @@
+#ifndef CALIBRACAO_H
+#define CALIBRACAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Calibração por canal: tabela de pontos (ADC -> unidade de engenharia)
+// com interpolação linear por trechos, mais ajuste de ganho e offset.
+// A curva descreve o sensor (não linear); o ajuste corrige cada unidade
+// com um ou dois pontos de referência, sem refazer a curva.
+//
+// Ao carregar uma tabela ela é pré-calculada em uma LUT segmentada de
+// CAL_SEGMENTOS trechos de 2^CAL_SEGMENTO_BITS contagens. A conversão em
+// tempo de execução é então um acesso à tabela e uma multiplicação-soma,
+// sem busca pelos pontos nem divisão.
+//===============================================
+#define CAL_ADC_MAX 4095
+#define CAL_MAX_PONTOS 8
+#define CAL_SEGMENTO_BITS 6
+#define CAL_SEGMENTOS ((CAL_ADC_MAX + 1) >> CAL_SEGMENTO_BITS)
+#define CAL_GANHO_MIN 0.5f   // Faixa aceita no ajuste de dois pontos
+#define CAL_GANHO_MAX 2.0f
+
+typedef enum {
+    CAL_ETILENO = 0,
+    CAL_TEMP,
+    CAL_UMIDADE,
+    CAL_CO2,
+    CAL_NUM_CANAIS
+} cal_canal_t;
+
+typedef struct {
+    uint16_t adc;
+    float valor;
+} cal_ponto_t;
+
+typedef struct {
+    cal_ponto_t pontos[CAL_MAX_PONTOS];   // Ordenados por adc
+    uint8_t num_pontos;
+    float ganho;    // valor = curva(adc) * ganho + offset, embutido na LUT
+    float offset;
+} cal_tabela_t;
+
+void calibracao_init(void);
+bool calibracao_carregar(cal_canal_t canal, const cal_tabela_t *tabela);
+const cal_tabela_t *calibracao_tabela(cal_canal_t canal);
+// Ajusta ganho e offset da tabela carregada para que a leitura passe
+// pelos pontos de referência: 1 ponto corrige só o offset, 2 pontos
+// corrigem ganho e offset. false se o ganho sair da faixa aceita.
+bool calibracao_ajustar(cal_canal_t canal, const cal_ponto_t *pontos, uint8_t n);
+
+// Conversão pela LUT, com interpolação dentro do trecho
+float calibracao_converter(cal_canal_t canal, uint16_t adc);
+// Conversão pela LUT sem interpolação (valor no início do trecho)
+float calibracao_converter_bruto(cal_canal_t canal, uint16_t adc);
+// Avaliação direta da tabela (busca + interpolação), usada para montar a LUT
+float calibracao_avaliar(const cal_tabela_t *tabela, uint16_t adc);
+
+#endif
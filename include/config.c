@@ -0,0 +1,36 @@
+#include "config.h"
+#include "hardware/sync.h"
+
+static config_t buffers[2];
+static volatile uint32_t geracao = 0;
+
+void config_init(const config_t *inicial) {
+    buffers[0] = *inicial;
+    buffers[1] = *inicial;
+    __dmb();
+    geracao = 0;
+}
+
+// Escritor único: nunca toca o buffer que os leitores enxergam.
+void config_publicar(const config_t *nova) {
+    uint32_t g = geracao;
+    buffers[(g + 1) & 1] = *nova;
+    __dmb();
+    geracao = g + 1;
+}
+
+// Leitor: se a geração mudou durante a cópia, o buffer pode ter sido
+// reescrito por uma segunda publicação e a cópia é refeita.
+void config_snapshot(config_t *destino) {
+    uint32_t g;
+    do {
+        g = geracao;
+        __dmb();
+        *destino = buffers[g & 1];
+        __dmb();
+    } while (g != geracao);
+}
+
+uint32_t config_geracao(void) {
+    return geracao;
+}
@@ -0,0 +1,31 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "zonas.h"
+
+//===============================================
+// Configuração compartilhada (setpoints e estado do menu)
+//
+// Publicada por buffer duplo com contador de geração: o escritor (laço
+// principal) preenche o buffer inativo e só então incrementa a geração.
+// O leitor copia o buffer ativo e repete a cópia se a geração mudou no
+// meio, obtendo sempre um instantâneo coerente sem travar interrupções.
+//===============================================
+typedef struct {
+    // Setpoints por sensor e zona: etileno e temperatura usam os dois
+    // limites, umidade só o inferior e CO₂ só o superior
+    zona_limites_t limites;
+    int zona_atual;          // Zona exibida e editada
+    int menu_index;          // 0 = Etileno, 1 = Temp, 2 = Umidade, 3 = CO₂, 4 = Médias
+    bool in_set_mode;
+    int current_set_param;   // 0 = setpoint inferior, 1 = setpoint superior
+} config_t;
+
+void config_init(const config_t *inicial);
+void config_publicar(const config_t *nova);
+void config_snapshot(config_t *destino);
+uint32_t config_geracao(void);
+
+#endif
@@ -0,0 +1,254 @@
+#include "controle.h"
+#include <string.h>
+
+static const float LIMITE_INFERIOR_PADRAO[ZONA_NUM_SENSORES] = {
+    [CAL_ETILENO] = 3.0f,
+    [CAL_TEMP] = 10.0f,
+    [CAL_UMIDADE] = 90.0f,
+    [CAL_CO2] = 0.0f,       // Sem limite inferior
+};
+static const float LIMITE_SUPERIOR_PADRAO[ZONA_NUM_SENSORES] = {
+    [CAL_ETILENO] = 7.0f,
+    [CAL_TEMP] = 15.0f,
+    [CAL_UMIDADE] = 100.0f, // Sem limite superior
+    [CAL_CO2] = 800.0f,     // Exemplo
+};
+
+void controle_config_padrao(config_t *cfg) {
+    memset(cfg, 0, sizeof(*cfg));
+    zona_limites_preencher(&cfg->limites, LIMITE_INFERIOR_PADRAO, LIMITE_SUPERIOR_PADRAO);
+}
+
+void controle_init(controle_t *c) {
+    tendencia_init(&c->tendencia_etileno, INTERVALO_TENDENCIA_MS);
+    tendencia_init(&c->tendencia_temp, INTERVALO_TENDENCIA_MS);
+    c->alerta_precoce = false;
+    c->calibracao_pendente = false;
+    controle_config_padrao(&c->antes_edicao);
+}
+
+//===============================================
+// Previsão e alerta precoce
+//===============================================
+bool controle_prever_cruzamento(const tendencia_t *t, float inferior, float superior, float *limite,
+                                float *segundos) {
+    float s_inferior, s_superior;
+    bool cruza_inferior = tendencia_tempo_ate(t, inferior, &s_inferior);
+    bool cruza_superior = tendencia_tempo_ate(t, superior, &s_superior);
+    if (cruza_inferior && (!cruza_superior || s_inferior <= s_superior)) {
+        *limite = inferior;
+        *segundos = s_inferior;
+        return true;
+    }
+    if (cruza_superior) {
+        *limite = superior;
+        *segundos = s_superior;
+        return true;
+    }
+    return false;
+}
+
+// Etileno rumo a "Apodrecendo" ou temperatura saindo da faixa ideal
+static bool avaliar_alerta_precoce(const controle_t *c, const config_t *cfg) {
+    float atual, segundos;
+    if (tendencia_valor_atual(&c->tendencia_etileno, &atual) && atual < LIMITE_SUPERIOR(*cfg, CAL_ETILENO) &&
+        tendencia_tempo_ate(&c->tendencia_etileno, LIMITE_SUPERIOR(*cfg, CAL_ETILENO), &segundos) &&
+        segundos < HORIZONTE_ALERTA_PRECOCE_S)
+        return true;
+    if (tendencia_valor_atual(&c->tendencia_temp, &atual) &&
+        atual >= LIMITE_INFERIOR(*cfg, CAL_TEMP) && atual <= LIMITE_SUPERIOR(*cfg, CAL_TEMP)) {
+        if (tendencia_tempo_ate(&c->tendencia_temp, LIMITE_SUPERIOR(*cfg, CAL_TEMP), &segundos) && segundos < HORIZONTE_ALERTA_PRECOCE_S)
+            return true;
+        if (tendencia_tempo_ate(&c->tendencia_temp, LIMITE_INFERIOR(*cfg, CAL_TEMP), &segundos) && segundos < HORIZONTE_ALERTA_PRECOCE_S)
+            return true;
+    }
+    return false;
+}
+
+//===============================================
+// Classificação, LED indicador e motor
+//===============================================
+static int16_t nivel_motor(float erro, float erro_maximo) {
+    float nivel = (erro / erro_maximo) * CONTROLE_PWM_MAX;
+    if (nivel > CONTROLE_PWM_MAX)
+        nivel = CONTROLE_PWM_MAX;
+    return (int16_t)nivel;
+}
+
+static void classificar(const config_t *cfg, float valor, controle_saida_t *s) {
+    s->valor = valor;
+    if (cfg->menu_index == 0) { // Gás Etileno
+        s->unidade = "ppm";
+        if (valor < LIMITE_INFERIOR(*cfg, CAL_ETILENO)) {
+            s->status = "Normal";
+            s->r = 0, s->g = 255, s->b = 0;
+        } else if (valor < LIMITE_SUPERIOR(*cfg, CAL_ETILENO)) {
+            s->status = "Amadurec. rapido";
+            s->severidade = SEVERIDADE_ATENCAO;
+            s->r = 255, s->g = 165, s->b = 0;
+        } else {
+            s->status = "Apodrecendo";
+            s->severidade = SEVERIDADE_CRITICA;
+            s->beep = true;
+            s->r = 255, s->g = 0, s->b = 0;
+        }
+        s->rgb = true;
+    } else if (cfg->menu_index == 1) { // Temperatura: motor no vermelho (frio) ou azul (quente)
+        float inferior = LIMITE_INFERIOR(*cfg, CAL_TEMP);
+        float superior = LIMITE_SUPERIOR(*cfg, CAL_TEMP);
+        s->unidade = "°C";
+        if (valor >= inferior && valor <= superior) {
+            s->status = "Ideal";
+            s->motor_r = 0;
+            s->motor_b = 0;
+        } else if (valor < inferior) {
+            s->status = "Frio";
+            s->motor_r = nivel_motor(inferior - valor, inferior);   // Exemplo
+            s->motor_b = 0;
+        } else {
+            s->status = (valor <= superior + 5) ? "Levemente alto" : "Critico";
+            s->motor_r = 0;
+            s->motor_b = nivel_motor(valor - superior, 10.0f);   // 10 °C acima do superior = máximo
+        }
+    } else if (cfg->menu_index == 2) { // Umidade: motor no vermelho, proporcional ao déficit
+        float inferior = LIMITE_INFERIOR(*cfg, CAL_UMIDADE);
+        s->unidade = "%";
+        if (valor >= inferior) {
+            s->status = "Ideal";
+            s->motor_r = 0;
+        } else {
+            s->status = "Baixa";
+            s->motor_r = nivel_motor(inferior - valor, 50.0f);
+        }
+    } else if (cfg->menu_index == 3) { // CO₂
+        s->unidade = "ppm";
+        s->rgb = true;
+        if (valor <= LIMITE_SUPERIOR(*cfg, CAL_CO2)) {
+            s->status = "Ideal";
+            s->r = 0, s->g = 255, s->b = 0;
+        } else {
+            s->status = "Alto";
+            s->r = 255, s->g = 0, s->b = 0;
+        }
+    }
+    // Fora da faixa ideal em temperatura, umidade e CO₂: carinha triste e beep
+    if (cfg->menu_index >= 1 && cfg->menu_index <= 3 && strcmp(s->status, "Ideal") != 0) {
+        s->severidade = SEVERIDADE_CRITICA;
+        s->beep = true;
+    }
+}
+
+void controle_amostrar(controle_t *c, const config_t *cfg, const zonas_t *z, uint32_t agora_ms,
+                       controle_saida_t *saida) {
+    memset(saida, 0, sizeof(*saida));
+    saida->status = "";
+    saida->unidade = "";
+    saida->motor_r = CONTROLE_PWM_INALTERADO;
+    saida->motor_b = CONTROLE_PWM_INALTERADO;
+
+    // Tendência da zona 0: a cada nova média de intervalo reavalia o alerta precoce
+    bool nova_tendencia = tendencia_adicionar(&c->tendencia_etileno, z->valor[CAL_ETILENO][0], agora_ms);
+    tendencia_adicionar(&c->tendencia_temp, z->valor[CAL_TEMP][0], agora_ms);
+    if (nova_tendencia) {
+        c->alerta_precoce = avaliar_alerta_precoce(c, cfg);
+        saida->beep_alerta_precoce = c->alerta_precoce;
+    }
+
+    if (cfg->menu_index < CAL_NUM_CANAIS)
+        classificar(cfg, z->valor[cfg->menu_index][cfg->zona_atual], saida);
+}
+
+//===============================================
+// Menu e modo de configuração
+//===============================================
+float controle_setpoint_em_edicao(const config_t *cfg) {
+    switch (cfg->menu_index) {
+    case 0:
+        return cfg->current_set_param == 0 ? LIMITE_INFERIOR(*cfg, CAL_ETILENO) : LIMITE_SUPERIOR(*cfg, CAL_ETILENO);
+    case 1:
+        return cfg->current_set_param == 0 ? LIMITE_INFERIOR(*cfg, CAL_TEMP) : LIMITE_SUPERIOR(*cfg, CAL_TEMP);
+    case 2:
+        return LIMITE_INFERIOR(*cfg, CAL_UMIDADE);
+    default:
+        return cfg->current_set_param == 0 ? 400.0f : LIMITE_SUPERIOR(*cfg, CAL_CO2);
+    }
+}
+
+// Ajusta o setpoint ativo em "passos" (negativo = diminui)
+static void ajustar_setpoint(config_t *cfg, float passos) {
+    if (cfg->menu_index == 0) {
+        if (cfg->current_set_param == 0)
+            LIMITE_INFERIOR(*cfg, CAL_ETILENO) += passos * 0.1f;
+        else
+            LIMITE_SUPERIOR(*cfg, CAL_ETILENO) += passos * 0.1f;
+    } else if (cfg->menu_index == 1) {
+        if (cfg->current_set_param == 0)
+            LIMITE_INFERIOR(*cfg, CAL_TEMP) += passos * 0.5f;
+        else
+            LIMITE_SUPERIOR(*cfg, CAL_TEMP) += passos * 0.5f;
+    } else if (cfg->menu_index == 2) {
+        LIMITE_INFERIOR(*cfg, CAL_UMIDADE) += passos * 1.0f;
+    } else if (cfg->menu_index == 3) {
+        LIMITE_SUPERIOR(*cfg, CAL_CO2) += passos * 50.0f;
+    }
+}
+
+controle_acao_t controle_aplicar_evento(controle_t *c, config_t *cfg, const evento_botao_t *ev) {
+    if (ev->tipo == BOTAO_EV_COMBO) {
+        // NEXT+BACK juntos cancelam a edição e restauram os setpoints
+        uint8_t cancelar = BOTAO_BIT(BOTAO_IDX_NEXT) | BOTAO_BIT(BOTAO_IDX_BACK);
+        if (cfg->in_set_mode && (ev->mascara & cancelar) == cancelar) {
+            *cfg = c->antes_edicao;
+            cfg->in_set_mode = false;
+        } else if (!cfg->in_set_mode && (ev->mascara & BOTAO_BIT(BOTAO_IDX_SET)) && ev->botao != BOTAO_IDX_SET) {
+            // SET segurado + NEXT/BACK pagina entre as zonas; SET pode ter
+            // passado do tempo de pressão longa, mas não inicia a calibração
+            c->calibracao_pendente = false;
+            int passo = (ev->botao == BOTAO_IDX_NEXT) ? 1 : NUM_ZONAS - 1;
+            cfg->zona_atual = (cfg->zona_atual + passo) % NUM_ZONAS;
+        }
+        return CONTROLE_NENHUMA;
+    }
+
+    if (ev->botao == BOTAO_IDX_SET) {
+        // A pressão longa só arma a calibração: ela começa ao soltar SET, se
+        // nenhum NEXT/BACK foi tocado no meio (paginação de zonas)
+        if (ev->tipo == BOTAO_EV_PRESSIONADO)
+            c->calibracao_pendente = false;
+        if (ev->tipo == BOTAO_EV_LONGO && !cfg->in_set_mode && cfg->menu_index < CAL_NUM_CANAIS)
+            c->calibracao_pendente = true;
+        if (ev->tipo == BOTAO_EV_SOLTO && c->calibracao_pendente) {
+            c->calibracao_pendente = false;
+            return CONTROLE_INICIAR_CALIBRACAO;
+        }
+        if (ev->tipo != BOTAO_EV_CLIQUE)
+            return CONTROLE_NENHUMA;
+        if (!cfg->in_set_mode) {
+            if (cfg->menu_index >= MENU_MEDIAS)
+                return CONTROLE_NENHUMA;   // Telas sem setpoint
+            c->antes_edicao = *cfg;
+            cfg->in_set_mode = true;
+            cfg->current_set_param = 0;
+        } else if ((cfg->menu_index == 0 || cfg->menu_index == 1) && cfg->current_set_param == 0) {
+            cfg->current_set_param = 1;
+        } else {
+            cfg->in_set_mode = false;
+        }
+        return CONTROLE_NENHUMA;
+    }
+
+    float sinal = (ev->botao == BOTAO_IDX_NEXT) ? 1.0f : -1.0f;
+    if (cfg->in_set_mode) {
+        // Pressão e auto-repetição ajustam; após 20 repetições o passo vale 10x
+        if (ev->tipo == BOTAO_EV_PRESSIONADO)
+            ajustar_setpoint(cfg, sinal);
+        else if (ev->tipo == BOTAO_EV_REPETICAO)
+            ajustar_setpoint(cfg, sinal * (ev->repeticoes >= 20 ? 10.0f : 1.0f));
+    } else if (ev->tipo == BOTAO_EV_PRESSIONADO) {
+        if (ev->botao == BOTAO_IDX_NEXT)
+            cfg->menu_index = (cfg->menu_index + 1) % NUM_MENUS;
+        else
+            cfg->menu_index = (cfg->menu_index + NUM_MENUS - 1) % NUM_MENUS;
+    }
+    return CONTROLE_NENHUMA;
+}
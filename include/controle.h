@@ -0,0 +1,88 @@
+#ifndef CONTROLE_H
+#define CONTROLE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "botoes.h"
+#include "config.h"
+#include "tendencia.h"
+#include "zonas.h"
+
+//===============================================
+// Lógica de controle do FruitLife
+//
+// Classificação da leitura exibida, alarmes sonoros, LED indicador, PWM
+// do "motor", tendência/alerta precoce e a máquina de estados do menu.
+// Recebe o tempo como argumento (relógio virtual) e devolve as ações em
+// vez de acionar o hardware: o firmware aplica as saídas aos periféricos
+// e o tools/replay.c reproduz traços gravados muito mais rápido que o
+// tempo real.
+//===============================================
+
+// Menu: 0 = Gás Etileno, 1 = Temperatura, 2 = Umidade, 3 = CO₂, 4 = Médias, 5 = Diagnóstico,
+// 6 = Excursões
+#define NUM_MENUS 7
+#define MENU_MEDIAS 4
+#define MENU_DIAGNOSTICO 5
+#define MENU_EXCURSOES 6
+
+// Índices dos botões no motor de entrada (bit i da máscara = botão i)
+#define BOTAO_IDX_NEXT 0
+#define BOTAO_IDX_BACK 1
+#define BOTAO_IDX_SET  2
+#define BOTAO_BIT(idx) (1u << (idx))
+
+// Setpoints da zona exibida (umidade_set = inferior de umidade, co2_set = superior de CO₂)
+#define LIMITE_INFERIOR(cfg, s) ((cfg).limites.inferior[(s)][(cfg).zona_atual])
+#define LIMITE_SUPERIOR(cfg, s) ((cfg).limites.superior[(s)][(cfg).zona_atual])
+
+#define INTERVALO_TENDENCIA_MS 10000              // Uma média a cada 10 s (janela de 10 min)
+#define HORIZONTE_ALERTA_PRECOCE_S (30.0f * 60.0f)  // Alerta se o cruzamento for em até 30 min
+
+#define CONTROLE_PWM_MAX 255          // Nível máximo do LED/motor
+#define CONTROLE_PWM_INALTERADO (-1)
+
+typedef enum { SEVERIDADE_NORMAL = 0, SEVERIDADE_ATENCAO, SEVERIDADE_CRITICA } severidade_t;
+
+typedef enum {
+    CONTROLE_NENHUMA = 0,
+    CONTROLE_INICIAR_CALIBRACAO   // SET longo solto num menu de sensor
+} controle_acao_t;
+
+typedef struct {
+    tendencia_t tendencia_etileno;   // Zona 0
+    tendencia_t tendencia_temp;
+    bool alerta_precoce;
+    config_t antes_edicao;           // Restaurada pelo combo NEXT+BACK (cancelar edição)
+    bool calibracao_pendente;        // SET longo sem combo: a calibração começa ao soltar
+} controle_t;
+
+// Resultado de uma amostra para a leitura exibida (menu e zona atuais)
+typedef struct {
+    float valor;
+    const char *status;       // Vazio fora dos menus de sensor
+    const char *unidade;
+    severidade_t severidade;  // Carinha da matriz
+    bool beep;                // Alarme sonoro nesta amostra
+    bool beep_alerta_precoce;
+    bool rgb;                 // LED RGB definido (etileno e CO₂)
+    uint8_t r, g, b;
+    int16_t motor_r;          // Nível PWM ou CONTROLE_PWM_INALTERADO
+    int16_t motor_b;
+} controle_saida_t;
+
+// Configuração de fábrica: mesmos setpoints em todas as zonas
+void controle_config_padrao(config_t *cfg);
+void controle_init(controle_t *c);
+
+// Chamado após zonas_processar, com as medidas de todas as zonas já atualizadas
+void controle_amostrar(controle_t *c, const config_t *cfg, const zonas_t *z, uint32_t agora_ms,
+                       controle_saida_t *saida);
+controle_acao_t controle_aplicar_evento(controle_t *c, config_t *cfg, const evento_botao_t *ev);
+
+float controle_setpoint_em_edicao(const config_t *cfg);
+// Primeiro setpoint que a reta de tendência vai cruzar
+bool controle_prever_cruzamento(const tendencia_t *t, float inferior, float superior, float *limite,
+                                float *segundos);
+
+#endif
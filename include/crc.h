@@ -0,0 +1,17 @@
+#ifndef CRC_H
+#define CRC_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-8 dos sensores Sensirion (SHT3x, SCD4x): polinômio 0x31, início 0xFF
+uint8_t crc8_sensirion(const uint8_t *dados, size_t len);
+
+// CRC-16 do Modbus RTU: polinômio 0xA001 (refletido), início 0xFFFF,
+// transmitido com o byte menos significativo primeiro
+uint16_t crc16_modbus(const uint8_t *dados, size_t len);
+
+// CRC-32 (IEEE 802.3, refletido), tabela de 16 entradas por nibble
+uint32_t crc32(const void *dados, size_t len);
+
+#endif
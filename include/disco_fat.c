@@ -0,0 +1,294 @@
+#include "disco_fat.h"
+#include "zonas.h"
+#include <string.h>
+
+#define ENTRADAS_RAIZ 512
+#define SETORES_RAIZ (ENTRADAS_RAIZ * 32 / DISCO_FAT_SETOR)
+#define CLUSTERS_MIN 4200     // Abaixo de 4085 clusters o volume seria lido como FAT12
+#define CLUSTERS_MAX 65524
+#define CLUSTER_ARQUIVO 2     // O arquivo ocupa clusters contíguos a partir do primeiro
+// Sem RTC, o arquivo leva uma data fixa (FAT: anos desde 1980, mês, dia)
+#define DATA_FAT (((2025 - 1980) << 9) | (1 << 5) | 1)
+
+static const char CABECALHO[] =
+    "registro,viagem,zona,tempo,temperatura_c,umidade_pct,etileno_ppm,co2_ppm,alarmes,grau_minuto,fora_min\r\n";
+#define TAMANHO_CABECALHO ((uint32_t)sizeof(CABECALHO) - 1)
+
+// Larguras das colunas; a soma com as vírgulas e o CRLF dá DISCO_FAT_LINHA
+static const uint8_t LARGURAS[] = { 10, 5, 2, 11, 7, 6, 6, 5, 4, 9, 8 };
+#define NUM_COLUNAS (sizeof(LARGURAS) / sizeof(LARGURAS[0]))
+
+static const uint64_t POTENCIAS[] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull,
+};
+
+static void escrever16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void escrever32(uint8_t *p, uint32_t v) {
+    escrever16(p, (uint16_t)v);
+    escrever16(p + 2, (uint16_t)(v >> 16));
+}
+
+//===============================================
+// Campos de largura fixa, alinhados à direita (satura no maior valor que cabe)
+//===============================================
+static char *campo_inteiro(char *p, uint32_t v, int largura) {
+    char *q = p + largura;
+    if (v > POTENCIAS[largura] - 1)
+        v = (uint32_t)(POTENCIAS[largura] - 1);
+    do {
+        *--q = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    while (q > p)
+        *--q = ' ';
+    return p + largura;
+}
+
+static char *campo_decimal(char *p, int32_t v, int casas, int largura) {
+    char *q = p + largura;
+    bool negativo = v < 0;
+    uint32_t m = negativo ? 0u - (uint32_t)v : (uint32_t)v;
+    uint64_t maximo = POTENCIAS[largura - 1 - negativo] - 1;   // Um caractere é o ponto
+    if (m > maximo)
+        m = (uint32_t)maximo;
+    for (int i = 0; i < casas; i++) {
+        *--q = (char)('0' + m % 10);
+        m /= 10;
+    }
+    *--q = '.';
+    do {
+        *--q = (char)('0' + m % 10);
+        m /= 10;
+    } while (m);
+    if (negativo)
+        *--q = '-';
+    while (q > p)
+        *--q = ' ';
+    return p + largura;
+}
+
+static char *campo_tempo(char *p, uint32_t segundos) {
+    uint32_t horas = segundos / 3600;
+    p = campo_inteiro(p, horas, LARGURAS[3] - 6);
+    *p++ = ':';
+    uint32_t minutos = segundos / 60 % 60;
+    *p++ = (char)('0' + minutos / 10);
+    *p++ = (char)('0' + minutos % 10);
+    *p++ = ':';
+    *p++ = (char)('0' + segundos % 60 / 10);
+    *p++ = (char)('0' + segundos % 10);
+    return p;
+}
+
+// Um caractere por sensor (etileno, temperatura, umidade, CO₂): '+' acima,
+// '-' abaixo, '.' sem alarme
+static char *campo_alarmes(char *p, uint8_t estado) {
+    uint32_t alarmes = estado & ZONA_ALARMES;
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++)
+        *p++ = (alarmes & ZONA_ACIMA(s)) ? '+' : (alarmes & ZONA_ABAIXO(s)) ? '-' : '.';
+    return p;
+}
+
+static void formatar_linha(const disco_fat_t *d, uint32_t indice, char *linha) {
+    uint32_t posicao = d->primeiro + indice;
+    if (posicao >= d->historico->capacidade)
+        posicao -= d->historico->capacidade;
+    const historico_registro_t *r = historico_posicao(d->historico, posicao);
+    char *p = linha;
+    if (!historico_valido(r) || r->sequencia >= d->limite_sequencia) {
+        // Gravação interrompida ou posição reaproveitada depois da montagem
+        for (unsigned c = 0; c < NUM_COLUNAS; c++) {
+            memset(p, ' ', LARGURAS[c]);
+            p += LARGURAS[c];
+            *p++ = c + 1 < NUM_COLUNAS ? ',' : '\r';
+        }
+        *p = '\n';
+        return;
+    }
+    p = campo_inteiro(p, r->sequencia, LARGURAS[0]);
+    *p++ = ',';
+    p = campo_inteiro(p, r->viagem, LARGURAS[1]);
+    *p++ = ',';
+    p = campo_inteiro(p, r->zona + 1u, LARGURAS[2]);
+    *p++ = ',';
+    p = campo_tempo(p, r->tempo_s);
+    *p++ = ',';
+    p = campo_decimal(p, r->temp_cc, 2, LARGURAS[4]);
+    *p++ = ',';
+    p = campo_decimal(p, r->umidade_dm, 1, LARGURAS[5]);
+    *p++ = ',';
+    p = campo_decimal(p, r->etileno_dm, 1, LARGURAS[6]);
+    *p++ = ',';
+    p = campo_inteiro(p, r->co2_ppm, LARGURAS[7]);
+    *p++ = ',';
+    p = campo_alarmes(p, r->estado);
+    *p++ = ',';
+    p = campo_decimal(p, r->grau_minuto_dm > INT32_MAX ? INT32_MAX : (int32_t)r->grau_minuto_dm, 1, LARGURAS[9]);
+    *p++ = ',';
+    p = campo_decimal(p, (int32_t)(r->fora_s / 6), 1, LARGURAS[10]);   // Décimos de minuto
+    *p++ = '\r';
+    *p = '\n';
+}
+
+// Bytes [deslocamento, deslocamento + len) do arquivo; após o fim, zeros.
+// Linhas inteiras são formatadas direto no destino; só as que cruzam a
+// borda do pedido passam por um buffer de uma linha.
+static void gerar_arquivo(const disco_fat_t *d, uint32_t deslocamento, uint8_t *destino, uint32_t len) {
+    uint32_t fim = deslocamento + len;
+    if (fim > d->tamanho_arquivo) {
+        uint32_t valido = deslocamento < d->tamanho_arquivo ? d->tamanho_arquivo - deslocamento : 0;
+        memset(destino + valido, 0, len - valido);
+        fim = d->tamanho_arquivo;
+    }
+    while (deslocamento < fim) {
+        uint32_t n;
+        if (deslocamento < TAMANHO_CABECALHO) {
+            n = TAMANHO_CABECALHO - deslocamento;
+            if (n > fim - deslocamento)
+                n = fim - deslocamento;
+            memcpy(destino, CABECALHO + deslocamento, n);
+        } else {
+            uint32_t relativo = deslocamento - TAMANHO_CABECALHO;
+            uint32_t indice = relativo / DISCO_FAT_LINHA, coluna = relativo % DISCO_FAT_LINHA;
+            n = DISCO_FAT_LINHA - coluna;
+            if (n > fim - deslocamento)
+                n = fim - deslocamento;
+            if (n == DISCO_FAT_LINHA) {
+                formatar_linha(d, indice, (char *)destino);
+            } else {
+                char linha[DISCO_FAT_LINHA];
+                formatar_linha(d, indice, linha);
+                memcpy(destino, linha + coluna, n);
+            }
+        }
+        destino += n;
+        deslocamento += n;
+    }
+}
+
+//===============================================
+// Estruturas do sistema de arquivos
+//===============================================
+static void gerar_boot(const disco_fat_t *d, uint8_t *s) {
+    memset(s, 0, DISCO_FAT_SETOR);
+    memcpy(s, "\xEB\x3C\x90" "FRUITLFE", 11);
+    escrever16(s + 11, DISCO_FAT_SETOR);
+    s[13] = d->setores_por_cluster;
+    escrever16(s + 14, (uint16_t)d->inicio_fat);   // Setores reservados
+    s[16] = 2;                                     // Cópias da FAT
+    escrever16(s + 17, ENTRADAS_RAIZ);
+    if (d->setores < 0x10000)
+        escrever16(s + 19, (uint16_t)d->setores);
+    else
+        escrever32(s + 32, d->setores);
+    s[21] = 0xF8;                                  // Mídia fixa
+    escrever16(s + 22, d->setores_fat);
+    escrever16(s + 24, 63);                        // Geometria CHS fictícia
+    escrever16(s + 26, 255);
+    s[36] = 0x80;
+    s[38] = 0x29;                                  // Há série, rótulo e tipo
+    escrever32(s + 39, 0x46524C54u ^ d->limite_sequencia);   // Muda a cada instantâneo
+    memcpy(s + 43, "FRUITLIFE  FAT16   ", 19);
+    s[510] = 0x55;
+    s[511] = 0xAA;
+}
+
+static void gerar_fat(const disco_fat_t *d, uint32_t setor_fat, uint8_t *s) {
+    uint32_t primeira = setor_fat * (DISCO_FAT_SETOR / 2);
+    uint32_t ultimo_cluster = CLUSTER_ARQUIVO + d->clusters_arquivo - 1;
+    for (uint32_t i = 0; i < DISCO_FAT_SETOR / 2; i++) {
+        uint32_t e = primeira + i;
+        uint16_t v;
+        if (e == 0)
+            v = 0xFFF8;
+        else if (e == 1)
+            v = 0xFFFF;
+        else if (e >= CLUSTER_ARQUIVO && e <= ultimo_cluster)
+            v = e == ultimo_cluster ? 0xFFFF : (uint16_t)(e + 1);   // Cadeia contígua
+        else
+            v = 0;
+        escrever16(s + 2 * i, v);
+    }
+}
+
+static void gerar_raiz(const disco_fat_t *d, uint32_t setor_raiz, uint8_t *s) {
+    memset(s, 0, DISCO_FAT_SETOR);
+    if (setor_raiz != 0)
+        return;
+    memcpy(s, "FRUITLIFE  ", 11);
+    s[11] = 0x08;                       // Rótulo do volume
+    uint8_t *e = s + 32;
+    memcpy(e, "VIAGEM  CSV", 11);
+    e[11] = 0x01;                       // Somente leitura
+    escrever16(e + 16, DATA_FAT);       // Criação
+    escrever16(e + 18, DATA_FAT);       // Último acesso
+    escrever16(e + 24, DATA_FAT);       // Modificação
+    escrever16(e + 26, CLUSTER_ARQUIVO);
+    escrever32(e + 28, d->tamanho_arquivo);
+}
+
+//===============================================
+// Interface
+//===============================================
+void disco_fat_init(disco_fat_t *d, const historico_t *h) {
+    memset(d, 0, sizeof(*d));
+    d->historico = h;
+    // Geometria para o anel cheio, para o volume não mudar de tamanho
+    uint64_t maximo = TAMANHO_CABECALHO + (uint64_t)h->capacidade * DISCO_FAT_LINHA;
+    uint32_t spc = 1;
+    for (;;) {
+        uint64_t bytes_cluster = (uint64_t)spc * DISCO_FAT_SETOR;
+        uint64_t clusters = (maximo + bytes_cluster - 1) / bytes_cluster;
+        if (clusters < CLUSTERS_MIN)
+            clusters = CLUSTERS_MIN;
+        if (clusters <= CLUSTERS_MAX || spc == 128) {
+            d->clusters = (uint32_t)clusters;
+            break;
+        }
+        spc *= 2;
+    }
+    d->setores_por_cluster = (uint8_t)spc;
+    d->setores_fat = (uint16_t)(((d->clusters + 2) * 2 + DISCO_FAT_SETOR - 1) / DISCO_FAT_SETOR);
+    d->inicio_fat = 1;
+    d->inicio_raiz = d->inicio_fat + 2u * d->setores_fat;
+    d->inicio_dados = d->inicio_raiz + SETORES_RAIZ;
+    d->setores = d->inicio_dados + d->clusters * spc;
+    disco_fat_congelar(d);
+}
+
+void disco_fat_congelar(disco_fat_t *d) {
+    historico_janela(d->historico, &d->primeiro, &d->linhas);
+    d->limite_sequencia = d->historico->sequencia;
+    d->tamanho_arquivo = TAMANHO_CABECALHO + d->linhas * DISCO_FAT_LINHA;
+    uint32_t bytes_cluster = (uint32_t)d->setores_por_cluster * DISCO_FAT_SETOR;
+    d->clusters_arquivo = (d->tamanho_arquivo + bytes_cluster - 1) / bytes_cluster;
+}
+
+void disco_fat_ler(const disco_fat_t *d, uint32_t setor, uint8_t *destino, uint32_t quantidade) {
+    while (quantidade > 0) {
+        uint32_t n = 1;
+        if (setor == 0) {
+            gerar_boot(d, destino);
+        } else if (setor < d->inicio_raiz) {
+            gerar_fat(d, (setor - d->inicio_fat) % d->setores_fat, destino);   // As duas cópias são iguais
+        } else if (setor < d->inicio_dados) {
+            gerar_raiz(d, setor - d->inicio_raiz, destino);
+        } else if (setor < d->setores) {
+            // Setores de dados consecutivos são um trecho contínuo do arquivo
+            n = d->setores - setor;
+            if (n > quantidade)
+                n = quantidade;
+            gerar_arquivo(d, (setor - d->inicio_dados) * DISCO_FAT_SETOR, destino, n * DISCO_FAT_SETOR);
+        } else {
+            memset(destino, 0, DISCO_FAT_SETOR);
+        }
+        setor += n;
+        destino += n * DISCO_FAT_SETOR;
+        quantidade -= n;
+    }
+}
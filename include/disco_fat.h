@@ -0,0 +1,47 @@
+#ifndef DISCO_FAT_H
+#define DISCO_FAT_H
+
+#include <stdint.h>
+#include "historico.h"
+
+//===============================================
+// Volume FAT16 virtual, somente leitura, com o histórico em CSV
+//
+// Nenhum setor existe em memória: setor de boot, FATs e diretório raiz
+// são calculados a partir da geometria, e o conteúdo de VIAGEM.CSV é
+// formatado na hora a partir dos registros na flash. As linhas do CSV
+// têm largura fixa, então o deslocamento no arquivo leva direto à
+// posição do registro (O(1) por setor, qualquer ordem de leitura).
+// O arquivo é um instantâneo tirado na montagem: registros gravados
+// depois só aparecem na próxima, e os que forem sobrescritos nesse meio
+// tempo viram linhas em branco, sem mudar o tamanho nem o layout.
+// Não depende do SDK nem do TinyUSB.
+//===============================================
+#define DISCO_FAT_SETOR 512u
+#define DISCO_FAT_LINHA 85u   // Bytes por registro no CSV, com CRLF
+
+typedef struct {
+    const historico_t *historico;
+    // Geometria
+    uint32_t setores;
+    uint8_t setores_por_cluster;
+    uint16_t setores_fat;
+    uint32_t inicio_fat;
+    uint32_t inicio_raiz;
+    uint32_t inicio_dados;
+    uint32_t clusters;
+    // Instantâneo do histórico
+    uint32_t primeiro;           // Posição no anel da primeira linha
+    uint32_t linhas;
+    uint32_t limite_sequencia;   // Registros a partir desta sequência são posteriores
+    uint32_t tamanho_arquivo;
+    uint32_t clusters_arquivo;
+} disco_fat_t;
+
+// A geometria comporta o anel inteiro; já tira o primeiro instantâneo
+void disco_fat_init(disco_fat_t *d, const historico_t *h);
+void disco_fat_congelar(disco_fat_t *d);
+// Gera 'quantidade' setores a partir de 'setor' (fora do volume: zeros)
+void disco_fat_ler(const disco_fat_t *d, uint32_t setor, uint8_t *destino, uint32_t quantidade);
+
+#endif
@@ -0,0 +1,116 @@
+#include "energia.h"
+#include <string.h>
+
+// Corrente estimada de cada subsistema por nível (µA), a partir das folhas
+// de dados e de medições de bancada aproximadas:
+//   - CPU: __wfi com clocks ligados / ativo a 48 MHz / ativo a 125 MHz
+//   - OLED: display desligado / contraste baixo / contraste máximo
+//   - Matriz: os 25 WS2812 consomem ~0,6 mA cada mesmo apagados
+//   - Buzzer: só liga ou desliga
+static const uint32_t CORRENTE_UA[ENERGIA_NUM_SUBSISTEMAS][ENERGIA_NUM_NIVEIS] = {
+    [ENERGIA_CPU]    = { 6000, 12000, 25000 },
+    [ENERGIA_OLED]   = { 10, 3000, 12000 },
+    [ENERGIA_MATRIZ] = { 15000, 26000, 60000 },
+    [ENERGIA_BUZZER] = { 0, 10000, 20000 },
+};
+
+void energia_init(energia_t *e, uint64_t agora_us, uint32_t escurecer_ms, uint32_t apagar_ms) {
+    memset(e, 0, sizeof(*e));
+    for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+        e->nivel[s] = ENERGIA_PLENO;
+    e->nivel[ENERGIA_BUZZER] = ENERGIA_DESLIGADO;
+    e->inicio_us = agora_us;
+    e->ultimo_us = agora_us;
+    e->ultima_atividade_us = agora_us;
+    e->escurecer_us = (uint64_t)escurecer_ms * 1000u;
+    e->apagar_us = (uint64_t)apagar_ms * 1000u;
+    e->tela = TELA_ATIVA;
+}
+
+// Credita o intervalo desde a última contabilização ao nível atual de cada subsistema
+void energia_contabilizar(energia_t *e, uint64_t agora_us) {
+    if (agora_us <= e->ultimo_us)
+        return;
+    uint64_t dt = agora_us - e->ultimo_us;
+    for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+        e->tempo_us[s][e->nivel[s]] += dt;
+    e->ultimo_us = agora_us;
+}
+
+void energia_definir(energia_t *e, energia_subsistema_t sub, energia_nivel_t nivel, uint64_t agora_us) {
+    if (e->nivel[sub] == nivel)
+        return;
+    energia_contabilizar(e, agora_us);
+    e->nivel[sub] = (uint8_t)nivel;
+}
+
+static void aplicar_tela(energia_t *e, energia_tela_t tela, uint64_t agora_us) {
+    static const energia_nivel_t NIVEL_TELA[] = {
+        [TELA_ATIVA] = ENERGIA_PLENO,
+        [TELA_ESCURECIDA] = ENERGIA_REDUZIDO,
+        [TELA_APAGADA] = ENERGIA_DESLIGADO,
+    };
+    e->tela = tela;
+    energia_definir(e, ENERGIA_OLED, NIVEL_TELA[tela], agora_us);
+    energia_definir(e, ENERGIA_MATRIZ, NIVEL_TELA[tela], agora_us);
+}
+
+void energia_atividade(energia_t *e, uint64_t agora_us) {
+    e->ultima_atividade_us = agora_us;
+    if (e->tela != TELA_ATIVA)
+        aplicar_tela(e, TELA_ATIVA, agora_us);
+}
+
+energia_tela_t energia_avaliar_tela(energia_t *e, uint64_t agora_us) {
+    uint64_t ocioso = agora_us - e->ultima_atividade_us;
+    energia_tela_t tela = TELA_ATIVA;
+    if (ocioso >= e->apagar_us)
+        tela = TELA_APAGADA;
+    else if (ocioso >= e->escurecer_us)
+        tela = TELA_ESCURECIDA;
+    if (tela != e->tela)
+        aplicar_tela(e, tela, agora_us);
+    return e->tela;
+}
+
+static uint64_t tempo_total(const energia_t *e) {
+    return e->ultimo_us - e->inicio_us;
+}
+
+uint32_t energia_ciclo_trabalho(const energia_t *e, energia_subsistema_t sub) {
+    uint64_t total = tempo_total(e);
+    if (total == 0)
+        return 0;
+    uint64_t ligado = total - e->tempo_us[sub][ENERGIA_DESLIGADO];
+    return (uint32_t)(ligado * 1000u / total);
+}
+
+uint32_t energia_corrente_subsistema_ua(const energia_t *e, energia_subsistema_t sub) {
+    uint64_t total = tempo_total(e);
+    if (total == 0)
+        return CORRENTE_UA[sub][e->nivel[sub]];
+    // µA·µs cabe em 64 bits por quase 10 anos a 60 mA
+    uint64_t carga = 0;
+    for (int n = 0; n < ENERGIA_NUM_NIVEIS; n++)
+        carga += e->tempo_us[sub][n] * CORRENTE_UA[sub][n];
+    return (uint32_t)(carga / total);
+}
+
+uint32_t energia_corrente_media_ua(const energia_t *e) {
+    uint32_t soma = 0;
+    for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+        soma += energia_corrente_subsistema_ua(e, (energia_subsistema_t)s);
+    return soma;
+}
+
+float energia_carga_mah(const energia_t *e) {
+    float horas = (float)tempo_total(e) / 3.6e9f;
+    return (float)energia_corrente_media_ua(e) / 1000.0f * horas;
+}
+
+float energia_autonomia_h(const energia_t *e, float capacidade_mah) {
+    uint32_t ua = energia_corrente_media_ua(e);
+    if (ua == 0)
+        return 0.0f;
+    return capacidade_mah / ((float)ua / 1000.0f);
+}
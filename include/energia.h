@@ -0,0 +1,65 @@
+#ifndef ENERGIA_H
+#define ENERGIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Gerenciador de energia
+//
+// Contabiliza o tempo que cada subsistema passa em cada nível de consumo
+// e, a partir de uma tabela de correntes estimadas, calcula o ciclo de
+// trabalho, a corrente média e a autonomia da bateria. Também decide
+// quando escurecer e apagar a tela (OLED e matriz) por inatividade.
+// Não depende do SDK: o orçamento é conferido em Linux por
+// tools/energia_orcamento.c.
+//===============================================
+typedef enum {
+    ENERGIA_CPU = 0,     // Desligado = __wfi; reduzido = clock baixo
+    ENERGIA_OLED,
+    ENERGIA_MATRIZ,
+    ENERGIA_BUZZER,
+    ENERGIA_NUM_SUBSISTEMAS
+} energia_subsistema_t;
+
+typedef enum {
+    ENERGIA_DESLIGADO = 0,
+    ENERGIA_REDUZIDO,
+    ENERGIA_PLENO,
+    ENERGIA_NUM_NIVEIS
+} energia_nivel_t;
+
+typedef enum {
+    TELA_ATIVA = 0,
+    TELA_ESCURECIDA,
+    TELA_APAGADA
+} energia_tela_t;
+
+typedef struct {
+    uint8_t nivel[ENERGIA_NUM_SUBSISTEMAS];
+    uint64_t tempo_us[ENERGIA_NUM_SUBSISTEMAS][ENERGIA_NUM_NIVEIS];
+    uint64_t inicio_us;
+    uint64_t ultimo_us;             // Até onde o tempo já foi contabilizado
+    uint64_t ultima_atividade_us;
+    uint64_t escurecer_us;          // Inatividade até escurecer
+    uint64_t apagar_us;             // Inatividade até apagar
+    energia_tela_t tela;
+} energia_t;
+
+void energia_init(energia_t *e, uint64_t agora_us, uint32_t escurecer_ms, uint32_t apagar_ms);
+void energia_contabilizar(energia_t *e, uint64_t agora_us);
+void energia_definir(energia_t *e, energia_subsistema_t sub, energia_nivel_t nivel, uint64_t agora_us);
+
+// Botão ou alarme: volta a tela ao brilho normal e reinicia a contagem
+void energia_atividade(energia_t *e, uint64_t agora_us);
+// Aplica os tempos de inatividade e devolve o estado atual da tela
+energia_tela_t energia_avaliar_tela(energia_t *e, uint64_t agora_us);
+
+// Orçamento (sobre o tempo já contabilizado)
+uint32_t energia_ciclo_trabalho(const energia_t *e, energia_subsistema_t sub);   // Em milésimos
+uint32_t energia_corrente_subsistema_ua(const energia_t *e, energia_subsistema_t sub);
+uint32_t energia_corrente_media_ua(const energia_t *e);
+float energia_carga_mah(const energia_t *e);
+float energia_autonomia_h(const energia_t *e, float capacidade_mah);
+
+#endif
@@ -0,0 +1,39 @@
+#include "eventos.h"
+#include "hardware/sync.h"
+#include "secoes.h"
+
+static evento_botao_t fila[EVENTOS_TAMANHO];
+static volatile uint32_t cabeca = 0;   // Escrito só pelo produtor
+static volatile uint32_t cauda = 0;    // Escrito só pelo consumidor
+static volatile uint32_t descartados = 0;
+
+bool FUNCAO_RAPIDA(eventos_publicar)(const evento_botao_t *ev) {
+    uint32_t c = cabeca;
+    if (c - cauda >= EVENTOS_TAMANHO) {
+        descartados++;
+        return false;
+    }
+    fila[c & (EVENTOS_TAMANHO - 1)] = *ev;
+    __dmb();
+    cabeca = c + 1;
+    return true;
+}
+
+bool eventos_retirar(evento_botao_t *ev) {
+    uint32_t t = cauda;
+    if (t == cabeca)
+        return false;
+    __dmb();
+    *ev = fila[t & (EVENTOS_TAMANHO - 1)];
+    __dmb();
+    cauda = t + 1;
+    return true;
+}
+
+bool eventos_pendentes(void) {
+    return cauda != cabeca;
+}
+
+uint32_t eventos_descartados(void) {
+    return descartados;
+}
@@ -0,0 +1,22 @@
+#ifndef EVENTOS_H
+#define EVENTOS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "botoes.h"
+
+//===============================================
+// Fila lock-free (um produtor, um consumidor) de eventos de botão
+//
+// O produtor é o amostrador periódico dos botões e o consumidor é o laço
+// principal. Cada lado escreve apenas o seu próprio índice, então não há
+// necessidade de desabilitar interrupções. O tamanho é potência de 2 para usar máscara.
+//===============================================
+#define EVENTOS_TAMANHO 16
+
+bool eventos_publicar(const evento_botao_t *ev);
+bool eventos_retirar(evento_botao_t *ev);
+bool eventos_pendentes(void);
+uint32_t eventos_descartados(void);
+
+#endif
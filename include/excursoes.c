@@ -0,0 +1,90 @@
+#include "excursoes.h"
+#include <float.h>
+#include <string.h>
+
+void excursoes_init(excursoes_t *e, const excursoes_t *restaurar) {
+    if (restaurar) {
+        *e = *restaurar;
+        e->iniciado = false;   // O relógio recomeçou: a próxima amostra só semeia
+        return;
+    }
+    memset(e, 0, sizeof(*e));
+}
+
+// Desvio além do limite nas direções que são alarme (negativo = dentro)
+static float desvio(float v, float inferior, float superior, bool abaixo, bool acima) {
+    float d = -FLT_MAX;
+    if (acima)
+        d = v - superior;
+    if (abaixo && inferior - v > d)
+        d = inferior - v;
+    return d;
+}
+
+// Parte de [0, dt] fora da faixa e a área do desvio, com o desvio variando
+// linearmente de d0 a d1; no cruzamento conta só o trecho de fora
+static void integrar(float d0, float d1, uint32_t dt_ms, float *fora_ms, float *area) {
+    if (d0 <= 0.0f && d1 <= 0.0f) {
+        *fora_ms = 0.0f;
+        *area = 0.0f;
+    } else if (d0 > 0.0f && d1 > 0.0f) {
+        *fora_ms = (float)dt_ms;
+        *area = 0.5f * (d0 + d1) * (float)dt_ms;
+    } else {
+        float positivo = d0 > 0.0f ? d0 : d1;
+        float negativo = d0 > 0.0f ? d1 : d0;
+        *fora_ms = (float)dt_ms * positivo / (positivo - negativo);
+        *area = 0.5f * positivo * *fora_ms;
+    }
+}
+
+void excursoes_processar(excursoes_t *e, const zonas_t *z, const zona_limites_t *l, uint8_t num_zonas,
+                         uint32_t agora_ms) {
+    uint32_t dt_ms = e->iniciado ? agora_ms - e->ultimo_ms : 0;
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        bool abaixo = (ZONA_ALARMES & ZONA_ABAIXO(s)) != 0;
+        bool acima = (ZONA_ALARMES & ZONA_ACIMA(s)) != 0;
+        uint16_t bit = (uint16_t)(1u << s);
+        for (int i = 0; i < num_zonas; i++) {
+            float v = z->valor[s][i];
+            float inferior = l->inferior[s][i], superior = l->superior[s][i];
+            float d1 = desvio(v, inferior, superior, abaixo, acima);
+            if (dt_ms > 0) {
+                // Com os limites atuais nas duas pontas: mudar o setpoint não cria área retroativa
+                float d0 = desvio(e->anterior[s][i], inferior, superior, abaixo, acima);
+                float fora_ms, area;
+                integrar(d0, d1, dt_ms, &fora_ms, &area);
+                if (fora_ms > 0.0f) {
+                    uint32_t fora = (uint32_t)(fora_ms + 0.5f);
+                    e->integral[s][i] += (int64_t)(area * 1000.0f + 0.5f);
+                    e->tempo_fora_ms[s][i] += fora;
+                    uint32_t atual = e->atual_ms[s][i];
+                    atual = atual + fora < atual ? UINT32_MAX : atual + fora;   // Satura
+                    e->atual_ms[s][i] = atual;
+                    if (atual > e->maior_ms[s][i])
+                        e->maior_ms[s][i] = atual;
+                }
+            }
+            if (d1 > 0.0f) {
+                if (!(e->ativa[i] & bit)) {
+                    e->ativa[i] |= bit;
+                    e->contagem[s][i]++;
+                }
+                if (d1 > e->pico_desvio[s][i]) {
+                    e->pico_desvio[s][i] = d1;
+                    e->pico[s][i] = v;
+                }
+            } else if (e->ativa[i] & bit) {
+                e->ativa[i] &= (uint16_t)~bit;
+                e->atual_ms[s][i] = 0;
+            }
+            e->anterior[s][i] = v;
+        }
+    }
+    e->ultimo_ms = agora_ms;
+    e->iniciado = true;
+}
+
+float excursoes_unidade_minuto(const excursoes_t *e, cal_canal_t sensor, uint8_t zona) {
+    return (float)((double)e->integral[sensor][zona] / (1000.0 * 60000.0));
+}
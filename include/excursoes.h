@@ -0,0 +1,44 @@
+#ifndef EXCURSOES_H
+#define EXCURSOES_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "zonas.h"
+
+//===============================================
+// Contabilidade de excursões da cadeia do frio
+//
+// Para cada sensor e zona acumula, nas direções que são alarme
+// (ZONA_ALARMES): a integral do desvio além do setpoint (grau-minuto na
+// temperatura, ppm-minuto no etileno e no CO₂), o tempo fora da faixa,
+// o número de excursões, a mais longa e o pico. A integral usa o tempo
+// real entre amostras, com interpolação linear entre duas medidas e no
+// cruzamento do limite, então o resultado não depende da taxa do laço.
+// Cada amostra custa O(1) por sensor e zona. Tabelas [sensor][zona] como
+// em zonas.h; a estrutura inteira é salva no estado persistente.
+//===============================================
+typedef struct {
+    int64_t integral[ZONA_NUM_SENSORES][NUM_ZONAS];       // Mili-unidades x ms
+    uint64_t tempo_fora_ms[ZONA_NUM_SENSORES][NUM_ZONAS];
+    uint32_t atual_ms[ZONA_NUM_SENSORES][NUM_ZONAS];      // Excursão em andamento
+    uint32_t maior_ms[ZONA_NUM_SENSORES][NUM_ZONAS];
+    float pico[ZONA_NUM_SENSORES][NUM_ZONAS];             // Medida mais distante do limite
+    float pico_desvio[ZONA_NUM_SENSORES][NUM_ZONAS];
+    float anterior[ZONA_NUM_SENSORES][NUM_ZONAS];         // Medida da amostra anterior
+    uint16_t contagem[ZONA_NUM_SENSORES][NUM_ZONAS];
+    uint16_t ativa[NUM_ZONAS];                            // Bit s = excursão do sensor s em andamento
+    uint32_t ultimo_ms;
+    bool iniciado;   // Há amostra anterior neste boot
+} excursoes_t;
+
+// Zera os acumuladores, ou parte de um estado salvo (continua a
+// excursão em andamento, mas não integra o intervalo do reinício)
+void excursoes_init(excursoes_t *e, const excursoes_t *restaurar);
+// Chamado com as medidas de zonas_processar e o instante da amostra
+void excursoes_processar(excursoes_t *e, const zonas_t *z, const zona_limites_t *l, uint8_t num_zonas,
+                         uint32_t agora_ms);
+
+// Integral em unidade x minuto (grau-minuto, ppm-minuto)
+float excursoes_unidade_minuto(const excursoes_t *e, cal_canal_t sensor, uint8_t zona);
+
+#endif
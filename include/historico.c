@@ -0,0 +1,97 @@
+#include "historico.h"
+#include "crc.h"
+#include <stddef.h>
+
+#define TAMANHO_REGISTRO ((uint32_t)sizeof(historico_registro_t))
+
+bool historico_valido(const historico_registro_t *r) {
+    return r->sequencia != HISTORICO_VAZIO && r->crc == crc32(r, offsetof(historico_registro_t, crc));
+}
+
+static bool em_branco(const historico_t *h, uint32_t deslocamento, uint32_t len) {
+    const uint32_t *p = (const uint32_t *)(h->flash.base + deslocamento);
+    for (uint32_t i = 0; i < len / 4; i++)
+        if (p[i] != 0xFFFFFFFFu)
+            return false;
+    return true;
+}
+
+static bool setor_tem_registro(const historico_t *h, uint32_t posicao) {
+    for (uint32_t i = 0; i < HISTORICO_POR_SETOR; i++)
+        if (historico_valido(historico_posicao(h, posicao + i)))
+            return true;
+    return false;
+}
+
+void historico_init(historico_t *h, historico_flash_t flash, bool nova_viagem) {
+    h->flash = flash;
+    h->capacidade = flash.tamanho / HISTORICO_SETOR * HISTORICO_POR_SETOR;
+    h->proximo = 0;
+    h->sequencia = 0;
+    h->viagem = 0;
+    h->gravados = 0;
+    h->falhas = 0;
+    // O CRC só é conferido nos candidatos a mais novo: a varredura de
+    // 512 KB fica limitada pela leitura da flash
+    bool achou = false;
+    uint32_t maior = 0;
+    for (uint32_t i = 0; i < h->capacidade; i++) {
+        const historico_registro_t *r = historico_posicao(h, i);
+        if (r->sequencia == HISTORICO_VAZIO || (achou && r->sequencia <= maior) || !historico_valido(r))
+            continue;
+        achou = true;
+        maior = r->sequencia;
+        h->proximo = (i + 1) % h->capacidade;
+        h->viagem = r->viagem;
+    }
+    if (achou)
+        h->sequencia = maior + 1;
+    if (nova_viagem || h->viagem == 0)
+        h->viagem++;
+}
+
+bool historico_gravar(historico_t *h, historico_registro_t *r) {
+    if (h->capacidade == 0)
+        return false;
+    uint32_t deslocamento = h->proximo * TAMANHO_REGISTRO;
+    if (deslocamento % HISTORICO_SETOR != 0 && !em_branco(h, deslocamento, TAMANHO_REGISTRO)) {
+        // Sobra de uma gravação interrompida: recomeça no próximo setor
+        h->proximo = (h->proximo / HISTORICO_POR_SETOR + 1) * HISTORICO_POR_SETOR % h->capacidade;
+        deslocamento = h->proximo * TAMANHO_REGISTRO;
+    }
+    if (deslocamento % HISTORICO_SETOR == 0 && !em_branco(h, deslocamento, HISTORICO_SETOR) &&
+        !h->flash.apagar_setor(h->flash.ctx, deslocamento)) {
+        h->falhas++;
+        return false;
+    }
+    r->sequencia = h->sequencia;
+    r->viagem = h->viagem;
+    r->crc = crc32(r, offsetof(historico_registro_t, crc));
+    bool ok = h->flash.programar(h->flash.ctx, deslocamento, r, TAMANHO_REGISTRO) &&
+              historico_valido(historico_posicao(h, h->proximo));
+    // Mesmo em erro a posição fica suja: a próxima gravação segue adiante
+    h->proximo = (h->proximo + 1) % h->capacidade;
+    if (!ok) {
+        h->falhas++;
+        return false;
+    }
+    h->sequencia++;
+    h->gravados++;
+    return true;
+}
+
+void historico_janela(const historico_t *h, uint32_t *primeiro, uint32_t *quantidade) {
+    *primeiro = 0;
+    *quantidade = h->proximo;
+    if (h->capacidade == 0)
+        return;
+    // Depois da primeira volta, o setor seguinte ao da gravação (ou o
+    // próprio, se ela está no início dele) guarda os registros mais antigos
+    uint32_t candidato = h->proximo % HISTORICO_POR_SETOR == 0
+                             ? h->proximo
+                             : (h->proximo / HISTORICO_POR_SETOR + 1) * HISTORICO_POR_SETOR % h->capacidade;
+    if (!setor_tem_registro(h, candidato))
+        return;
+    *primeiro = candidato;
+    *quantidade = candidato == h->proximo ? h->capacidade : (h->proximo + h->capacidade - candidato) % h->capacidade;
+}
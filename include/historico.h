@@ -0,0 +1,74 @@
+#ifndef HISTORICO_H
+#define HISTORICO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Histórico da viagem na flash
+//
+// Registros de 32 bytes com número de sequência e CRC-32, gravados em
+// anel sobre uma região de setores de 4 KB. O setor é apagado quando a
+// gravação chega ao seu início, então sempre sobra o histórico mais
+// recente. Na partida, uma varredura acha o registro de maior sequência
+// e a gravação continua depois dele; um registro interrompido por queda
+// de energia falha no CRC e é pulado. Os registros são lidos direto da
+// flash mapeada (XIP), sem cópia em RAM. O acesso físico fica atrás de
+// um backend, como no barramento I2C, o que permite rodar em Linux.
+//===============================================
+#define HISTORICO_SETOR 4096u
+#define HISTORICO_PAGINA 256u     // Gravação mínima da flash
+#define HISTORICO_POR_SETOR (HISTORICO_SETOR / sizeof(historico_registro_t))
+#define HISTORICO_VAZIO 0xFFFFFFFFu   // Sequência de um registro apagado
+
+typedef struct {
+    uint32_t sequencia;      // Crescente ao longo de toda a vida do log
+    uint32_t tempo_s;        // Tempo de viagem (inclui reinícios a quente)
+    uint16_t viagem;         // Incrementa a cada partida a frio
+    uint8_t zona;
+    uint8_t estado;          // Bits ZONA_ABAIXO/ZONA_ACIMA da zona
+    int16_t temp_cc;         // Centésimos de °C
+    uint16_t umidade_dm;     // Décimos de %
+    uint16_t etileno_dm;     // Décimos de ppm
+    uint16_t co2_ppm;
+    uint32_t grau_minuto_dm; // Décimos de °C·min fora da faixa, acumulados na viagem
+    uint32_t fora_s;         // Tempo com a temperatura fora da faixa na viagem
+    uint32_t crc;            // CRC-32 dos campos acima
+} historico_registro_t;
+
+_Static_assert(sizeof(historico_registro_t) == 32, "registro deve dividir a página da flash");
+
+typedef struct {
+    const uint8_t *base;     // Região mapeada para leitura
+    uint32_t tamanho;        // Múltiplo de HISTORICO_SETOR
+    // Deslocamentos relativos à base; retornam false em erro
+    bool (*apagar_setor)(void *ctx, uint32_t deslocamento);
+    bool (*programar)(void *ctx, uint32_t deslocamento, const void *dados, uint32_t len);   // Dentro de uma página
+    void *ctx;
+} historico_flash_t;
+
+typedef struct {
+    historico_flash_t flash;
+    uint32_t capacidade;     // Registros no anel
+    uint32_t proximo;        // Posição da próxima gravação
+    uint32_t sequencia;      // Sequência da próxima gravação
+    uint16_t viagem;
+    uint32_t gravados;       // Neste boot
+    uint32_t falhas;
+} historico_t;
+
+// Varre a região e posiciona a gravação depois do registro mais novo;
+// nova_viagem incrementa o número da viagem (partida a frio)
+void historico_init(historico_t *h, historico_flash_t flash, bool nova_viagem);
+// Preenche sequência, viagem e CRC e grava (apaga o setor ao entrar nele)
+bool historico_gravar(historico_t *h, historico_registro_t *r);
+
+bool historico_valido(const historico_registro_t *r);
+static inline const historico_registro_t *historico_posicao(const historico_t *h, uint32_t i) {
+    return (const historico_registro_t *)(h->flash.base + i * sizeof(historico_registro_t));
+}
+// Posição do registro mais antigo ainda no anel e quantidade de
+// posições até a próxima gravação (algumas podem estar inválidas)
+void historico_janela(const historico_t *h, uint32_t *primeiro, uint32_t *quantidade);
+
+#endif
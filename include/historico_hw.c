@@ -0,0 +1,53 @@
+#include "historico_hw.h"
+#include "hardware/flash.h"
+#include "pico/flash.h"
+#include <string.h>
+
+#define HISTORICO_TAMANHO (HISTORICO_KB * 1024u)
+#define HISTORICO_INICIO (PICO_FLASH_SIZE_BYTES - HISTORICO_TAMANHO)
+#define TIMEOUT_FLASH_MS 100
+
+_Static_assert(HISTORICO_TAMANHO % FLASH_SECTOR_SIZE == 0 && HISTORICO_TAMANHO < PICO_FLASH_SIZE_BYTES,
+               "HISTORICO_KB deve ser múltiplo de 4 e menor que a flash");
+_Static_assert(HISTORICO_SETOR == FLASH_SECTOR_SIZE && HISTORICO_PAGINA == FLASH_PAGE_SIZE,
+               "geometria do histórico difere da flash");
+
+typedef struct {
+    uint32_t deslocamento;
+    uint8_t pagina[FLASH_PAGE_SIZE];
+} operacao_t;
+
+static void apagar_seguro(void *param) {
+    flash_range_erase(HISTORICO_INICIO + ((operacao_t *)param)->deslocamento, FLASH_SECTOR_SIZE);
+}
+
+static void programar_seguro(void *param) {
+    operacao_t *op = param;
+    flash_range_program(HISTORICO_INICIO + op->deslocamento, op->pagina, FLASH_PAGE_SIZE);
+}
+
+static bool apagar_hw(void *ctx, uint32_t deslocamento) {
+    operacao_t op = { .deslocamento = deslocamento };
+    return flash_safe_execute(apagar_seguro, &op, TIMEOUT_FLASH_MS) == PICO_OK;
+}
+
+static bool programar_hw(void *ctx, uint32_t deslocamento, const void *dados, uint32_t len) {
+    // A flash só programa páginas inteiras; 0xFF mantém os bytes vizinhos.
+    // A página é montada antes, para encurtar o trecho sem interrupções.
+    operacao_t op;
+    op.deslocamento = deslocamento & ~(FLASH_PAGE_SIZE - 1u);
+    memset(op.pagina, 0xFF, sizeof(op.pagina));
+    memcpy(op.pagina + (deslocamento - op.deslocamento), dados, len);
+    return flash_safe_execute(programar_seguro, &op, TIMEOUT_FLASH_MS) == PICO_OK;
+}
+
+historico_flash_t historico_flash_hw(void) {
+    historico_flash_t flash = {
+        .base = (const uint8_t *)(XIP_BASE + HISTORICO_INICIO),
+        .tamanho = HISTORICO_TAMANHO,
+        .apagar_setor = apagar_hw,
+        .programar = programar_hw,
+        .ctx = NULL,
+    };
+    return flash;
+}
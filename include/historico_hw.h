@@ -0,0 +1,21 @@
+#ifndef HISTORICO_HW_H
+#define HISTORICO_HW_H
+
+#include "historico.h"
+
+// Backend do histórico nos últimos HISTORICO_KB da flash, acima do
+// firmware (o orçamento de flash no CMake garante que não se sobrepõem).
+// Apagar e programar passam por flash_safe_execute: as interrupções
+// ficam desligadas durante a operação (até ~45 ms ao apagar um setor).
+// A UART do Modbus guarda até 32 bytes na FIFO nesse meio tempo, o que
+// cobre a programação de uma página (~1 ms) mas só ~18 ms de um apagamento
+// a 19200 baud. Por isso o laço só grava com o Modbus ocioso; um quadro
+// que começar durante um apagamento (um a cada 128 registros) pode perder
+// bytes, falha no CRC e o mestre repete a requisição.
+#ifndef HISTORICO_KB
+#define HISTORICO_KB 512
+#endif
+
+historico_flash_t historico_flash_hw(void);
+
+#endif
@@ -0,0 +1,124 @@
+#include "i2c_simulado.h"
+#include "sht3x.h"
+#include "scd4x.h"
+#include "crc.h"
+#include <string.h>
+
+#define SIM_NACK (-1)
+
+void i2c_simulado_init(i2c_simulado_t *sim, const i2c_backend_t *encaminhar, uint64_t (*relogio_us)(void)) {
+    memset(sim, 0, sizeof(*sim));
+    sim->encaminhar = encaminhar;
+    sim->relogio_us = relogio_us;
+    sim->scd_co2 = 400.0f;
+}
+
+void i2c_simulado_definir_sht3x(i2c_simulado_t *sim, float temperatura, float umidade) {
+    sim->sht_temperatura = temperatura;
+    sim->sht_umidade = umidade;
+}
+
+void i2c_simulado_definir_scd4x(i2c_simulado_t *sim, float co2, float temperatura, float umidade) {
+    sim->scd_co2 = co2;
+    sim->scd_temperatura = temperatura;
+    sim->scd_umidade = umidade;
+}
+
+// Palavra de 16 bits seguida do CRC-8, como nos sensores Sensirion
+static void escrever_palavra(uint8_t *destino, uint16_t valor) {
+    destino[0] = valor >> 8;
+    destino[1] = valor & 0xFF;
+    destino[2] = crc8_sensirion(destino, 2);
+}
+
+static uint16_t bruto_temperatura(float t) {
+    float r = (t + 45.0f) * 65535.0f / 175.0f;
+    return (uint16_t)(r < 0.0f ? 0.0f : (r > 65535.0f ? 65535.0f : r));
+}
+
+static uint16_t bruto_umidade(float ur) {
+    float r = ur * 65535.0f / 100.0f;
+    return (uint16_t)(r < 0.0f ? 0.0f : (r > 65535.0f ? 65535.0f : r));
+}
+
+static int escrever_sim(void *ctx, uint8_t endereco, const uint8_t *dados, size_t len, uint32_t timeout_us) {
+    i2c_simulado_t *sim = ctx;
+    uint64_t agora = sim->relogio_us();
+    if (endereco == SHT3X_ENDERECO) {
+        // Terminada a conversão o sensor volta a aceitar comandos, mesmo
+        // que o resultado não tenha sido lido (uma leitura perdida não o trava)
+        if (sim->sht_medindo && (int64_t)(agora - sim->sht_pronto_us) >= 0)
+            sim->sht_medindo = false;
+        if (len != 2 || sim->sht_medindo)
+            return SIM_NACK;
+        if (((dados[0] << 8) | dados[1]) == SHT3X_CMD_MEDIR_ALTA) {
+            // Valores amostrados no início da conversão, como no sensor real
+            escrever_palavra(&sim->sht_dados[0], bruto_temperatura(sim->sht_temperatura));
+            escrever_palavra(&sim->sht_dados[3], bruto_umidade(sim->sht_umidade));
+            sim->sht_medindo = true;
+            sim->sht_pronto_us = agora + SHT3X_TEMPO_CONVERSAO_US - 1000u;
+        }
+        return (int)len;
+    }
+    if (endereco == SCD4X_ENDERECO) {
+        if (len != 2)
+            return SIM_NACK;
+        uint16_t cmd = (uint16_t)((dados[0] << 8) | dados[1]);
+        if (cmd == SCD4X_CMD_INICIAR_PERIODICA) {
+            sim->scd_periodica = true;
+            sim->scd_proxima_us = agora + SCD4X_PERIODO_US;
+        }
+        sim->scd_ultimo_cmd = cmd;
+        return (int)len;
+    }
+    if (sim->encaminhar)
+        return sim->encaminhar->escrever(sim->encaminhar->ctx, endereco, dados, len, timeout_us);
+    return (int)len;
+}
+
+static int ler_sim(void *ctx, uint8_t endereco, uint8_t *dados, size_t len, uint32_t timeout_us) {
+    i2c_simulado_t *sim = ctx;
+    uint64_t agora = sim->relogio_us();
+    if (endereco == SHT3X_ENDERECO) {
+        // Sem medida concluída o SHT3x responde NACK ao cabeçalho de leitura
+        if (!sim->sht_medindo || (int64_t)(agora - sim->sht_pronto_us) < 0 || len > sizeof(sim->sht_dados))
+            return SIM_NACK;
+        memcpy(dados, sim->sht_dados, len);
+        sim->sht_medindo = false;
+        return (int)len;
+    }
+    if (endereco == SCD4X_ENDERECO) {
+        bool pronto = sim->scd_periodica && (int64_t)(agora - sim->scd_proxima_us) >= 0;
+        uint16_t cmd = sim->scd_ultimo_cmd;
+        sim->scd_ultimo_cmd = 0;
+        if (cmd == SCD4X_CMD_DADO_PRONTO && len <= 3) {
+            uint8_t r[3];
+            escrever_palavra(r, pronto ? 0x8006 : 0x8000);
+            memcpy(dados, r, len);
+            return (int)len;
+        }
+        if (cmd == SCD4X_CMD_LER_MEDIDA && len <= sizeof(sim->scd_dados)) {
+            escrever_palavra(&sim->scd_dados[0], (uint16_t)(sim->scd_co2 < 0.0f ? 0.0f : sim->scd_co2));
+            escrever_palavra(&sim->scd_dados[3], bruto_temperatura(sim->scd_temperatura));
+            escrever_palavra(&sim->scd_dados[6], bruto_umidade(sim->scd_umidade));
+            memcpy(dados, sim->scd_dados, len);
+            if (pronto)
+                sim->scd_proxima_us += SCD4X_PERIODO_US;
+            return (int)len;
+        }
+        return SIM_NACK;
+    }
+    if (sim->encaminhar)
+        return sim->encaminhar->ler(sim->encaminhar->ctx, endereco, dados, len, timeout_us);
+    memset(dados, 0, len);
+    return (int)len;
+}
+
+i2c_backend_t i2c_simulado_backend(i2c_simulado_t *sim) {
+    i2c_backend_t backend = {
+        .escrever = escrever_sim,
+        .ler = ler_sim,
+        .ctx = sim,
+    };
+    return backend;
+}
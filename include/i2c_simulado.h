@@ -0,0 +1,41 @@
+#ifndef I2C_SIMULADO_H
+#define I2C_SIMULADO_H
+
+#include "barramento_i2c.h"
+
+//===============================================
+// Substitutos em nível de registrador do SHT3x e do SCD4x
+//
+// Implementam o mesmo protocolo dos sensores reais (comandos de 16 bits,
+// NACK durante a conversão, palavras com CRC-8) como um backend do
+// barramento. Endereços desconhecidos (ex.: o OLED) são repassados ao
+// backend "encaminhar"; sem ele, são aceitos e descartados, o que permite
+// rodar drivers e escalonador em um build de host.
+//===============================================
+typedef struct {
+    const i2c_backend_t *encaminhar;
+    uint64_t (*relogio_us)(void);
+
+    // SHT3x
+    float sht_temperatura;
+    float sht_umidade;
+    bool sht_medindo;
+    uint64_t sht_pronto_us;
+    uint8_t sht_dados[6];
+
+    // SCD4x
+    float scd_co2;
+    float scd_temperatura;
+    float scd_umidade;
+    bool scd_periodica;
+    uint64_t scd_proxima_us;   // Instante do próximo resultado periódico
+    uint16_t scd_ultimo_cmd;
+    uint8_t scd_dados[9];
+} i2c_simulado_t;
+
+void i2c_simulado_init(i2c_simulado_t *sim, const i2c_backend_t *encaminhar, uint64_t (*relogio_us)(void));
+i2c_backend_t i2c_simulado_backend(i2c_simulado_t *sim);
+void i2c_simulado_definir_sht3x(i2c_simulado_t *sim, float temperatura, float umidade);
+void i2c_simulado_definir_scd4x(i2c_simulado_t *sim, float co2, float temperatura, float umidade);
+
+#endif
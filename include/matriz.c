@@ -0,0 +1,250 @@
+#include "matriz.h"
+#include <string.h>
+
+//===============================================
+// Mapeamento lógico -> físico, gerado na compilação
+//
+// Serpentina da BitDogLab: o LED 0 fica no canto inferior direito e as
+// linhas alternam o sentido. A rotação é aplicada antes, sobre (linha,
+// coluna), para montar a placa em qualquer orientação.
+//===============================================
+_Static_assert(MATRIZ_PIXELS == 25, "REPETIR_25 assume a matriz 5x5");
+
+#define ULTIMA (MATRIZ_LADO - 1)
+#define LINHA(p) ((p) / MATRIZ_LADO)
+#define COLUNA(p) ((p) % MATRIZ_LADO)
+// Onde o pixel p cai após r quartos de volta no sentido horário
+#define ROT_LINHA(p, r) ((r) == 0 ? LINHA(p) : (r) == 1 ? COLUNA(p) : (r) == 2 ? ULTIMA - LINHA(p) : ULTIMA - COLUNA(p))
+#define ROT_COLUNA(p, r) ((r) == 0 ? COLUNA(p) : (r) == 1 ? ULTIMA - LINHA(p) : (r) == 2 ? ULTIMA - COLUNA(p) : LINHA(p))
+#define SERPENTINA(l, c) (MATRIZ_PIXELS - 1 - ((l) * MATRIZ_LADO + (((l) % 2) ? ULTIMA - (c) : (c))))
+#define MAPA(p, r) SERPENTINA(ROT_LINHA(p, r), ROT_COLUNA(p, r))
+#define REPETIR_25(F, r)                                                                         \
+    F(0, r), F(1, r), F(2, r), F(3, r), F(4, r), F(5, r), F(6, r), F(7, r), F(8, r), F(9, r),    \
+    F(10, r), F(11, r), F(12, r), F(13, r), F(14, r), F(15, r), F(16, r), F(17, r), F(18, r),    \
+    F(19, r), F(20, r), F(21, r), F(22, r), F(23, r), F(24, r)
+
+static const uint8_t MAPA_FISICO[4][MATRIZ_PIXELS] = {
+    { REPETIR_25(MAPA, 0) },
+    { REPETIR_25(MAPA, 1) },
+    { REPETIR_25(MAPA, 2) },
+    { REPETIR_25(MAPA, 3) },
+};
+
+// round(255 * (i / 255)^2,2)
+static const uint8_t GAMMA[256] = {
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,
+      1,   1,   1,   1,   1,   1,   1,   1,   1,   2,   2,   2,   2,   2,   2,   2,
+      3,   3,   3,   3,   3,   4,   4,   4,   4,   5,   5,   5,   5,   6,   6,   6,
+      6,   7,   7,   7,   8,   8,   8,   9,   9,   9,  10,  10,  11,  11,  11,  12,
+     12,  13,  13,  13,  14,  14,  15,  15,  16,  16,  17,  17,  18,  18,  19,  19,
+     20,  20,  21,  22,  22,  23,  23,  24,  25,  25,  26,  26,  27,  28,  28,  29,
+     30,  30,  31,  32,  33,  33,  34,  35,  35,  36,  37,  38,  39,  39,  40,  41,
+     42,  43,  43,  44,  45,  46,  47,  48,  49,  49,  50,  51,  52,  53,  54,  55,
+     56,  57,  58,  59,  60,  61,  62,  63,  64,  65,  66,  67,  68,  69,  70,  71,
+     73,  74,  75,  76,  77,  78,  79,  81,  82,  83,  84,  85,  87,  88,  89,  90,
+     91,  93,  94,  95,  97,  98,  99, 100, 102, 103, 105, 106, 107, 109, 110, 111,
+    113, 114, 116, 117, 119, 120, 121, 123, 124, 126, 127, 129, 130, 132, 133, 135,
+    137, 138, 140, 141, 143, 145, 146, 148, 149, 151, 153, 154, 156, 158, 159, 161,
+    163, 165, 166, 168, 170, 172, 173, 175, 177, 179, 181, 182, 184, 186, 188, 190,
+    192, 194, 196, 197, 199, 201, 203, 205, 207, 209, 211, 213, 215, 217, 219, 221,
+    223, 225, 227, 229, 231, 234, 236, 238, 240, 242, 244, 246, 248, 251, 253, 255,
+};
+
+// Fonte 3x5 para o texto rolante, por coluna (bit 4 = linha de cima)
+static const uint8_t FONTE_DIGITOS[10][3] = {
+    { 0x1F, 0x11, 0x1F }, { 0x09, 0x1F, 0x01 }, { 0x17, 0x15, 0x1D }, { 0x15, 0x15, 0x1F },
+    { 0x1C, 0x04, 0x1F }, { 0x1D, 0x15, 0x17 }, { 0x1F, 0x15, 0x17 }, { 0x10, 0x10, 0x1F },
+    { 0x1F, 0x15, 0x1F }, { 0x1D, 0x15, 0x1F },
+};
+
+static void montar_lut(matriz_t *m, uint8_t brilho) {
+    for (int i = 0; i < 256; i++)
+        m->lut[i] = (uint8_t)((GAMMA[i] * brilho + 127) / 255);
+    m->lut_brilho = brilho;
+}
+
+static matriz_sprite_paleta_t expandir(matriz_sprite_t sprite) {
+    matriz_sprite_paleta_t s = 0;
+    for (int p = 0; p < MATRIZ_PIXELS; p++) {
+        if (sprite & (1u << p))
+            s |= (matriz_sprite_paleta_t)1 << (2 * p);
+    }
+    return s;
+}
+
+void matriz_init(matriz_t *m, uint8_t rotacao, uint8_t brilho) {
+    memset(m, 0, sizeof(*m));
+    m->rotacao = rotacao & 3;
+    m->brilho = brilho;
+    montar_lut(m, brilho);
+}
+
+static bool mesma_cena(const matriz_cena_t *a, const matriz_cena_t *b) {
+    return a->animacao == b->animacao && a->sprite == b->sprite && a->periodo_ms == b->periodo_ms &&
+           memcmp(a->paleta, b->paleta, sizeof(a->paleta)) == 0 && a->num_colunas == b->num_colunas &&
+           memcmp(a->colunas, b->colunas, a->num_colunas) == 0;
+}
+
+// Escreve no slot livre e só então troca o slot ativo: o temporizador
+// nunca lê uma cena pela metade
+static void publicar(matriz_t *m, const matriz_cena_t *nova) {
+    if (mesma_cena(nova, &m->cenas[m->ativa]))
+        return;
+    uint8_t livre = m->ativa ^ 1u;
+    m->cenas[livre] = *nova;
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    m->ativa = livre;
+    if (m->notificar)
+        m->notificar(m->ctx);
+}
+
+static void cena_basica(matriz_cena_t *c, matriz_animacao_t animacao, matriz_sprite_t sprite,
+                        matriz_cor_t cor, uint32_t periodo_ms, uint32_t agora_ms) {
+    memset(c, 0, sizeof(*c));
+    c->animacao = animacao;
+    c->sprite = expandir(sprite);
+    c->paleta[1] = cor;
+    c->periodo_ms = periodo_ms ? periodo_ms : 1;
+    c->inicio_ms = agora_ms;
+}
+
+void matriz_sprite(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t agora_ms) {
+    matriz_cena_t c;
+    cena_basica(&c, MATRIZ_ESTATICA, sprite, cor, 1, agora_ms);
+    publicar(m, &c);
+}
+
+void matriz_paleta(matriz_t *m, matriz_sprite_paleta_t sprite, const matriz_cor_t paleta[MATRIZ_CORES_PALETA],
+                   uint32_t agora_ms) {
+    matriz_cena_t c;
+    cena_basica(&c, MATRIZ_ESTATICA, 0, paleta[1], 1, agora_ms);
+    c.sprite = sprite;
+    memcpy(c.paleta, paleta, sizeof(c.paleta));
+    publicar(m, &c);
+}
+
+void matriz_pulsar(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t periodo_ms, uint32_t agora_ms) {
+    matriz_cena_t c;
+    cena_basica(&c, MATRIZ_PULSO, sprite, cor, periodo_ms, agora_ms);
+    publicar(m, &c);
+}
+
+void matriz_transicao(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t duracao_ms, uint32_t agora_ms) {
+    matriz_cena_t c;
+    cena_basica(&c, MATRIZ_TRANSICAO, sprite, cor, duracao_ms, agora_ms);
+    uint32_t atual = m->cor_atual;
+    c.de = (matriz_cor_t){ (uint8_t)(atual >> 16), (uint8_t)(atual >> 8), (uint8_t)atual };
+    publicar(m, &c);
+}
+
+void matriz_rolar(matriz_t *m, const char *texto, matriz_cor_t cor, uint32_t passo_ms, uint32_t agora_ms) {
+    matriz_cena_t c;
+    cena_basica(&c, MATRIZ_ROLAGEM, 0, cor, passo_ms, agora_ms);
+    uint8_t n = 0;
+    for (; *texto; texto++) {
+        uint8_t glifo[3];
+        uint8_t largura;
+        if (*texto >= '0' && *texto <= '9') {
+            memcpy(glifo, FONTE_DIGITOS[*texto - '0'], 3);
+            largura = 3;
+        } else if (*texto == '.') {
+            glifo[0] = 0x01;
+            largura = 1;
+        } else if (*texto == '-') {
+            glifo[0] = glifo[1] = 0x04;
+            largura = 2;
+        } else {
+            glifo[0] = glifo[1] = 0x00;
+            largura = 2;
+        }
+        if (n + largura + 1 > MATRIZ_COLUNAS_MAX)
+            break;
+        memcpy(&c.colunas[n], glifo, largura);
+        n += largura + 1;   // Coluna de espaçamento já zerada
+    }
+    c.num_colunas = n;
+    publicar(m, &c);
+}
+
+void matriz_apagar(matriz_t *m, uint32_t agora_ms) {
+    matriz_sprite(m, 0, (matriz_cor_t){ 0, 0, 0 }, agora_ms);
+}
+
+void matriz_definir_brilho(matriz_t *m, uint8_t brilho) {
+    if (m->brilho == brilho)
+        return;
+    m->brilho = brilho;
+    if (m->notificar)
+        m->notificar(m->ctx);
+}
+
+static uint8_t misturar(uint8_t de, uint8_t para, uint32_t fracao) {   // fracao em 1/256
+    return (uint8_t)(de + (((int32_t)para - de) * (int32_t)fracao) / 256);
+}
+
+bool matriz_quadro(matriz_t *m, uint32_t agora_ms) {
+    const matriz_cena_t *c = &m->cenas[m->ativa];
+    if (m->lut_brilho != m->brilho)
+        montar_lut(m, m->brilho);
+
+    uint32_t t = agora_ms - c->inicio_ms;
+    matriz_sprite_paleta_t sprite = c->sprite;
+    matriz_cor_t paleta[MATRIZ_CORES_PALETA];
+    memcpy(paleta, c->paleta, sizeof(paleta));
+    uint32_t fator = 256;
+    bool animada = true;
+
+    switch (c->animacao) {
+    case MATRIZ_PULSO: {
+        // Onda triangular: fator de 64 (1/4) a 256
+        uint32_t fase = t % c->periodo_ms;
+        uint32_t meio = c->periodo_ms / 2 + 1;
+        uint32_t triangulo = fase < meio ? fase * 256 / meio : (c->periodo_ms - fase) * 256 / meio;
+        fator = 64 + triangulo * 192 / 256;
+        break;
+    }
+    case MATRIZ_TRANSICAO:
+        if (t < c->periodo_ms) {
+            uint32_t fracao = t * 256 / c->periodo_ms;
+            paleta[1].r = misturar(c->de.r, c->paleta[1].r, fracao);
+            paleta[1].g = misturar(c->de.g, c->paleta[1].g, fracao);
+            paleta[1].b = misturar(c->de.b, c->paleta[1].b, fracao);
+        } else {
+            animada = false;
+        }
+        break;
+    case MATRIZ_ROLAGEM: {
+        // Entra pela direita e sai pela esquerda, em ciclo
+        uint32_t deslocamento = (t / c->periodo_ms) % (c->num_colunas + MATRIZ_LADO);
+        sprite = 0;
+        for (int coluna = 0; coluna < MATRIZ_LADO; coluna++) {
+            int i = (int)deslocamento + coluna - MATRIZ_LADO;
+            uint8_t bits = (i >= 0 && i < c->num_colunas) ? c->colunas[i] : 0;
+            for (int linha = 0; linha < MATRIZ_LADO; linha++) {
+                if (bits & (1u << (ULTIMA - linha)))
+                    sprite |= (matriz_sprite_paleta_t)1 << (2 * (MATRIZ_PIXELS - 1 - (linha * MATRIZ_LADO + coluna)));
+            }
+        }
+        break;
+    }
+    default:
+        animada = false;
+        break;
+    }
+    m->cor_atual = ((uint32_t)paleta[1].r << 16) | ((uint32_t)paleta[1].g << 8) | paleta[1].b;
+
+    // Cores já em palavras GRB << 8 (formato da PIO)
+    uint32_t palavras[MATRIZ_CORES_PALETA];
+    for (int i = 0; i < MATRIZ_CORES_PALETA; i++) {
+        uint8_t r = m->lut[paleta[i].r * fator >> 8];
+        uint8_t g = m->lut[paleta[i].g * fator >> 8];
+        uint8_t b = m->lut[paleta[i].b * fator >> 8];
+        palavras[i] = ((uint32_t)g << 24) | ((uint32_t)r << 16) | ((uint32_t)b << 8);
+    }
+    const uint8_t *mapa = MAPA_FISICO[m->rotacao];
+    for (int p = 0; p < MATRIZ_PIXELS; p++) {
+        uint32_t indice = (uint32_t)(sprite >> (2 * (MATRIZ_PIXELS - 1 - p))) & 3u;
+        m->quadro[mapa[p]] = palavras[indice];
+    }
+    return animada;
+}
@@ -0,0 +1,93 @@
+#ifndef MATRIZ_H
+#define MATRIZ_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Motor gráfico da matriz WS2812 5x5
+//
+// Sprites ocupam um bit por pixel (uint32_t) ou dois bits por pixel com
+// índice numa paleta de 4 cores (uint64_t). A cena atual (sprite, cores e
+// animação) é publicada pelo laço principal em dois slots alternados; o
+// quadro é gerado pelo temporizador da matriz (matriz_hw.c), que aplica
+// a animação, a LUT de gama e brilho e o mapeamento serpentina/rotação.
+// Não depende do SDK: os quadros também podem ser gerados em Linux.
+//===============================================
+#define MATRIZ_LADO 5
+#define MATRIZ_PIXELS (MATRIZ_LADO * MATRIZ_LADO)
+#define MATRIZ_CORES_PALETA 4
+#define MATRIZ_COLUNAS_MAX 32   // Texto rolante: até 8 caracteres
+
+// Pixel (linha, coluna) no bit 24 - (5*linha + coluna): cada linha é
+// escrita da esquerda para a direita, ex.: MATRIZ_SPRITE(0b01010, ...)
+typedef uint32_t matriz_sprite_t;
+#define MATRIZ_SPRITE(l0, l1, l2, l3, l4)                                    \
+    (((uint32_t)(l0) << 20) | ((uint32_t)(l1) << 15) | ((uint32_t)(l2) << 10) | \
+     ((uint32_t)(l3) << 5) | (uint32_t)(l4))
+
+// Mesma ordem, dois bits por pixel; MATRIZ_LINHA_PALETA(a, b, c, d, e)
+// monta uma linha com os índices de cada coluna
+typedef uint64_t matriz_sprite_paleta_t;
+#define MATRIZ_LINHA_PALETA(a, b, c, d, e) \
+    (((uint64_t)(a) << 8) | ((uint64_t)(b) << 6) | ((uint64_t)(c) << 4) | ((uint64_t)(d) << 2) | (uint64_t)(e))
+#define MATRIZ_SPRITE_PALETA(l0, l1, l2, l3, l4) \
+    (((uint64_t)(l0) << 40) | ((uint64_t)(l1) << 30) | ((uint64_t)(l2) << 20) | ((uint64_t)(l3) << 10) | (uint64_t)(l4))
+
+typedef struct {
+    uint8_t r, g, b;
+} matriz_cor_t;
+
+typedef enum {
+    MATRIZ_ESTATICA = 0,
+    MATRIZ_PULSO,       // Brilho oscila entre 1/4 e o máximo
+    MATRIZ_TRANSICAO,   // Cor do índice 1 passa de 'de' para a da paleta
+    MATRIZ_ROLAGEM      // Texto rola da direita para a esquerda
+} matriz_animacao_t;
+
+typedef struct {
+    matriz_animacao_t animacao;
+    matriz_sprite_paleta_t sprite;
+    matriz_cor_t paleta[MATRIZ_CORES_PALETA];   // Índice 0 costuma ser apagado
+    matriz_cor_t de;                            // Início da transição
+    uint32_t periodo_ms;    // Pulso: período; transição: duração; rolagem: ms por coluna
+    uint32_t inicio_ms;
+    uint8_t num_colunas;
+    uint8_t colunas[MATRIZ_COLUNAS_MAX];   // Rolagem: bit 4 = linha 0
+} matriz_cena_t;
+
+typedef struct {
+    matriz_cena_t cenas[2];
+    volatile uint8_t ativa;        // Slot lido pelo temporizador
+    volatile uint8_t brilho;       // 0..255, aplicado depois da gama
+    volatile uint32_t cor_atual;   // Última cor do índice 1 exibida (0x00RRGGBB)
+    uint8_t rotacao;               // Quartos de volta no sentido horário
+    uint8_t lut_brilho;            // Brilho com que a LUT foi montada
+    uint8_t lut[256];              // Gama 2,2 x brilho
+    uint32_t quadro[MATRIZ_PIXELS];   // Palavras GRB << 8 na ordem física, prontas para a PIO
+
+    // Avisa o temporizador que há cena nova (preenchido por matriz_hw)
+    void (*notificar)(void *ctx);
+    void *ctx;
+} matriz_t;
+
+void matriz_init(matriz_t *m, uint8_t rotacao, uint8_t brilho);
+
+// Cenas publicadas pelo laço principal. Republicar a cena em exibição não
+// reinicia a animação, então podem ser chamadas a cada amostra.
+void matriz_sprite(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t agora_ms);
+void matriz_paleta(matriz_t *m, matriz_sprite_paleta_t sprite, const matriz_cor_t paleta[MATRIZ_CORES_PALETA],
+                   uint32_t agora_ms);
+void matriz_pulsar(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t periodo_ms, uint32_t agora_ms);
+// Parte da cor em exibição
+void matriz_transicao(matriz_t *m, matriz_sprite_t sprite, matriz_cor_t cor, uint32_t duracao_ms, uint32_t agora_ms);
+// Dígitos, '.', '-' e espaço
+void matriz_rolar(matriz_t *m, const char *texto, matriz_cor_t cor, uint32_t passo_ms, uint32_t agora_ms);
+void matriz_apagar(matriz_t *m, uint32_t agora_ms);
+void matriz_definir_brilho(matriz_t *m, uint8_t brilho);
+
+// Gera m->quadro para o instante dado; retorna true se a cena é animada
+// e precisa de novos quadros. Chamado só pelo temporizador.
+bool matriz_quadro(matriz_t *m, uint32_t agora_ms);
+
+#endif
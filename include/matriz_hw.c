@@ -0,0 +1,56 @@
+#include "matriz_hw.h"
+#include "pilha.h"
+#include "hardware/dma.h"
+#include "hardware/timer.h"
+#include "pico/time.h"
+
+// 25 LEDs x 24 bits a 800 kHz (750 µs) mais o reset de 50 µs
+#define MATRIZ_HW_INTERVALO_MIN_US 1000
+
+static matriz_t *instancia;
+static int canal_dma = -1;
+static volatile bool alarme_ativo;
+static volatile uint32_t ultimo_envio_us;   // 32 bits: lido também pelo laço principal
+
+static int64_t gerar_quadro(alarm_id_t id, void *dados) {
+    uint64_t agora_us = time_us_64();
+    // O quadro anterior ainda sai pela PIO ou não houve o reset: tenta logo depois
+    if (dma_channel_is_busy((uint)canal_dma) || (uint32_t)agora_us - ultimo_envio_us < MATRIZ_HW_INTERVALO_MIN_US)
+        return MATRIZ_HW_INTERVALO_MIN_US;
+    uint32_t *sp = pilha_irq_entrar();
+    bool animada = matriz_quadro(instancia, (uint32_t)(agora_us / 1000u));
+    dma_channel_transfer_from_buffer_now((uint)canal_dma, instancia->quadro, MATRIZ_PIXELS);
+    ultimo_envio_us = (uint32_t)agora_us;
+    pilha_irq_sair(sp);
+    if (animada)
+        return -(int64_t)MATRIZ_HW_PERIODO_QUADRO_MS * 1000;
+    alarme_ativo = false;   // Cena estática: para até a próxima publicação
+    return 0;
+}
+
+bool matriz_hw_ocupada(void) {
+    return dma_channel_is_busy((uint)canal_dma) || time_us_32() - ultimo_envio_us < MATRIZ_HW_INTERVALO_MIN_US;
+}
+
+// Chamado pelo laço principal ao publicar uma cena
+static void notificar(void *ctx) {
+    if (alarme_ativo)
+        return;   // O alarme pendente já vai ler a cena nova
+    alarme_ativo = true;
+    if (add_alarm_in_us(0, gerar_quadro, NULL, true) < 0)
+        alarme_ativo = false;
+}
+
+void matriz_hw_iniciar(matriz_t *m, PIO pio, uint sm) {
+    instancia = m;
+    canal_dma = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)canal_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, pio_get_dreq(pio, sm, true));
+    dma_channel_configure((uint)canal_dma, &c, &pio->txf[sm], NULL, 0, false);
+    m->notificar = notificar;
+    m->ctx = NULL;
+    notificar(NULL);
+}
@@ -0,0 +1,18 @@
+#ifndef MATRIZ_HW_H
+#define MATRIZ_HW_H
+
+#include "matriz.h"
+#include "hardware/pio.h"
+
+// Saída da matriz numa máquina de estados WS2812 já configurada: um
+// alarme gera cada quadro (a cada MATRIZ_HW_PERIODO_QUADRO_MS enquanto a
+// cena é animada, e uma única vez quando é estática) e o DMA o entrega à
+// FIFO da PIO, sem ocupar a CPU. Há uma única instância (o alarme precisa
+// de um ponteiro global).
+#define MATRIZ_HW_PERIODO_QUADRO_MS 20
+
+void matriz_hw_iniciar(matriz_t *m, PIO pio, uint sm);
+// Quadro saindo pela PIO (ou no reset): o divisor da PIO não pode mudar
+bool matriz_hw_ocupada(void);
+
+#endif
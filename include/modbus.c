@@ -0,0 +1,180 @@
+#include "modbus.h"
+#include "crc.h"
+#include <string.h>
+
+void modbus_init(modbus_t *m, uint8_t endereco, uint32_t baudrate, modbus_mapa_t mapa, modbus_transporte_t transporte) {
+    memset(m, 0, sizeof(*m));
+    m->endereco = endereco;
+    m->mapa = mapa;
+    m->transporte = transporte;
+    // 3,5 caracteres de 11 bits; acima de 19200 baud a norma fixa 1750 µs
+    m->t35_us = baudrate > 19200 ? 1750u : (uint32_t)(3.5f * 11.0f * 1000000.0f / (float)baudrate);
+}
+
+void modbus_receber_byte(modbus_t *m, uint8_t byte, uint32_t agora_us) {
+    uint16_t valor = byte;
+    if (agora_us - m->ultimo_byte_us >= m->t35_us)
+        valor |= MODBUS_INICIO_QUADRO;
+    m->ultimo_byte_us = agora_us;
+    uint32_t c = m->cabeca;
+    if (c - m->cauda >= MODBUS_ANEL_TAMANHO) {
+        m->transbordos++;
+        return;
+    }
+    m->anel[c & (MODBUS_ANEL_TAMANHO - 1)] = valor;
+    // IRQ e laço principal rodam no mesmo núcleo: basta impedir que o
+    // compilador publique a cabeça antes do byte
+    __atomic_signal_fence(__ATOMIC_SEQ_CST);
+    m->cabeca = c + 1;
+}
+
+bool modbus_pendente(const modbus_t *m) {
+    return m->cabeca != m->cauda || m->quadro_len > 0;
+}
+
+static uint16_t ler_u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+static void escrever_u16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)(v >> 8);
+    p[1] = (uint8_t)v;
+}
+
+static size_t fechar_resposta(uint8_t *r, size_t len) {
+    uint16_t crc = crc16_modbus(r, len);
+    r[len] = (uint8_t)crc;          // CRC sai com o byte baixo primeiro
+    r[len + 1] = (uint8_t)(crc >> 8);
+    return len + 2;
+}
+
+static size_t excecao(modbus_t *m, uint8_t funcao, uint8_t codigo) {
+    m->excecoes++;
+    m->resposta[0] = m->endereco;
+    m->resposta[1] = funcao | 0x80;
+    m->resposta[2] = codigo;
+    return fechar_resposta(m->resposta, 3);
+}
+
+static size_t ler_registros(modbus_t *m, const uint8_t *q, uint16_t len) {
+    uint8_t funcao = q[1];
+    if (len != 6)
+        return excecao(m, funcao, MODBUS_EXC_VALOR);
+    uint16_t inicio = ler_u16(&q[2]);
+    uint16_t qtd = ler_u16(&q[4]);
+    if (qtd == 0 || qtd > 125)
+        return excecao(m, funcao, MODBUS_EXC_VALOR);
+    bool (*ler)(void *, uint16_t, uint16_t *) =
+        funcao == MODBUS_FC_LER_ENTRADA ? m->mapa.ler_entrada : m->mapa.ler_retencao;
+    uint8_t *r = m->resposta;
+    for (uint16_t i = 0; i < qtd; i++) {
+        uint16_t valor;
+        if (!ler(m->mapa.ctx, (uint16_t)(inicio + i), &valor))
+            return excecao(m, funcao, MODBUS_EXC_ENDERECO);
+        escrever_u16(&r[3 + 2 * i], valor);
+    }
+    r[0] = m->endereco;
+    r[1] = funcao;
+    r[2] = (uint8_t)(2 * qtd);
+    return fechar_resposta(r, 3 + 2u * qtd);
+}
+
+// Valida todos os registradores antes de aplicar qualquer um
+static uint8_t escrever_registros(modbus_t *m, uint16_t inicio, uint16_t qtd, const uint8_t *valores) {
+    for (int aplicar = 0; aplicar <= 1; aplicar++) {
+        for (uint16_t i = 0; i < qtd; i++) {
+            uint8_t exc = m->mapa.escrever_retencao(m->mapa.ctx, (uint16_t)(inicio + i),
+                                                    ler_u16(&valores[2 * i]), aplicar);
+            if (exc)
+                return exc;
+        }
+    }
+    return 0;
+}
+
+// Atende um quadro já sem o CRC; retorna o tamanho da resposta (0 = sem resposta)
+static size_t atender(modbus_t *m, const uint8_t *q, uint16_t len, bool difusao) {
+    uint8_t funcao = q[1];
+    uint8_t exc;
+    switch (funcao) {
+    case MODBUS_FC_LER_RETENCAO:
+    case MODBUS_FC_LER_ENTRADA:
+        return difusao ? 0 : ler_registros(m, q, len);
+
+    case MODBUS_FC_ESCREVER_UM:
+        if (len != 6)
+            return difusao ? 0 : excecao(m, funcao, MODBUS_EXC_VALOR);
+        exc = escrever_registros(m, ler_u16(&q[2]), 1, &q[4]);
+        if (difusao)
+            return 0;
+        if (exc)
+            return excecao(m, funcao, exc);
+        memcpy(m->resposta, q, 6);   // Eco da requisição
+        return fechar_resposta(m->resposta, 6);
+
+    case MODBUS_FC_ESCREVER_VARIOS: {
+        if (len < 7)
+            return difusao ? 0 : excecao(m, funcao, MODBUS_EXC_VALOR);
+        uint16_t qtd = ler_u16(&q[4]);
+        if (qtd == 0 || qtd > 123 || q[6] != 2 * qtd || len != 7 + 2u * qtd)
+            return difusao ? 0 : excecao(m, funcao, MODBUS_EXC_VALOR);
+        exc = escrever_registros(m, ler_u16(&q[2]), qtd, &q[7]);
+        if (difusao)
+            return 0;
+        if (exc)
+            return excecao(m, funcao, exc);
+        memcpy(m->resposta, q, 6);   // Endereço, função, início e quantidade
+        return fechar_resposta(m->resposta, 6);
+    }
+
+    default:
+        return difusao ? 0 : excecao(m, funcao, MODBUS_EXC_FUNCAO);
+    }
+}
+
+bool modbus_processar(modbus_t *m, uint32_t agora_us) {
+    // Drena o anel; um novo início descarta um quadro antigo não atendido
+    // (o mestre já desistiu dele), e quadros longos demais são invalidados
+    while (m->cauda != m->cabeca) {
+        uint32_t t = m->cauda;
+        __atomic_signal_fence(__ATOMIC_SEQ_CST);
+        uint16_t valor = m->anel[t & (MODBUS_ANEL_TAMANHO - 1)];
+        m->cauda = t + 1;
+        if (valor & MODBUS_INICIO_QUADRO) {
+            m->quadro_len = 0;
+            m->quadro_invalido = false;
+        }
+        if (m->quadro_len < MODBUS_QUADRO_MAX)
+            m->quadro[m->quadro_len++] = (uint8_t)valor;
+        else
+            m->quadro_invalido = true;
+    }
+
+    if (m->quadro_len == 0 || agora_us - m->ultimo_byte_us < m->t35_us)
+        return false;
+    if (m->transporte.transmitindo(m->transporte.ctx))
+        return false;
+
+    const uint8_t *q = m->quadro;
+    uint16_t len = m->quadro_len;
+    m->quadro_len = 0;
+    if (m->quadro_invalido || len < 4)
+        return false;
+    if (q[0] != m->endereco && q[0] != 0)
+        return false;   // Quadro de outro escravo
+    uint16_t crc = (uint16_t)(q[len - 2] | (q[len - 1] << 8));
+    if (crc16_modbus(q, len - 2u) != crc) {
+        m->erros_crc++;
+        return false;
+    }
+
+    m->quadros++;
+    size_t n = atender(m, q, (uint16_t)(len - 2u), q[0] == 0);
+    if (n > 0) {
+        m->transporte.enviar(m->transporte.ctx, m->resposta, n);
+        uint32_t atendimento = agora_us - m->ultimo_byte_us;
+        if (atendimento > m->maior_atendimento_us)
+            m->maior_atendimento_us = atendimento;
+    }
+    return true;
+}
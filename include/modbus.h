@@ -0,0 +1,81 @@
+#ifndef MODBUS_H
+#define MODBUS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+//===============================================
+// Escravo Modbus RTU
+//
+// A IRQ de recepção só grava bytes num anel (um produtor, um consumidor)
+// e marca o início de quadro quando o silêncio desde o byte anterior
+// passa de 3,5 caracteres. O laço principal separa os quadros, confere o
+// CRC, atende as funções 03, 04, 06 e 16 e entrega a resposta ao
+// transporte (DMA no RP2040), sem bloquear durante a transmissão.
+// O acesso aos registradores e à UART fica atrás de tabelas de funções,
+// então o núcleo não depende do SDK e também compila em Linux.
+//===============================================
+#define MODBUS_ANEL_TAMANHO 512   // Potência de 2
+#define MODBUS_QUADRO_MAX 256
+#define MODBUS_INICIO_QUADRO 0x100   // Marca no anel: byte abre um quadro
+
+#define MODBUS_FC_LER_RETENCAO 0x03
+#define MODBUS_FC_LER_ENTRADA 0x04
+#define MODBUS_FC_ESCREVER_UM 0x06
+#define MODBUS_FC_ESCREVER_VARIOS 0x10
+
+#define MODBUS_EXC_FUNCAO 0x01
+#define MODBUS_EXC_ENDERECO 0x02
+#define MODBUS_EXC_VALOR 0x03
+
+typedef struct {
+    // Retornam false se o registrador não existe
+    bool (*ler_entrada)(void *ctx, uint16_t reg, uint16_t *valor);
+    bool (*ler_retencao)(void *ctx, uint16_t reg, uint16_t *valor);
+    // Retorna 0 ou um código de exceção. Com aplicar = false apenas valida,
+    // o que torna a escrita múltipla tudo-ou-nada.
+    uint8_t (*escrever_retencao)(void *ctx, uint16_t reg, uint16_t valor, bool aplicar);
+    void *ctx;
+} modbus_mapa_t;
+
+typedef struct {
+    void (*enviar)(void *ctx, const uint8_t *dados, size_t len);
+    bool (*transmitindo)(void *ctx);   // Até o último bit da resposta sair no fio
+    void *ctx;
+} modbus_transporte_t;
+
+typedef struct {
+    uint8_t endereco;
+    uint32_t t35_us;   // Silêncio que separa quadros
+    modbus_mapa_t mapa;
+    modbus_transporte_t transporte;
+
+    // Anel alimentado pela IRQ de recepção
+    uint16_t anel[MODBUS_ANEL_TAMANHO];
+    volatile uint32_t cabeca;           // Escrito só pela IRQ
+    volatile uint32_t cauda;            // Escrito só pelo laço principal
+    volatile uint32_t ultimo_byte_us;   // Instante do último byte (32 bits: leitura atômica)
+    volatile uint32_t transbordos;
+
+    // Quadro em montagem e resposta (lida pelo DMA durante o envio)
+    uint8_t quadro[MODBUS_QUADRO_MAX];
+    uint16_t quadro_len;
+    bool quadro_invalido;
+    uint8_t resposta[MODBUS_QUADRO_MAX];
+
+    uint32_t quadros;
+    uint32_t erros_crc;
+    uint32_t excecoes;
+    uint32_t maior_atendimento_us;   // Do fim do quadro ao início da resposta
+} modbus_t;
+
+void modbus_init(modbus_t *m, uint8_t endereco, uint32_t baudrate, modbus_mapa_t mapa, modbus_transporte_t transporte);
+// Chamado pela IRQ de recepção para cada byte
+void modbus_receber_byte(modbus_t *m, uint8_t byte, uint32_t agora_us);
+// Há bytes no anel ou um quadro aguardando o silêncio final
+bool modbus_pendente(const modbus_t *m);
+// Atende no máximo um quadro completo; retorna true se respondeu ou executou
+bool modbus_processar(modbus_t *m, uint32_t agora_us);
+
+#endif
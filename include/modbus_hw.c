@@ -0,0 +1,101 @@
+#include "modbus_hw.h"
+#include "pilha.h"
+#include "hardware/dma.h"
+#include "hardware/gpio.h"
+#include "hardware/irq.h"
+#include "hardware/timer.h"
+
+#define MODBUS_PARIDADE UART_PARITY_EVEN   // 8E1, padrão da norma para RTU
+
+#define UART_FIFO_TAMANHO 32
+#define UART_TEMPO_LIMITE_BITS 32   // Silêncio que dispara a IRQ de tempo limite da FIFO
+
+static modbus_t *instancia;
+static uart_inst_t *uart_modbus;
+static uint32_t baud_modbus;
+static uint32_t caractere_us;     // 11 bits por caractere (8E1)
+static uint32_t tempo_limite_us;
+static int canal_dma = -1;
+
+// Com a FIFO ligada os bytes chegam em lotes (4 bytes ou tempo limite).
+// Cada byte recebe o instante estimado de chegada, recuando um caractere
+// por byte que veio depois dele, para que o intervalo entre lotes não
+// pareça o silêncio de fim de quadro. O recuo nunca passa do byte anterior.
+static void uart_irq(void) {
+    uint32_t *sp = pilha_irq_entrar();
+    uint32_t agora = time_us_32();
+    if (uart_get_hw(uart_modbus)->mis & UART_UARTMIS_RTMIS_BITS)
+        agora -= tempo_limite_us;
+    uint8_t lote[UART_FIFO_TAMANHO];
+    uint32_t n = 0;
+    while (n < UART_FIFO_TAMANHO && uart_is_readable(uart_modbus))
+        lote[n++] = (uint8_t)uart_getc(uart_modbus);
+    for (uint32_t i = 0; i < n; i++) {
+        uint32_t recuo = (n - 1 - i) * caractere_us;
+        uint32_t desde_anterior = agora - instancia->ultimo_byte_us;
+        if (recuo > desde_anterior)
+            recuo = desde_anterior;
+        modbus_receber_byte(instancia, lote[i], agora - recuo);
+    }
+    pilha_irq_sair(sp);
+}
+
+static void enviar_dma(void *ctx, const uint8_t *dados, size_t len) {
+    dma_channel_transfer_from_buffer_now((uint)canal_dma, dados, (uint32_t)len);
+}
+
+// O DMA termina quando o último byte entra na FIFO de TX, até 32
+// caracteres antes de sair no fio: a resposta só acaba com a UART ociosa
+// (BUSY cobre a FIFO e o registrador de deslocamento, até o stop bit)
+static bool transmitindo_dma(void *ctx) {
+    return dma_channel_is_busy((uint)canal_dma) || (uart_get_hw(uart_modbus)->fr & UART_UARTFR_BUSY_BITS);
+}
+
+void modbus_hw_iniciar(modbus_t *m, uart_inst_t *uart, uint32_t baudrate, uint pino_tx, uint pino_rx,
+                       uint8_t endereco, modbus_mapa_t mapa) {
+    instancia = m;
+    uart_modbus = uart;
+    baud_modbus = baudrate;
+    caractere_us = 11000000u / baudrate;
+    tempo_limite_us = UART_TEMPO_LIMITE_BITS * 1000000u / baudrate;
+
+    canal_dma = dma_claim_unused_channel(true);
+    dma_channel_config c = dma_channel_get_default_config((uint)canal_dma);
+    channel_config_set_transfer_data_size(&c, DMA_SIZE_8);
+    channel_config_set_read_increment(&c, true);
+    channel_config_set_write_increment(&c, false);
+    channel_config_set_dreq(&c, uart_get_dreq(uart, true));
+    dma_channel_configure((uint)canal_dma, &c, &uart_get_hw(uart)->dr, NULL, 0, false);
+
+    modbus_transporte_t transporte = {
+        .enviar = enviar_dma,
+        .transmitindo = transmitindo_dma,
+        .ctx = NULL,
+    };
+    modbus_init(m, endereco, baudrate, mapa, transporte);
+
+    uart_init(uart, baudrate);
+    uart_set_format(uart, 8, 1, MODBUS_PARIDADE);
+    uart_set_hw_flow(uart, false, false);
+    // A FIFO de 32 bytes segura a recepção enquanto a flash do histórico
+    // é gravada com as interrupções desligadas (ver historico_hw.h)
+    uart_set_fifo_enabled(uart, true);
+    gpio_set_function(pino_tx, GPIO_FUNC_UART);
+    gpio_set_function(pino_rx, GPIO_FUNC_UART);
+
+    uint irq = uart == uart0 ? UART0_IRQ : UART1_IRQ;
+    irq_set_exclusive_handler(irq, uart_irq);
+    irq_set_enabled(irq, true);
+    uart_set_irq_enables(uart, true, false);
+}
+
+void modbus_hw_ajustar_baud(void) {
+    if (uart_modbus)
+        uart_set_baudrate(uart_modbus, baud_modbus);
+}
+
+bool modbus_hw_ocioso(void) {
+    if (!uart_modbus)
+        return true;
+    return !modbus_pendente(instancia) && !uart_is_readable(uart_modbus) && !transmitindo_dma(NULL);
+}
@@ -0,0 +1,18 @@
+#ifndef MODBUS_HW_H
+#define MODBUS_HW_H
+
+#include "modbus.h"
+#include "hardware/uart.h"
+
+// Transporte do escravo Modbus numa UART do RP2040: recepção por IRQ
+// (FIFO ligada, carimbo de tempo estimado por byte) e resposta por DMA.
+// Há uma única instância, pois a IRQ precisa de um ponteiro global.
+void modbus_hw_iniciar(modbus_t *m, uart_inst_t *uart, uint32_t baudrate, uint pino_tx, uint pino_rx,
+                       uint8_t endereco, modbus_mapa_t mapa);
+// Refaz o divisor de baud depois de uma troca do clk_peri
+void modbus_hw_ajustar_baud(void);
+// Nada chegando (anel, quadro ou FIFO da UART) nem saindo: o baud pode
+// ser refeito sem corromper bytes
+bool modbus_hw_ocioso(void);
+
+#endif
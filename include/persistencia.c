@@ -0,0 +1,49 @@
+#include "persistencia.h"
+#include "crc.h"
+#include "pico.h"
+
+#define PERSISTENCIA_MAGICA 0x46524C54u   // "FRLT"
+
+typedef struct {
+    uint32_t magica;
+    uint32_t tamanho;
+    uint32_t sequencia;
+    estado_persistente_t estado;
+    uint32_t crc;
+} registro_persistente_t;
+
+static registro_persistente_t __uninitialized_ram(slots)[2];
+static uint32_t sequencia_atual = 0;
+
+static bool slot_valido(const registro_persistente_t *r) {
+    return r->magica == PERSISTENCIA_MAGICA &&
+           r->tamanho == sizeof(estado_persistente_t) &&
+           r->crc == crc32(r, offsetof(registro_persistente_t, crc));
+}
+
+bool persistencia_restaurar(estado_persistente_t *destino) {
+    bool v0 = slot_valido(&slots[0]);
+    bool v1 = slot_valido(&slots[1]);
+    const registro_persistente_t *r;
+    if (v0 && v1)
+        r = ((int32_t)(slots[1].sequencia - slots[0].sequencia) > 0) ? &slots[1] : &slots[0];
+    else if (v0)
+        r = &slots[0];
+    else if (v1)
+        r = &slots[1];
+    else
+        return false;
+    *destino = r->estado;
+    sequencia_atual = r->sequencia;
+    return true;
+}
+
+void persistencia_salvar(const estado_persistente_t *origem) {
+    sequencia_atual++;
+    registro_persistente_t *r = &slots[sequencia_atual & 1];
+    r->magica = PERSISTENCIA_MAGICA;
+    r->tamanho = sizeof(estado_persistente_t);
+    r->sequencia = sequencia_atual;
+    r->estado = *origem;
+    r->crc = crc32(r, offsetof(registro_persistente_t, crc));
+}
@@ -0,0 +1,30 @@
+#ifndef PERSISTENCIA_H
+#define PERSISTENCIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "config.h"
+#include "calibracao.h"
+#include "excursoes.h"
+
+//===============================================
+// Estado de execução preservado entre reinícios a quente
+//
+// Fica na seção .uninitialized_data, que o crt0 não zera, em dois slots
+// alternados com número de sequência e CRC-32. Um reset no meio de uma
+// gravação corrompe só o slot em escrita; o outro continua válido.
+// Após power-on o conteúdo é lixo e o CRC o rejeita.
+//===============================================
+typedef struct {
+    uint32_t reinicios;
+    zona_estatisticas_t estatisticas;
+    excursoes_t excursoes;
+    uint64_t tempo_viagem_us;
+    config_t config;
+    cal_tabela_t calibracao[CAL_NUM_CANAIS];
+} estado_persistente_t;
+
+bool persistencia_restaurar(estado_persistente_t *destino);
+void persistencia_salvar(const estado_persistente_t *origem);
+
+#endif
@@ -0,0 +1,42 @@
+#include "pilha.h"
+
+// Símbolos do linker script do SDK (memmap_*.ld)
+extern uint32_t __StackOneBottom[], __StackOneTop[];
+
+volatile uint32_t pilha_irq_pico;
+volatile uint32_t pilha_pico_nucleo0;
+volatile uint32_t pilha_irq_contador;
+
+static void pintar(uint32_t *de, uint32_t *ate) {
+    for (uint32_t *p = de; p < ate; p++)
+        *p = PILHA_PADRAO;
+}
+
+// Varre da base para o topo até a primeira palavra alterada
+static uint32_t pico_uso(const uint32_t *base, const uint32_t *topo) {
+    const uint32_t *p = base;
+    while (p < topo && *p == PILHA_PADRAO)
+        p++;
+    return (uint32_t)((uintptr_t)topo - (uintptr_t)p);
+}
+
+void pilha_pintar(void) {
+    // Núcleo 0: só abaixo do SP atual (com margem para esta própria função)
+    uint32_t *sp = (uint32_t *)__builtin_frame_address(0);
+    uint32_t *limite = sp - PILHA_MARGEM / sizeof(uint32_t);
+    if (limite > __StackBottom)
+        pintar(__StackBottom, limite);
+    // Núcleo 1 ainda não foi lançado: pilha inteira
+    pintar(__StackOneBottom, __StackOneTop);
+}
+
+void pilha_medir(pilha_uso_t *uso) {
+    uso->tamanho[0] = (uint32_t)((uintptr_t)__StackTop - (uintptr_t)__StackBottom);
+    uso->tamanho[1] = (uint32_t)((uintptr_t)__StackOneTop - (uintptr_t)__StackOneBottom);
+    // A varredura não enxerga o que as janelas de IRQ repintaram
+    uso->pico[0] = pico_uso(__StackBottom, __StackTop);
+    if (pilha_pico_nucleo0 > uso->pico[0])
+        uso->pico[0] = pilha_pico_nucleo0;
+    uso->pico[1] = pico_uso(__StackOneBottom, __StackOneTop);
+    uso->irq = pilha_irq_pico;
+}
@@ -0,0 +1,75 @@
+#ifndef PILHA_H
+#define PILHA_H
+
+#include <stdint.h>
+
+//===============================================
+// Marcas d'água das pilhas
+//
+// As pilhas dos dois núcleos (SCRATCH_Y e SCRATCH_X no linker script do
+// SDK) são pintadas com um padrão no boot; o pico de uso é a distância
+// entre o topo e a primeira palavra ainda pintada a partir da base.
+// No RP2040 as IRQs não têm pilha própria: usam a do núcleo que as
+// atende (MSP). Para separar o quanto cada rotina de interrupção consome,
+// uma janela abaixo do SP é pintada na entrada e varrida na saída.
+// Repintar a janela apagaria o pico do laço principal que caiu dentro
+// dela, então antes ela é varrida e esse uso entra em pilha_pico_nucleo0.
+// Varrer e pintar 512 bytes custa mais que o próprio amostrador de botões,
+// então só uma IRQ em cada PILHA_AMOSTRA_IRQ mede (o contador é comum às
+// três rotinas); nas demais a entrada é um incremento e um teste.
+//===============================================
+#define PILHA_PADRAO 0xC5C5C5C5u
+#define PILHA_MARGEM 64          // Bytes abaixo do SP que pilha_pintar não toca
+#define PILHA_JANELA_IRQ 512     // Bytes pintados abaixo do SP na entrada de uma IRQ
+#define PILHA_AMOSTRA_IRQ 64     // Uma IRQ em cada 64 mede a pilha (potência de 2)
+
+typedef struct {
+    uint32_t tamanho[2];   // Bytes reservados por núcleo
+    uint32_t pico[2];      // Maior uso observado (inclui as IRQs atendidas)
+    uint32_t irq;          // Maior uso de uma rotina de interrupção
+} pilha_uso_t;
+
+extern uint32_t __StackBottom[], __StackTop[];   // Pilha do núcleo 0 (linker script)
+extern volatile uint32_t pilha_irq_pico;
+extern volatile uint32_t pilha_pico_nucleo0;     // Uso encontrado nas janelas antes de repintar
+extern volatile uint32_t pilha_irq_contador;
+
+// Chamada no início de main(), antes de qualquer outra coisa usar a pilha
+void pilha_pintar(void);
+void pilha_medir(pilha_uso_t *uso);
+
+// Início e fim de uma rotina de interrupção do núcleo 0; NULL quando esta
+// IRQ não é amostrada
+static inline uint32_t *pilha_irq_entrar(void) {
+    if ((++pilha_irq_contador & (PILHA_AMOSTRA_IRQ - 1)) != 0)
+        return 0;
+    uint32_t *sp = (uint32_t *)__builtin_frame_address(0);
+    uint32_t *p = sp - PILHA_JANELA_IRQ / sizeof(uint32_t);
+    if (p < __StackBottom)
+        p = __StackBottom;
+    // Preserva a marca d'água do núcleo 0 que está dentro da janela
+    uint32_t *q = p;
+    while (q < sp && *q == PILHA_PADRAO)
+        q++;
+    uint32_t uso = (uint32_t)((uintptr_t)__StackTop - (uintptr_t)q);
+    if (uso > pilha_pico_nucleo0)
+        pilha_pico_nucleo0 = uso;
+    for (; p < sp; p++)
+        *p = PILHA_PADRAO;
+    return sp;
+}
+
+static inline void pilha_irq_sair(uint32_t *sp) {
+    if (!sp)
+        return;
+    uint32_t *p = sp - PILHA_JANELA_IRQ / sizeof(uint32_t);
+    if (p < __StackBottom)
+        p = __StackBottom;
+    while (p < sp && *p == PILHA_PADRAO)
+        p++;
+    uint32_t uso = (uint32_t)((uintptr_t)sp - (uintptr_t)p);
+    if (uso > pilha_irq_pico)
+        pilha_irq_pico = uso;
+}
+
+#endif
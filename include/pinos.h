@@ -0,0 +1,39 @@
+#ifndef PINOS_H
+#define PINOS_H
+
+#include "recursos.h"
+
+//===============================================
+// Pinos com PWM ou PIO e a alocação conferida por recursos_verificar
+//
+// Os LEDs ficam com o PWM (wrap CONTROLE_PWM_MAX, divisor 1) e os
+// buzzers passivos com a PIO1 (tom.pio): o GPIO 10 divide o slice 5 com
+// o LED verde, e um tom no PWM trocava o wrap do LED. O WS2812 usa a PIO0.
+//===============================================
+#define R_LED_PIN 13   // Também usado para indicar o "motor" em modos de Temperatura e Umidade
+#define G_LED_PIN 11
+#define B_LED_PIN 12
+
+#define BUZZER1_PIN 10  // Startup
+#define BUZZER2_PIN 21  // Alertas
+enum { BUZZER_INICIO = 0, BUZZER_ALERTA, NUM_BUZZERS };   // Índice = máquina de estados na TOM_PIO_BLOCO
+
+#define WS2812_PIN 7
+
+#define WS2812_PIO_BLOCO 0
+#define WS2812_SM 0
+#define TOM_PIO_BLOCO 1
+
+#define PERFIL_PWM_LED 0
+
+static const recurso_pedido_t ALOCACAO_RECURSOS[] = {
+    {"LED vermelho", RECURSO_PWM, R_LED_PIN, 0, 0, PERFIL_PWM_LED},
+    {"LED verde", RECURSO_PWM, G_LED_PIN, 0, 0, PERFIL_PWM_LED},
+    {"LED azul", RECURSO_PWM, B_LED_PIN, 0, 0, PERFIL_PWM_LED},
+    {"buzzer 1", RECURSO_PIO, BUZZER1_PIN, TOM_PIO_BLOCO, BUZZER_INICIO, 0},
+    {"buzzer 2", RECURSO_PIO, BUZZER2_PIN, TOM_PIO_BLOCO, BUZZER_ALERTA, 0},
+    {"WS2812", RECURSO_PIO, WS2812_PIN, WS2812_PIO_BLOCO, WS2812_SM, 0},
+};
+#define NUM_ALOCACOES (sizeof(ALOCACAO_RECURSOS) / sizeof(ALOCACAO_RECURSOS[0]))
+
+#endif
@@ -0,0 +1,214 @@
+#include "raster.h"
+#include "secoes.h"
+#include <string.h>
+
+#define TROCAR(a, b) do { int t_ = (a); (a) = (b); (b) = t_; } while (0)
+
+// Pixel já dentro da tela
+static inline void escrever(const raster_t *r, int x, int y, bool valor) {
+    uint8_t *byte = &r->quadro[x * r->paginas + (y >> 3)];
+    uint8_t bit = (uint8_t)(1u << (y & 7));
+    if (valor)
+        *byte |= bit;
+    else
+        *byte &= (uint8_t)~bit;
+}
+
+// Aplica 'bits' nas posições de 'mascara' de um byte de página
+static inline void mesclar(uint8_t *byte, uint8_t mascara, uint8_t bits) {
+    *byte = (uint8_t)((*byte & ~mascara) | (bits & mascara));
+}
+
+void FUNCAO_RAPIDA(raster_pixel)(const raster_t *r, int x, int y, bool valor) {
+    if ((unsigned)x < (unsigned)r->largura && (unsigned)y < (unsigned)r->altura)
+        escrever(r, x, y, valor);
+}
+
+void FUNCAO_RAPIDA(raster_preencher)(const raster_t *r, bool valor) {
+    memset(r->quadro, valor ? 0xFF : 0x00, (size_t)(r->largura * r->paginas));
+}
+
+void raster_hspan(const raster_t *r, int x0, int x1, int y, bool valor) {
+    if (x0 > x1)
+        TROCAR(x0, x1);
+    if ((unsigned)y >= (unsigned)r->altura || x1 < 0 || x0 >= r->largura)
+        return;
+    if (x0 < 0)
+        x0 = 0;
+    if (x1 >= r->largura)
+        x1 = r->largura - 1;
+    // Mesmo bit da mesma página em colunas consecutivas
+    uint8_t *byte = &r->quadro[x0 * r->paginas + (y >> 3)];
+    uint8_t bit = (uint8_t)(1u << (y & 7));
+    for (int x = x0; x <= x1; x++, byte += r->paginas) {
+        if (valor)
+            *byte |= bit;
+        else
+            *byte &= (uint8_t)~bit;
+    }
+}
+
+void raster_vspan(const raster_t *r, int x, int y0, int y1, bool valor) {
+    if (y0 > y1)
+        TROCAR(y0, y1);
+    if ((unsigned)x >= (unsigned)r->largura || y1 < 0 || y0 >= r->altura)
+        return;
+    if (y0 < 0)
+        y0 = 0;
+    if (y1 >= r->altura)
+        y1 = r->altura - 1;
+    // Páginas contíguas na coluna: bordas mascaradas e miolo byte a byte
+    uint8_t *coluna = &r->quadro[x * r->paginas];
+    uint8_t cheio = valor ? 0xFF : 0x00;
+    int p0 = y0 >> 3, p1 = y1 >> 3;
+    uint8_t m0 = (uint8_t)(0xFFu << (y0 & 7));
+    uint8_t m1 = (uint8_t)(0xFFu >> (7 - (y1 & 7)));
+    if (p0 == p1) {
+        mesclar(&coluna[p0], m0 & m1, cheio);
+        return;
+    }
+    mesclar(&coluna[p0], m0, cheio);
+    for (int p = p0 + 1; p < p1; p++)
+        coluna[p] = cheio;
+    mesclar(&coluna[p1], m1, cheio);
+}
+
+void raster_retangulo(const raster_t *r, int x, int y, int largura, int altura, bool valor, bool preencher) {
+    if (largura <= 0 || altura <= 0)
+        return;
+    int x1 = x + largura - 1, y1 = y + altura - 1;
+    if (preencher) {
+        // Recorta as colunas uma vez; cada uma é um trecho vertical
+        int inicio = x < 0 ? 0 : x;
+        int fim = x1 >= r->largura ? r->largura - 1 : x1;
+        for (int c = inicio; c <= fim; c++)
+            raster_vspan(r, c, y, y1, valor);
+        return;
+    }
+    raster_hspan(r, x, x1, y, valor);
+    raster_hspan(r, x, x1, y1, valor);
+    raster_vspan(r, x, y, y1, valor);
+    raster_vspan(r, x1, y, y1, valor);
+}
+
+//===============================================
+// Cohen–Sutherland: recorta o segmento à tela antes do Bresenham
+//===============================================
+enum { DENTRO = 0, ESQUERDA = 1, DIREITA = 2, ABAIXO = 4, ACIMA = 8 };
+
+static int regiao(const raster_t *r, int x, int y) {
+    int codigo = DENTRO;
+    if (x < 0)
+        codigo |= ESQUERDA;
+    else if (x >= r->largura)
+        codigo |= DIREITA;
+    if (y < 0)
+        codigo |= ACIMA;
+    else if (y >= r->altura)
+        codigo |= ABAIXO;
+    return codigo;
+}
+
+// Divisão arredondada ao inteiro mais próximo: a extremidade recortada
+// fica a no máximo meio pixel da reta original
+static int64_t dividir_arredondado(int64_t n, int64_t d) {
+    if (d < 0)
+        n = -n, d = -d;
+    return n >= 0 ? (n + d / 2) / d : -((-n + d / 2) / d);
+}
+
+static bool recortar(const raster_t *r, int *x0, int *y0, int *x1, int *y1) {
+    int c0 = regiao(r, *x0, *y0), c1 = regiao(r, *x1, *y1);
+    // As interseções são sempre calculadas sobre o segmento original, para
+    // os arredondamentos não se acumularem entre os passos
+    const int ox = *x0, oy = *y0;
+    const int64_t dx = (int64_t)*x1 - *x0, dy = (int64_t)*y1 - *y0;
+    // Cada passo leva uma extremidade a uma borda; o limite evita laço com
+    // arredondamentos patológicos (o segmento é descartado)
+    for (int passo = 0; passo < 8; passo++) {
+        if (!(c0 | c1))
+            return true;
+        if (c0 & c1)
+            return false;
+        int fora = c0 ? c0 : c1;
+        int x, y;
+        if (fora & ACIMA) {
+            y = 0;
+            x = (int)(ox + dividir_arredondado(dx * (0 - oy), dy));
+        } else if (fora & ABAIXO) {
+            y = r->altura - 1;
+            x = (int)(ox + dividir_arredondado(dx * (r->altura - 1 - oy), dy));
+        } else if (fora & ESQUERDA) {
+            x = 0;
+            y = (int)(oy + dividir_arredondado(dy * (0 - ox), dx));
+        } else {
+            x = r->largura - 1;
+            y = (int)(oy + dividir_arredondado(dy * (r->largura - 1 - ox), dx));
+        }
+        if (fora == c0) {
+            *x0 = x, *y0 = y;
+            c0 = regiao(r, x, y);
+        } else {
+            *x1 = x, *y1 = y;
+            c1 = regiao(r, x, y);
+        }
+    }
+    return false;
+}
+
+void raster_linha(const raster_t *r, int x0, int y0, int x1, int y1, bool valor) {
+    if (y0 == y1) {
+        raster_hspan(r, x0, x1, y0, valor);
+        return;
+    }
+    if (x0 == x1) {
+        raster_vspan(r, x0, y0, y1, valor);
+        return;
+    }
+    if (!recortar(r, &x0, &y0, &x1, &y1))
+        return;
+
+    int dx = x1 > x0 ? x1 - x0 : x0 - x1;
+    int dy = y1 > y0 ? y1 - y0 : y0 - y1;
+    int sx = x0 < x1 ? 1 : -1;
+    int sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    for (;;) {
+        escrever(r, x0, y0, valor);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = err * 2;
+        if (e2 > -dy) {
+            err -= dy;
+            x0 += sx;
+        }
+        if (e2 < dx) {
+            err += dx;
+            y0 += sy;
+        }
+    }
+}
+
+//===============================================
+// Glifos: recorte por colunas e, na vertical, por deslocamento de páginas
+//===============================================
+void FUNCAO_RAPIDA(raster_glifo)(const raster_t *r, const uint8_t glifo[8], int x, int y) {
+    if (x <= -8 || x >= r->largura || y <= -8 || y >= r->altura)
+        return;
+    int inicio = x < 0 ? -x : 0;
+    int fim = x + 8 > r->largura ? r->largura - x : 8;
+    // A coluna de 8 linhas cai em até duas páginas: p (parte de cima) e p + 1
+    int p = y >> 3;          // Deslocamento aritmético: y negativo dá p = -1
+    int desloc = y & 7;
+    bool usa_p = p >= 0;
+    bool usa_p1 = desloc != 0 && p + 1 < r->paginas;
+    uint8_t m0 = (uint8_t)(0xFFu << desloc);
+    uint8_t m1 = (uint8_t)(0xFFu >> (8 - desloc));
+    for (int i = inicio; i < fim; i++) {
+        uint8_t *coluna = &r->quadro[(x + i) * r->paginas];
+        if (usa_p)
+            mesclar(&coluna[p], m0, (uint8_t)(glifo[i] << desloc));
+        if (usa_p1)
+            mesclar(&coluna[p + 1], m1, (uint8_t)(glifo[i] >> (8 - desloc)));
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef RASTER_H
+#define RASTER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Camada de rasterização com recorte para o quadro do SSD1306
+//
+// O quadro é organizado como no modo de endereçamento vertical do
+// controlador: coluna a coluna, um byte por página de 8 linhas (bit 0 =
+// linha de cima). Cada primitiva é recortada uma única vez, no nível do
+// segmento ou do trecho (Cohen–Sutherland para linhas, intervalos para
+// retângulos e glifos), e depois escreve sem verificar cada pixel. As
+// coordenadas são int: valores negativos ou além da tela são recortados,
+// nunca escritos fora do quadro. Não depende do SDK.
+//===============================================
+typedef struct {
+    uint8_t *quadro;   // largura * paginas bytes
+    int largura;
+    int altura;        // Múltiplo de 8
+    int paginas;
+} raster_t;
+
+void raster_pixel(const raster_t *r, int x, int y, bool valor);
+void raster_preencher(const raster_t *r, bool valor);
+// Trechos com extremidades inclusivas, em qualquer ordem
+void raster_hspan(const raster_t *r, int x0, int x1, int y, bool valor);
+void raster_vspan(const raster_t *r, int x, int y0, int y1, bool valor);
+void raster_retangulo(const raster_t *r, int x, int y, int largura, int altura, bool valor, bool preencher);
+void raster_linha(const raster_t *r, int x0, int y0, int x1, int y1, bool valor);
+// Glifo 8x8 opaco: glifo[i] é a coluna i, bit j = linha j
+void raster_glifo(const raster_t *r, const uint8_t glifo[8], int x, int y);
+
+#endif
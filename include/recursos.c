@@ -0,0 +1,65 @@
+#include "recursos.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+static const char *const NOMES[] = {
+    [CONFLITO_GPIO] = "GPIO repetido",
+    [CONFLITO_CANAL_PWM] = "canal de PWM repetido",
+    [CONFLITO_SLICE_PWM] = "slice de PWM com perfis diferentes",
+    [CONFLITO_PIO_SM] = "maquina de estados repetida",
+    [CONFLITO_INVALIDO] = "pedido invalido",
+};
+
+const char *recursos_nome_motivo(uint8_t motivo) {
+    return motivo < sizeof(NOMES) / sizeof(NOMES[0]) ? NOMES[motivo] : "?";
+}
+
+static bool valido(const recurso_pedido_t *p) {
+    if (p->gpio >= RECURSO_NUM_GPIOS)
+        return false;
+    return p->tipo == RECURSO_PWM || (p->tipo == RECURSO_PIO && p->pio < 2 && p->sm < 4);
+}
+
+// Primeiro motivo que impede os dois pedidos de coexistir (-1: nenhum)
+static int comparar(const recurso_pedido_t *a, const recurso_pedido_t *b) {
+    if (a->gpio == b->gpio)
+        return CONFLITO_GPIO;
+    if (a->tipo == RECURSO_PWM && b->tipo == RECURSO_PWM &&
+        RECURSO_PWM_SLICE(a->gpio) == RECURSO_PWM_SLICE(b->gpio)) {
+        if (RECURSO_PWM_CANAL(a->gpio) == RECURSO_PWM_CANAL(b->gpio))
+            return CONFLITO_CANAL_PWM;
+        if (a->perfil != b->perfil)
+            return CONFLITO_SLICE_PWM;
+    }
+    if (a->tipo == RECURSO_PIO && b->tipo == RECURSO_PIO && a->pio == b->pio && a->sm == b->sm)
+        return CONFLITO_PIO_SM;
+    return -1;
+}
+
+static void anotar(recurso_conflito_t *conflitos, uint32_t max, uint32_t total, int motivo, uint32_t a,
+                   uint32_t b) {
+    if (total >= max)
+        return;
+    conflitos[total].motivo = (uint8_t)motivo;
+    conflitos[total].a = (uint8_t)a;
+    conflitos[total].b = (uint8_t)b;
+}
+
+uint32_t recursos_verificar(const recurso_pedido_t *pedidos, uint32_t n, recurso_conflito_t *conflitos,
+                            uint32_t max) {
+    uint32_t total = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        if (!valido(&pedidos[i])) {
+            anotar(conflitos, max, total++, CONFLITO_INVALIDO, i, i);
+            continue;
+        }
+        for (uint32_t j = i + 1; j < n; j++) {
+            if (!valido(&pedidos[j]))
+                continue;
+            int motivo = comparar(&pedidos[i], &pedidos[j]);
+            if (motivo >= 0)
+                anotar(conflitos, max, total++, motivo, i, j);
+        }
+    }
+    return total;
+}
@@ -0,0 +1,50 @@
+#ifndef RECURSOS_H
+#define RECURSOS_H
+
+#include <stdint.h>
+
+//===============================================
+// Alocação de PWM e PIO por pino
+//
+// No RP2040 cada par de GPIOs divide um slice de PWM (mesmo contador,
+// wrap e divisor) e os GPIOs n e n+16 caem no mesmo canal. Um tom que
+// reprograma o slice do buzzer muda também o wrap do LED vizinho; por
+// isso cada pedido declara um perfil (wrap + divisor) e dois pinos no
+// mesmo slice só convivem com o mesmo perfil. A tabela da placa fica em
+// pinos.h e é conferida na inicialização e no host (tools/alocacao.c).
+// Não depende do SDK.
+//===============================================
+#define RECURSO_NUM_GPIOS 30
+#define RECURSO_PWM_SLICE(gpio) (((gpio) >> 1) & 7u)
+#define RECURSO_PWM_CANAL(gpio) ((gpio) & 1u)
+
+typedef enum { RECURSO_PWM = 0, RECURSO_PIO } recurso_tipo_t;
+
+typedef struct {
+    const char *dono;
+    uint8_t tipo;       // recurso_tipo_t
+    uint8_t gpio;
+    uint8_t pio;        // RECURSO_PIO: bloco e máquina de estados
+    uint8_t sm;
+    uint8_t perfil;     // RECURSO_PWM: pedidos no mesmo slice precisam do mesmo
+} recurso_pedido_t;
+
+typedef enum {
+    CONFLITO_GPIO = 0,     // Dois donos para o mesmo pino
+    CONFLITO_CANAL_PWM,    // Mesmo slice e canal (GPIO n e n+16)
+    CONFLITO_SLICE_PWM,    // Mesmo slice com perfis diferentes
+    CONFLITO_PIO_SM,       // Mesma máquina de estados
+    CONFLITO_INVALIDO,     // Pino, PIO ou máquina inexistente
+} recurso_motivo_t;
+
+typedef struct {
+    uint8_t motivo;     // recurso_motivo_t
+    uint8_t a, b;       // Índices dos pedidos (b == a nos inválidos)
+} recurso_conflito_t;
+
+// Compara os pedidos dois a dois; guarda até 'max' conflitos e devolve o total
+uint32_t recursos_verificar(const recurso_pedido_t *pedidos, uint32_t n, recurso_conflito_t *conflitos,
+                            uint32_t max);
+const char *recursos_nome_motivo(uint8_t motivo);
+
+#endif
@@ -0,0 +1,131 @@
+#include "scd4x.h"
+#include "crc.h"
+
+void scd4x_init(scd4x_t *dev, barramento_i2c_t *barramento) {
+    dev->barramento = barramento;
+    dev->estado = SCD4X_PARADO;
+    dev->prazo_us = 0;
+    dev->co2 = 0.0f;
+    dev->temperatura = 0.0f;
+    dev->umidade = 0.0f;
+    dev->valido = false;
+    dev->erros = 0;
+}
+
+static bool palavras_validas(const uint8_t *r, int palavras) {
+    for (int i = 0; i < palavras; i++) {
+        if (crc8_sensirion(&r[i * 3], 2) != r[i * 3 + 2])
+            return false;
+    }
+    return true;
+}
+
+static uint16_t palavra(const uint8_t *r, int i) {
+    return (uint16_t)((r[i * 3] << 8) | r[i * 3 + 1]);
+}
+
+static void concluido(void *ctx, int resultado, uint64_t instante_us) {
+    scd4x_t *dev = ctx;
+    if (resultado < 0) {
+        dev->erros++;
+        dev->estado = (dev->estado == SCD4X_INICIANDO) ? SCD4X_PARADO : SCD4X_ESPERA;
+        dev->prazo_us = instante_us + SCD4X_REPETIR_ERRO_US;
+        return;
+    }
+    switch (dev->estado) {
+    case SCD4X_INICIANDO:
+        dev->estado = SCD4X_ESPERA;
+        dev->prazo_us = instante_us + SCD4X_PERIODO_US;
+        break;
+    case SCD4X_CONSULTA_ENVIANDO:
+        dev->estado = SCD4X_CONSULTA_AGUARDA;
+        dev->prazo_us = instante_us + SCD4X_TEMPO_COMANDO_US;
+        break;
+    case SCD4X_CONSULTA_LENDO:
+        if (!palavras_validas(dev->resposta, 1)) {
+            dev->erros++;
+            dev->estado = SCD4X_ESPERA;
+            dev->prazo_us = instante_us + SCD4X_REPETIR_CONSULTA_US;
+        } else if (palavra(dev->resposta, 0) & 0x07FF) {
+            dev->estado = SCD4X_MEDIDA_PEDIR;
+            dev->prazo_us = instante_us;
+        } else {
+            dev->estado = SCD4X_ESPERA;
+            dev->prazo_us = instante_us + SCD4X_REPETIR_CONSULTA_US;
+        }
+        break;
+    case SCD4X_MEDIDA_ENVIANDO:
+        dev->estado = SCD4X_MEDIDA_AGUARDA;
+        dev->prazo_us = instante_us + SCD4X_TEMPO_COMANDO_US;
+        break;
+    case SCD4X_MEDIDA_LENDO:
+        if (palavras_validas(dev->resposta, 3)) {
+            dev->co2 = (float)palavra(dev->resposta, 0);
+            dev->temperatura = -45.0f + 175.0f * (float)palavra(dev->resposta, 1) / 65535.0f;
+            dev->umidade = 100.0f * (float)palavra(dev->resposta, 2) / 65535.0f;
+            dev->valido = true;
+        } else {
+            dev->erros++;
+        }
+        // O próximo resultado só fica pronto perto de 5 s depois
+        dev->estado = SCD4X_ESPERA;
+        dev->prazo_us = instante_us + SCD4X_PERIODO_US - 2 * SCD4X_REPETIR_CONSULTA_US;
+        break;
+    default:
+        break;
+    }
+}
+
+static void enviar_comando(scd4x_t *dev, uint16_t comando, uint8_t proximo_estado) {
+    dev->comando[0] = comando >> 8;
+    dev->comando[1] = comando & 0xFF;
+    i2c_transacao_t t = {
+        .endereco = SCD4X_ENDERECO,
+        .prioridade = I2C_PRIO_ALTA,
+        .leitura = false,
+        .dados = dev->comando,
+        .len = 2,
+        .concluido = concluido,
+        .ctx = dev,
+    };
+    if (barramento_i2c_enfileirar(dev->barramento, &t))
+        dev->estado = proximo_estado;
+}
+
+static void ler_resposta(scd4x_t *dev, size_t len, uint8_t proximo_estado) {
+    i2c_transacao_t t = {
+        .endereco = SCD4X_ENDERECO,
+        .prioridade = I2C_PRIO_ALTA,
+        .leitura = true,
+        .dados = dev->resposta,
+        .len = len,
+        .concluido = concluido,
+        .ctx = dev,
+    };
+    if (barramento_i2c_enfileirar(dev->barramento, &t))
+        dev->estado = proximo_estado;
+}
+
+void scd4x_poll(scd4x_t *dev, uint64_t agora_us) {
+    if ((int64_t)(agora_us - dev->prazo_us) < 0)
+        return;
+    switch (dev->estado) {
+    case SCD4X_PARADO:
+        enviar_comando(dev, SCD4X_CMD_INICIAR_PERIODICA, SCD4X_INICIANDO);
+        break;
+    case SCD4X_ESPERA:
+        enviar_comando(dev, SCD4X_CMD_DADO_PRONTO, SCD4X_CONSULTA_ENVIANDO);
+        break;
+    case SCD4X_CONSULTA_AGUARDA:
+        ler_resposta(dev, 3, SCD4X_CONSULTA_LENDO);
+        break;
+    case SCD4X_MEDIDA_PEDIR:
+        enviar_comando(dev, SCD4X_CMD_LER_MEDIDA, SCD4X_MEDIDA_ENVIANDO);
+        break;
+    case SCD4X_MEDIDA_AGUARDA:
+        ler_resposta(dev, 9, SCD4X_MEDIDA_LENDO);
+        break;
+    default:
+        break;   // Transação em andamento no barramento
+    }
+}
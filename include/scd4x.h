@@ -0,0 +1,52 @@
+#ifndef SCD4X_H
+#define SCD4X_H
+
+#include "barramento_i2c.h"
+
+//===============================================
+// Driver não bloqueante do SCD4x (CO₂, temperatura e umidade)
+//
+// Usa a medida periódica do sensor (um resultado a cada 5 s). A máquina
+// de estados consulta get_data_ready_status e só então pede
+// read_measurement; as esperas de 1 ms exigidas entre comando e leitura
+// são prazos, não sleeps, e o barramento fica livre nesse intervalo.
+//===============================================
+#define SCD4X_ENDERECO 0x62
+#define SCD4X_CMD_INICIAR_PERIODICA 0x21B1
+#define SCD4X_CMD_DADO_PRONTO 0xE4B8
+#define SCD4X_CMD_LER_MEDIDA 0xEC05
+#define SCD4X_PERIODO_US 5000000u
+#define SCD4X_TEMPO_COMANDO_US 1000u
+#define SCD4X_REPETIR_CONSULTA_US 100000u
+#define SCD4X_REPETIR_ERRO_US 1000000u
+
+typedef enum {
+    SCD4X_PARADO,
+    SCD4X_INICIANDO,
+    SCD4X_ESPERA,
+    SCD4X_CONSULTA_ENVIANDO,
+    SCD4X_CONSULTA_AGUARDA,
+    SCD4X_CONSULTA_LENDO,
+    SCD4X_MEDIDA_PEDIR,
+    SCD4X_MEDIDA_ENVIANDO,
+    SCD4X_MEDIDA_AGUARDA,
+    SCD4X_MEDIDA_LENDO
+} scd4x_estado_t;
+
+typedef struct {
+    barramento_i2c_t *barramento;
+    uint8_t estado;            // scd4x_estado_t
+    uint64_t prazo_us;         // Quando a etapa atual pode prosseguir
+    uint8_t comando[2];
+    uint8_t resposta[9];
+    float co2;
+    float temperatura;
+    float umidade;
+    bool valido;
+    uint32_t erros;
+} scd4x_t;
+
+void scd4x_init(scd4x_t *dev, barramento_i2c_t *barramento);
+void scd4x_poll(scd4x_t *dev, uint64_t agora_us);
+
+#endif
@@ -0,0 +1,19 @@
+#ifndef SECOES_H
+#define SECOES_H
+
+//===============================================
+// Posicionamento das funções quentes
+//
+// Com FRUITLIFE_RAM_HOT, as funções marcadas com FUNCAO_RAPIDA são
+// ligadas em SRAM (.time_critical) e não sofrem falhas da cache XIP.
+// Sem a opção, ficam na flash como as demais, o que permite medir o
+// ganho de cada escolha com o modo de benchmark.
+//===============================================
+#ifdef FRUITLIFE_RAM_HOT
+#include "pico.h"
+#define FUNCAO_RAPIDA(nome) __not_in_flash_func(nome)
+#else
+#define FUNCAO_RAPIDA(nome) nome
+#endif
+
+#endif
@@ -0,0 +1,79 @@
+#include "sht3x.h"
+#include "crc.h"
+
+void sht3x_init(sht3x_t *dev, barramento_i2c_t *barramento, uint32_t periodo_ms) {
+    dev->barramento = barramento;
+    dev->estado = SHT3X_OCIOSO;
+    dev->periodo_us = periodo_ms * 1000u;
+    dev->proxima_us = 0;
+    dev->prazo_us = 0;
+    dev->temperatura = 0.0f;
+    dev->umidade = 0.0f;
+    dev->valido = false;
+    dev->erros = 0;
+}
+
+static void falhou(sht3x_t *dev, uint64_t instante_us) {
+    dev->erros++;
+    dev->estado = SHT3X_OCIOSO;
+    dev->proxima_us = instante_us + dev->periodo_us;
+}
+
+static void comando_concluido(void *ctx, int resultado, uint64_t instante_us) {
+    sht3x_t *dev = ctx;
+    if (resultado < 0) {
+        falhou(dev, instante_us);
+        return;
+    }
+    dev->estado = SHT3X_CONVERTENDO;
+    dev->prazo_us = instante_us + SHT3X_TEMPO_CONVERSAO_US;
+}
+
+static void leitura_concluida(void *ctx, int resultado, uint64_t instante_us) {
+    sht3x_t *dev = ctx;
+    const uint8_t *r = dev->resposta;
+    if (resultado < 0 || crc8_sensirion(&r[0], 2) != r[2] || crc8_sensirion(&r[3], 2) != r[5]) {
+        falhou(dev, instante_us);
+        return;
+    }
+    uint16_t bruto_t = (uint16_t)((r[0] << 8) | r[1]);
+    uint16_t bruto_ur = (uint16_t)((r[3] << 8) | r[4]);
+    dev->temperatura = -45.0f + 175.0f * (float)bruto_t / 65535.0f;
+    dev->umidade = 100.0f * (float)bruto_ur / 65535.0f;
+    dev->valido = true;
+    dev->estado = SHT3X_OCIOSO;
+}
+
+void sht3x_poll(sht3x_t *dev, uint64_t agora_us) {
+    if (dev->estado == SHT3X_OCIOSO && (int64_t)(agora_us - dev->proxima_us) >= 0) {
+        dev->comando[0] = SHT3X_CMD_MEDIR_ALTA >> 8;
+        dev->comando[1] = SHT3X_CMD_MEDIR_ALTA & 0xFF;
+        i2c_transacao_t t = {
+            .endereco = SHT3X_ENDERECO,
+            .prioridade = I2C_PRIO_ALTA,
+            .leitura = false,
+            .dados = dev->comando,
+            .len = 2,
+            .concluido = comando_concluido,
+            .ctx = dev,
+        };
+        if (barramento_i2c_enfileirar(dev->barramento, &t)) {
+            dev->estado = SHT3X_ENVIANDO;
+            dev->proxima_us += dev->periodo_us;
+            if ((int64_t)(agora_us - dev->proxima_us) >= 0)
+                dev->proxima_us = agora_us + dev->periodo_us;   // Ficou para trás: não acumula atraso
+        }
+    } else if (dev->estado == SHT3X_CONVERTENDO && (int64_t)(agora_us - dev->prazo_us) >= 0) {
+        i2c_transacao_t t = {
+            .endereco = SHT3X_ENDERECO,
+            .prioridade = I2C_PRIO_ALTA,
+            .leitura = true,
+            .dados = dev->resposta,
+            .len = sizeof(dev->resposta),
+            .concluido = leitura_concluida,
+            .ctx = dev,
+        };
+        if (barramento_i2c_enfileirar(dev->barramento, &t))
+            dev->estado = SHT3X_LENDO;
+    }
+}
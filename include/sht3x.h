@@ -0,0 +1,41 @@
+#ifndef SHT3X_H
+#define SHT3X_H
+
+#include "barramento_i2c.h"
+
+//===============================================
+// Driver não bloqueante do SHT3x (temperatura e umidade)
+//
+// Medida single-shot sem clock stretching: envia o comando, aguarda a
+// conversão sem ocupar o barramento e só então lê os 6 bytes (T, UR e
+// seus CRCs). Cada chamada de sht3x_poll apenas avança a máquina de estados.
+//===============================================
+#define SHT3X_ENDERECO 0x44
+#define SHT3X_CMD_MEDIR_ALTA 0x2400       // Repetibilidade alta, sem clock stretching
+#define SHT3X_TEMPO_CONVERSAO_US 16000
+
+typedef enum {
+    SHT3X_OCIOSO,
+    SHT3X_ENVIANDO,
+    SHT3X_CONVERTENDO,
+    SHT3X_LENDO
+} sht3x_estado_t;
+
+typedef struct {
+    barramento_i2c_t *barramento;
+    uint8_t estado;            // sht3x_estado_t
+    uint32_t periodo_us;
+    uint64_t proxima_us;       // Próximo início de medida
+    uint64_t prazo_us;         // Fim da conversão
+    uint8_t comando[2];
+    uint8_t resposta[6];
+    float temperatura;
+    float umidade;
+    bool valido;
+    uint32_t erros;
+} sht3x_t;
+
+void sht3x_init(sht3x_t *dev, barramento_i2c_t *barramento, uint32_t periodo_ms);
+void sht3x_poll(sht3x_t *dev, uint64_t agora_us);
+
+#endif
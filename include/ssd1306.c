@@ -1,16 +1,23 @@
 #include "ssd1306.h"
 #include "font.h"
+#include "raster.h"
+#include "secoes.h"
+#include <string.h>
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c) {
-  ssd->width = width;
-  ssd->height = height;
-  ssd->pages = height / 8U;
+  // O quadro fica dentro de ssd1306_t: telas maiores que WIDTH x HEIGHT são limitadas
+  ssd->width = width > WIDTH ? WIDTH : width;
+  ssd->height = height > HEIGHT ? HEIGHT : height;
+  ssd->pages = ssd->height / 8U;
   ssd->address = address;
   ssd->i2c_port = i2c;
   ssd->bufsize = ssd->pages * ssd->width + 1;
-  ssd->ram_buffer = calloc(ssd->bufsize, sizeof(uint8_t));
+  memset(ssd->ram_buffer, 0, sizeof(ssd->ram_buffer));
   ssd->ram_buffer[0] = 0x40;
   ssd->port_buffer[0] = 0x80;
+  ssd->barramento = NULL;
+  ssd->envio_ativo = false;
+  ssd->envio_pendente = false;
 }
 
 void ssd1306_config(ssd1306_t *ssd) {
@@ -43,12 +50,13 @@ void ssd1306_config(ssd1306_t *ssd) {
 
 void ssd1306_command(ssd1306_t *ssd, uint8_t command) {
   ssd->port_buffer[1] = command;
-  i2c_write_blocking(
+  i2c_write_timeout_us(
     ssd->i2c_port,
     ssd->address,
     ssd->port_buffer,
     2,
-    false
+    false,
+    SSD1306_TIMEOUT_US
   );
 }
 
@@ -59,101 +67,147 @@ void ssd1306_send_data(ssd1306_t *ssd) {
   ssd1306_command(ssd, SET_PAGE_ADDR);
   ssd1306_command(ssd, 0);
   ssd1306_command(ssd, ssd->pages - 1);
-  i2c_write_blocking(
+  i2c_write_timeout_us(
     ssd->i2c_port,
     ssd->address,
     ssd->ram_buffer,
     ssd->bufsize,
-    false
+    false,
+    SSD1306_TIMEOUT_US
   );
 }
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value) {
-  uint16_t index = (y >> 3) + (x << 3) + 1;
-  uint8_t pixel = (y & 0b111);
-  if (value)
-    ssd->ram_buffer[index] |= (1 << pixel);
-  else
-    ssd->ram_buffer[index] &= ~(1 << pixel);
+// Envio assíncrono: os comandos de endereçamento vão em uma transação e o
+// quadro em pedaços de SSD1306_PEDACO bytes, cada um com o byte de controle
+// 0x40. O próximo pedaço só é enfileirado quando o anterior termina, então
+// transações de maior prioridade (sensores) passam à frente entre pedaços.
+static void ssd1306_enfileirar_pedaco(ssd1306_t *ssd);
+
+static void ssd1306_preparar_pedaco(void *ctx) {
+  ssd1306_t *ssd = ctx;
+  size_t n = ssd->bufsize - ssd->envio_pos;
+  if (n > SSD1306_PEDACO)
+    n = SSD1306_PEDACO;
+  ssd->envio_pedaco[0] = 0x40;
+  memcpy(&ssd->envio_pedaco[1], &ssd->ram_buffer[ssd->envio_pos], n);
 }
 
-/*
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-  uint8_t byte = value ? 0xFF : 0x00;
-  for (uint8_t i = 1; i < ssd->bufsize; ++i)
-    ssd->ram_buffer[i] = byte;
-}*/
-
-void ssd1306_fill(ssd1306_t *ssd, bool value) {
-    // Itera por todas as posições do display
-    for (uint8_t y = 0; y < ssd->height; ++y) {
-        for (uint8_t x = 0; x < ssd->width; ++x) {
-            ssd1306_pixel(ssd, x, y, value);
-        }
+static void ssd1306_pedaco_concluido(void *ctx, int resultado, uint64_t instante_us) {
+  ssd1306_t *ssd = ctx;
+  if (resultado >= 0) {
+    size_t n = ssd->bufsize - ssd->envio_pos;
+    ssd->envio_pos += (n > SSD1306_PEDACO) ? SSD1306_PEDACO : n;
+    if (ssd->envio_pos < ssd->bufsize) {
+      ssd1306_enfileirar_pedaco(ssd);
+      return;
     }
-}
-
-
-
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill) {
-  for (uint8_t x = left; x < left + width; ++x) {
-    ssd1306_pixel(ssd, x, top, value);
-    ssd1306_pixel(ssd, x, top + height - 1, value);
-  }
-  for (uint8_t y = top; y < top + height; ++y) {
-    ssd1306_pixel(ssd, left, y, value);
-    ssd1306_pixel(ssd, left + width - 1, y, value);
   }
-
-  if (fill) {
-    for (uint8_t x = left + 1; x < left + width - 1; ++x) {
-      for (uint8_t y = top + 1; y < top + height - 1; ++y) {
-        ssd1306_pixel(ssd, x, y, value);
-      }
-    }
+  ssd->envio_ativo = false;
+  if (ssd->envio_pendente) {
+    ssd->envio_pendente = false;
+    ssd1306_send_data_async(ssd, ssd->barramento);
   }
 }
 
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value) {
-    int dx = abs(x1 - x0);
-    int dy = abs(y1 - y0);
-
-    int sx = (x0 < x1) ? 1 : -1;
-    int sy = (y0 < y1) ? 1 : -1;
+static void ssd1306_enfileirar_pedaco(ssd1306_t *ssd) {
+  size_t n = ssd->bufsize - ssd->envio_pos;
+  i2c_transacao_t t = {
+    .endereco = ssd->address,
+    .prioridade = I2C_PRIO_BAIXA,
+    .leitura = false,
+    .dados = ssd->envio_pedaco,
+    .len = ((n > SSD1306_PEDACO) ? SSD1306_PEDACO : n) + 1,
+    .preparar = ssd1306_preparar_pedaco,
+    .concluido = ssd1306_pedaco_concluido,
+    .ctx = ssd,
+  };
+  if (!barramento_i2c_enfileirar(ssd->barramento, &t))
+    ssd->envio_ativo = false;
+}
 
-    int err = dx - dy;
+void ssd1306_send_data_async(ssd1306_t *ssd, barramento_i2c_t *barramento) {
+  ssd->barramento = barramento;
+  if (ssd->envio_ativo) {
+    // Quadro em andamento: reenvia o buffer atualizado quando ele terminar
+    ssd->envio_pendente = true;
+    return;
+  }
+  // Byte de controle 0x00 seguido de uma sequência de comandos
+  ssd->envio_cmd[0] = 0x00;
+  ssd->envio_cmd[1] = SET_COL_ADDR;
+  ssd->envio_cmd[2] = 0;
+  ssd->envio_cmd[3] = ssd->width - 1;
+  ssd->envio_cmd[4] = SET_PAGE_ADDR;
+  ssd->envio_cmd[5] = 0;
+  ssd->envio_cmd[6] = ssd->pages - 1;
+  i2c_transacao_t t = {
+    .endereco = ssd->address,
+    .prioridade = I2C_PRIO_BAIXA,
+    .leitura = false,
+    .dados = ssd->envio_cmd,
+    .len = sizeof(ssd->envio_cmd),
+  };
+  if (!barramento_i2c_enfileirar(barramento, &t))
+    return;
+  ssd->envio_ativo = true;
+  ssd->envio_pos = 1;   // ram_buffer[0] é o byte de controle do envio bloqueante
+  ssd1306_enfileirar_pedaco(ssd);
+}
 
-    while (true) {
-        ssd1306_pixel(ssd, x0, y0, value); // Desenha o pixel atual
+// Contraste e liga/desliga do painel numa única transação pelo barramento,
+// para não disputar o i2c1 com um quadro em andamento. Com o painel
+// desligado a RAM do controlador é preservada e não é preciso redesenhar.
+bool ssd1306_energia_async(ssd1306_t *ssd, barramento_i2c_t *barramento, bool ligado, uint8_t contraste) {
+  ssd->energia_cmd[0] = 0x00;
+  ssd->energia_cmd[1] = SET_CONTRAST;
+  ssd->energia_cmd[2] = contraste;
+  ssd->energia_cmd[3] = SET_DISP | (ligado ? 0x01 : 0x00);
+  i2c_transacao_t t = {
+    .endereco = ssd->address,
+    .prioridade = I2C_PRIO_NORMAL,
+    .leitura = false,
+    .dados = ssd->energia_cmd,
+    .len = sizeof(ssd->energia_cmd),
+  };
+  return barramento_i2c_enfileirar(barramento, &t);
+}
 
-        if (x0 == x1 && y0 == y1) break; // Termina quando alcança o ponto final
+// Vista do quadro (sem o byte de controle) para a camada de rasterização
+static inline raster_t raster(ssd1306_t *ssd) {
+  return (raster_t){ ssd->ram_buffer + 1, ssd->width, ssd->height, ssd->pages };
+}
 
-        int e2 = err * 2;
+void ssd1306_pixel(ssd1306_t *ssd, int x, int y, bool value) {
+  raster_t r = raster(ssd);
+  raster_pixel(&r, x, y, value);
+}
 
-        if (e2 > -dy) {
-            err -= dy;
-            x0 += sx;
-        }
+void ssd1306_fill(ssd1306_t *ssd, bool value) {
+  raster_t r = raster(ssd);
+  raster_preencher(&r, value);
+}
 
-        if (e2 < dx) {
-            err += dx;
-            y0 += sy;
-        }
-    }
+void ssd1306_rect(ssd1306_t *ssd, int top, int left, int width, int height, bool value, bool fill) {
+  raster_t r = raster(ssd);
+  raster_retangulo(&r, left, top, width, height, value, fill);
 }
 
+void ssd1306_line(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value) {
+  raster_t r = raster(ssd);
+  raster_linha(&r, x0, y0, x1, y1, value);
+}
 
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value) {
-  for (uint8_t x = x0; x <= x1; ++x)
-    ssd1306_pixel(ssd, x, y, value);
+void ssd1306_hline(ssd1306_t *ssd, int x0, int x1, int y, bool value) {
+  raster_t r = raster(ssd);
+  raster_hspan(&r, x0, x1, y, value);
 }
 
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value) {
-  for (uint8_t y = y0; y <= y1; ++y)
-    ssd1306_pixel(ssd, x, y, value);
+void ssd1306_vline(ssd1306_t *ssd, int x, int y0, int y1, bool value) {
+  raster_t r = raster(ssd);
+  raster_vspan(&r, x, y0, y1, value);
 }
 
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
+void FUNCAO_RAPIDA(ssd1306_draw_char)(ssd1306_t *ssd, char c, int x, int y)
 {
   uint16_t index = 0;
   
@@ -175,17 +229,13 @@ void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y)
     index = 0;
   }
   
-  for (uint8_t i = 0; i < 8; ++i) {
-    uint8_t line = font[index + i];
-    for (uint8_t j = 0; j < 8; ++j) {
-      ssd1306_pixel(ssd, x + i, y + j, line & (1 << j));
-    }
-  }
+  raster_t r = raster(ssd);
+  raster_glifo(&r, &font[index], x, y);
 }
 
 
 // Função para desenhar uma string
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, int x, int y)
 {
   while (*str)
   {
@@ -201,4 +251,4 @@ void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y)
       break;
     }
   }
-}
\ No newline at end of file
+}
@@ -1,9 +1,13 @@
 #include <stdlib.h>
 #include "pico/stdlib.h"
 #include "hardware/i2c.h"
+#include "barramento_i2c.h"
 
 #define WIDTH 128
 #define HEIGHT 64
+#define SSD1306_PEDACO 32   // Bytes de dados por transação no envio assíncrono
+#define SSD1306_TIMEOUT_US 50000   // Envio bloqueante não trava com o barramento preso
+#define SSD1306_BUFSIZE (WIDTH * HEIGHT / 8 + 1)   // Quadro + byte de controle, sem heap
 
 typedef enum {
   SET_CONTRAST = 0x81,
@@ -29,21 +33,32 @@ typedef struct {
   uint8_t width, height, pages, address;
   i2c_inst_t *i2c_port;
   bool external_vcc;
-  uint8_t *ram_buffer;
+  uint8_t ram_buffer[SSD1306_BUFSIZE];
   size_t bufsize;
   uint8_t port_buffer[2];
+  // Envio assíncrono pelo gerenciador de barramento
+  barramento_i2c_t *barramento;
+  bool envio_ativo;
+  bool envio_pendente;
+  uint16_t envio_pos;
+  uint8_t envio_cmd[7];
+  uint8_t envio_pedaco[SSD1306_PEDACO + 1];
+  uint8_t energia_cmd[4];
 } ssd1306_t;
 
 void ssd1306_init(ssd1306_t *ssd, uint8_t width, uint8_t height, bool external_vcc, uint8_t address, i2c_inst_t *i2c);
 void ssd1306_config(ssd1306_t *ssd);
 void ssd1306_command(ssd1306_t *ssd, uint8_t command);
 void ssd1306_send_data(ssd1306_t *ssd);
+void ssd1306_send_data_async(ssd1306_t *ssd, barramento_i2c_t *barramento);
+bool ssd1306_energia_async(ssd1306_t *ssd, barramento_i2c_t *barramento, bool ligado, uint8_t contraste);
 
-void ssd1306_pixel(ssd1306_t *ssd, uint8_t x, uint8_t y, bool value);
+// Desenho recortado à tela (raster.c): coordenadas fora dela são seguras
+void ssd1306_pixel(ssd1306_t *ssd, int x, int y, bool value);
 void ssd1306_fill(ssd1306_t *ssd, bool value);
-void ssd1306_rect(ssd1306_t *ssd, uint8_t top, uint8_t left, uint8_t width, uint8_t height, bool value, bool fill);
-void ssd1306_line(ssd1306_t *ssd, uint8_t x0, uint8_t y0, uint8_t x1, uint8_t y1, bool value);
-void ssd1306_hline(ssd1306_t *ssd, uint8_t x0, uint8_t x1, uint8_t y, bool value);
-void ssd1306_vline(ssd1306_t *ssd, uint8_t x, uint8_t y0, uint8_t y1, bool value);
-void ssd1306_draw_char(ssd1306_t *ssd, char c, uint8_t x, uint8_t y);
-void ssd1306_draw_string(ssd1306_t *ssd, const char *str, uint8_t x, uint8_t y);
\ No newline at end of file
+void ssd1306_rect(ssd1306_t *ssd, int top, int left, int width, int height, bool value, bool fill);
+void ssd1306_line(ssd1306_t *ssd, int x0, int y0, int x1, int y1, bool value);
+void ssd1306_hline(ssd1306_t *ssd, int x0, int x1, int y, bool value);
+void ssd1306_vline(ssd1306_t *ssd, int x, int y0, int y1, bool value);
+void ssd1306_draw_char(ssd1306_t *ssd, char c, int x, int y);
+void ssd1306_draw_string(ssd1306_t *ssd, const char *str, int x, int y);
\ No newline at end of file
@@ -0,0 +1,55 @@
+#include "supervisao.h"
+#include "hardware/watchdog.h"
+#include "hardware/structs/vreg_and_chip_reset.h"
+
+// Um flag por tarefa: escritas de bool são atômicas, então IRQs podem fazer
+// check-in sem disputar um read-modify-write com o laço principal.
+static volatile bool check_in[NUM_TAREFAS];
+static bool ativo = false;
+
+motivo_reinicio_t supervisao_motivo_reinicio(void) {
+    if (watchdog_enable_caused_reboot())
+        return REINICIO_WATCHDOG;
+    if (watchdog_caused_reboot())
+        return REINICIO_SOFT;
+    uint32_t chip_reset = vreg_and_chip_reset_hw->chip_reset;
+    if (chip_reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_PSM_RESTART_BITS)
+        return REINICIO_DEPURADOR;
+    if (chip_reset & VREG_AND_CHIP_RESET_CHIP_RESET_HAD_RUN_BITS)
+        return REINICIO_PINO_RUN;
+    return REINICIO_ENERGIA;
+}
+
+const char *supervisao_nome_motivo(motivo_reinicio_t motivo) {
+    switch (motivo) {
+    case REINICIO_PINO_RUN: return "Pino RUN";
+    case REINICIO_DEPURADOR: return "Depurador";
+    case REINICIO_WATCHDOG: return "Watchdog";
+    case REINICIO_SOFT: return "Soft";
+    default: return "Energia";
+    }
+}
+
+void supervisao_iniciar(uint32_t timeout_ms) {
+    for (int i = 0; i < NUM_TAREFAS; i++)
+        check_in[i] = false;
+    watchdog_enable(timeout_ms, true);   // Pausa durante depuração
+    ativo = true;
+}
+
+void supervisao_check_in(tarefa_t tarefa) {
+    check_in[tarefa] = true;
+}
+
+bool supervisao_alimentar(void) {
+    if (!ativo)
+        return false;
+    for (int i = 0; i < NUM_TAREFAS; i++) {
+        if (!check_in[i])
+            return false;
+    }
+    for (int i = 0; i < NUM_TAREFAS; i++)
+        check_in[i] = false;
+    watchdog_update();
+    return true;
+}
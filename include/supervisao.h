@@ -0,0 +1,38 @@
+#ifndef SUPERVISAO_H
+#define SUPERVISAO_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Supervisão por watchdog
+//
+// Cada tarefa crítica faz check-in ao completar um ciclo. O laço principal
+// só alimenta o watchdog quando todas fizeram check-in desde a última
+// alimentação; se qualquer uma travar (ex.: barramento I2C preso), o
+// watchdog reinicia o chip.
+//===============================================
+#define SUPERVISAO_TIMEOUT_MS 3000
+
+typedef enum {
+    TAREFA_MEDICAO = 0,    // Laço principal: leitura e classificação
+    TAREFA_BOTOES,         // Amostrador dos botões (IRQ de alarme)
+    TAREFA_BARRAMENTO,     // Fila do barramento I2C andando
+    NUM_TAREFAS
+} tarefa_t;
+
+typedef enum {
+    REINICIO_ENERGIA = 0,  // Power-on / brown-out
+    REINICIO_PINO_RUN,
+    REINICIO_DEPURADOR,
+    REINICIO_WATCHDOG,     // Estouro do watchdog
+    REINICIO_SOFT          // watchdog_reboot() pedido pelo firmware
+} motivo_reinicio_t;
+
+motivo_reinicio_t supervisao_motivo_reinicio(void);
+const char *supervisao_nome_motivo(motivo_reinicio_t motivo);
+void supervisao_iniciar(uint32_t timeout_ms);
+void supervisao_check_in(tarefa_t tarefa);
+bool supervisao_alimentar(void);
+
+#endif
@@ -0,0 +1,94 @@
+#include "tendencia.h"
+
+void tendencia_init(tendencia_t *t, uint32_t intervalo_ms) {
+    t->inicio = 0;
+    t->n = 0;
+    t->soma_y = 0;
+    t->soma_xy = 0;
+    t->intervalo_ms = intervalo_ms;
+    t->acumulado = 0;
+    t->acumulado_n = 0;
+    t->iniciado = false;
+}
+
+static void empurrar(tendencia_t *t, int32_t y) {
+    if (t->n < TENDENCIA_JANELA) {
+        t->amostras[(t->inicio + t->n) % TENDENCIA_JANELA] = y;
+        t->soma_y += y;
+        t->soma_xy += (int64_t)t->n * y;
+        t->n++;
+        return;
+    }
+    // Janela cheia: sai a mais antiga (x = 0) e as demais descem um índice
+    int32_t antigo = t->amostras[t->inicio];
+    t->soma_xy += -(t->soma_y - antigo) + (int64_t)(TENDENCIA_JANELA - 1) * y;
+    t->soma_y += y - antigo;
+    t->amostras[t->inicio] = y;
+    t->inicio = (uint16_t)((t->inicio + 1) % TENDENCIA_JANELA);
+}
+
+// Acumula a leitura; ao fim de cada intervalo a média entra na janela
+bool tendencia_adicionar(tendencia_t *t, float valor, uint32_t agora_ms) {
+    if (!t->iniciado) {
+        t->iniciado = true;
+        t->inicio_intervalo_ms = agora_ms;
+    }
+    t->acumulado += (int64_t)(valor * 1000.0f);
+    t->acumulado_n++;
+    if (agora_ms - t->inicio_intervalo_ms < t->intervalo_ms)
+        return false;
+    empurrar(t, (int32_t)(t->acumulado / (int64_t)t->acumulado_n));
+    t->acumulado = 0;
+    t->acumulado_n = 0;
+    t->inicio_intervalo_ms += t->intervalo_ms;
+    if (agora_ms - t->inicio_intervalo_ms >= t->intervalo_ms)
+        t->inicio_intervalo_ms = agora_ms;   // Laço parado por muito tempo: realinha
+    return true;
+}
+
+// Inclinação em mili-unidades por amostra
+static bool inclinacao_amostra(const tendencia_t *t, double *b) {
+    if (t->n < TENDENCIA_MIN_AMOSTRAS)
+        return false;
+    int64_t n = t->n;
+    int64_t sx = n * (n - 1) / 2;
+    int64_t sxx = (n - 1) * n * (2 * n - 1) / 6;
+    int64_t den = n * sxx - sx * sx;
+    *b = (double)(n * t->soma_xy - sx * t->soma_y) / (double)den;
+    return true;
+}
+
+bool tendencia_inclinacao(const tendencia_t *t, float *por_segundo) {
+    double b;
+    if (!inclinacao_amostra(t, &b))
+        return false;
+    *por_segundo = (float)(b / 1000.0 * 1000.0 / t->intervalo_ms);
+    return true;
+}
+
+// Valor da reta ajustada na amostra mais recente (x = n - 1)
+bool tendencia_valor_atual(const tendencia_t *t, float *valor) {
+    double b;
+    if (!inclinacao_amostra(t, &b))
+        return false;
+    double sx = (double)t->n * (t->n - 1) / 2.0;
+    double a = ((double)t->soma_y - b * sx) / t->n;
+    *valor = (float)((a + b * (t->n - 1)) / 1000.0);
+    return true;
+}
+
+// Tempo previsto até a reta cruzar "limite"; falso se ela se afasta do limite
+bool tendencia_tempo_ate(const tendencia_t *t, float limite, float *segundos) {
+    float atual, inclinacao;
+    if (!tendencia_valor_atual(t, &atual) || !tendencia_inclinacao(t, &inclinacao))
+        return false;
+    float distancia = limite - atual;
+    if (distancia == 0.0f) {
+        *segundos = 0.0f;
+        return true;
+    }
+    if (inclinacao == 0.0f || (distancia > 0.0f) != (inclinacao > 0.0f))
+        return false;
+    *segundos = distancia / inclinacao;
+    return true;
+}
@@ -0,0 +1,39 @@
+#ifndef TENDENCIA_H
+#define TENDENCIA_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//===============================================
+// Estimador incremental de tendência (regressão linear em janela deslizante)
+//
+// As leituras são agregadas em médias de intervalo fixo; cada média entra
+// na janela com x = 0..n-1. Como x é o índice da amostra, Σx e Σx² têm
+// forma fechada e só Σy e Σxy precisam ser mantidas, em ponto fixo
+// (mili-unidades), para evitar deriva numérica. Cada nova amostra custa
+// O(1): ao deslocar a janela, Σxy' = Σxy - (Σy - y_antigo) + (n-1)·y_novo.
+//===============================================
+#define TENDENCIA_JANELA 60          // Amostras na janela
+#define TENDENCIA_MIN_AMOSTRAS 6     // Mínimo para estimar a inclinação
+
+typedef struct {
+    int32_t amostras[TENDENCIA_JANELA];   // Mili-unidades
+    uint16_t inicio;
+    uint16_t n;
+    int64_t soma_y;
+    int64_t soma_xy;
+    uint32_t intervalo_ms;
+    // Média do intervalo em andamento
+    int64_t acumulado;
+    uint32_t acumulado_n;
+    uint32_t inicio_intervalo_ms;
+    bool iniciado;
+} tendencia_t;
+
+void tendencia_init(tendencia_t *t, uint32_t intervalo_ms);
+bool tendencia_adicionar(tendencia_t *t, float valor, uint32_t agora_ms);
+bool tendencia_inclinacao(const tendencia_t *t, float *por_segundo);
+bool tendencia_valor_atual(const tendencia_t *t, float *valor);
+bool tendencia_tempo_ate(const tendencia_t *t, float limite, float *segundos);
+
+#endif
@@ -0,0 +1,35 @@
+#ifndef TOM_H
+#define TOM_H
+
+#include <stdint.h>
+
+//===============================================
+// Pedidos para o gerador de tons da PIO (tom.pio)
+//
+// A máquina de estado roda a TOM_TICK_HZ (o divisor acompanha o clk_sys),
+// então as notas não dependem do clock e as melodias podem ser tabelas
+// constantes na flash, enviadas à FIFO por DMA. As macros também servem
+// para valores calculados em execução.
+//===============================================
+#define TOM_TICK_HZ 1000000u
+#define TOM_CICLOS_FIXOS 7u          // Instruções de cada período fora dos laços de espera
+#define TOM_NOTA_BIT 0x80000000u
+
+typedef struct {
+    uint32_t meio_periodo;   // Ciclos de cada laço de espera
+    uint32_t periodos;       // Períodos - 1, com TOM_NOTA_BIT nas notas
+} tom_pedido_t;
+
+#define TOM_DIV_ARRED(a, b) (((a) + (b) / 2) / (b))
+// Períodos possíveis: 2 * meio + 7 ticks; meio = arred((TICK / f - 7) / 2), um arredondamento só
+#define TOM_MEIO_PERIODO(f) ((TOM_TICK_HZ - (TOM_CICLOS_FIXOS - 1u) * (uint32_t)(f)) / (2u * (uint32_t)(f)))
+#define TOM_PERIODO(f) (2 * TOM_MEIO_PERIODO(f) + TOM_CICLOS_FIXOS)   // Em ticks
+#define TOM_PERIODOS(ms, periodo) \
+    (TOM_DIV_ARRED((TOM_TICK_HZ / 1000u) * (uint32_t)(ms), (periodo)) ? TOM_DIV_ARRED((TOM_TICK_HZ / 1000u) * (uint32_t)(ms), (periodo)) : 1u)
+
+// Nota de f Hz (até ~5 kHz com erro abaixo de 0,5%) por ms milissegundos
+#define TOM_NOTA(f, ms) { TOM_MEIO_PERIODO(f), TOM_NOTA_BIT | (TOM_PERIODOS(ms, TOM_PERIODO(f)) - 1u) }
+// Silêncio: períodos de 1 kHz com o pino em 0
+#define TOM_PAUSA(ms) { TOM_MEIO_PERIODO(1000), TOM_PERIODOS(ms, TOM_PERIODO(1000)) - 1u }
+
+#endif
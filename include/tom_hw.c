@@ -0,0 +1,66 @@
+#include "tom_hw.h"
+#include "hardware/clocks.h"
+#include "hardware/dma.h"
+#include "tom.pio.h"
+
+// Palavras por pedido na FIFO (juntada: 8 posições)
+#define PALAVRAS_PEDIDO 2u
+
+static PIO pio_tom;
+static uint offset_programa;
+static uint buzzers = 0;
+static int canal_dma[TOM_HW_MAX_BUZZERS];
+
+static float divisor(void) {
+    return (float)clock_get_hz(clk_sys) / (float)TOM_TICK_HZ;
+}
+
+void tom_hw_iniciar(PIO pio, const uint *pinos, uint n) {
+    if (n > TOM_HW_MAX_BUZZERS)
+        n = TOM_HW_MAX_BUZZERS;
+    pio_tom = pio;
+    offset_programa = pio_add_program(pio, &tom_program);
+    for (uint i = 0; i < n; i++) {
+        pio_sm_claim(pio, i);
+        tom_program_init(pio, i, offset_programa, pinos[i], divisor());
+        canal_dma[i] = dma_claim_unused_channel(true);
+        dma_channel_config c = dma_channel_get_default_config((uint)canal_dma[i]);
+        channel_config_set_transfer_data_size(&c, DMA_SIZE_32);
+        channel_config_set_read_increment(&c, true);
+        channel_config_set_write_increment(&c, false);
+        channel_config_set_dreq(&c, pio_get_dreq(pio, i, true));
+        dma_channel_configure((uint)canal_dma[i], &c, &pio->txf[i], NULL, 0, false);
+    }
+    buzzers = n;
+}
+
+bool tom_hw_tocar(uint buzzer, uint32_t frequencia, uint32_t duracao_ms) {
+    if (buzzer >= buzzers || frequencia == 0 || dma_channel_is_busy((uint)canal_dma[buzzer]) ||
+        pio_sm_get_tx_fifo_level(pio_tom, buzzer) > 8u - PALAVRAS_PEDIDO)
+        return false;
+    uint32_t periodo = TOM_PERIODO(frequencia);
+    pio_sm_put(pio_tom, buzzer, TOM_MEIO_PERIODO(frequencia));
+    pio_sm_put(pio_tom, buzzer, TOM_NOTA_BIT | (TOM_PERIODOS(duracao_ms, periodo) - 1u));
+    return true;
+}
+
+bool tom_hw_sequencia(uint buzzer, const tom_pedido_t *pedidos, uint n) {
+    if (buzzer >= buzzers || dma_channel_is_busy((uint)canal_dma[buzzer]))
+        return false;
+    dma_channel_transfer_from_buffer_now((uint)canal_dma[buzzer], pedidos, n * PALAVRAS_PEDIDO);
+    return true;
+}
+
+bool tom_hw_tocando(void) {
+    // Ociosa = FIFO vazia e parada no primeiro pull do programa
+    for (uint i = 0; i < buzzers; i++)
+        if (dma_channel_is_busy((uint)canal_dma[i]) || !pio_sm_is_tx_fifo_empty(pio_tom, i) ||
+            pio_sm_get_pc(pio_tom, i) != offset_programa)
+            return true;
+    return false;
+}
+
+void tom_hw_ajustar_clock(void) {
+    for (uint i = 0; i < buzzers; i++)
+        pio_sm_set_clkdiv(pio_tom, i, divisor());
+}
@@ -0,0 +1,24 @@
+#ifndef TOM_HW_H
+#define TOM_HW_H
+
+#include "tom.h"
+#include "hardware/pio.h"
+#include <stdbool.h>
+
+// Tons dos buzzers passivos numa PIO própria: o buzzer i usa a máquina
+// de estados i e um canal de DMA, então tons, melodias e o PWM dos LEDs
+// não disputam slices nem alarmes. A máquina encerra cada nota sozinha
+// e deixa o pino em 0; nada aqui bloqueia.
+#define TOM_HW_MAX_BUZZERS 4
+
+void tom_hw_iniciar(PIO pio, const uint *pinos, uint n);
+// Enfileira uma nota; false se o buzzer está numa melodia ou a FIFO está cheia
+bool tom_hw_tocar(uint buzzer, uint32_t frequencia, uint32_t duracao_ms);
+// Melodia por DMA direto da tabela, que precisa continuar válida e estar
+// na SRAM: o DMA segue lendo enquanto a flash é apagada ou programada
+bool tom_hw_sequencia(uint buzzer, const tom_pedido_t *pedidos, uint n);
+bool tom_hw_tocando(void);
+// Refaz os divisores depois de trocar o clk_sys
+void tom_hw_ajustar_clock(void);
+
+#endif
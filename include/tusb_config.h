@@ -0,0 +1,27 @@
+#ifndef TUSB_CONFIG_H
+#define TUSB_CONFIG_H
+
+//===============================================
+// TinyUSB do modo de armazenamento (FRUITLIFE_USB_MSC)
+//
+// Com a opção, a aplicação é dona do TinyUSB: dispositivo composto com o
+// CDC do stdio e o volume MSC somente leitura (usb_disco_hw.c).
+// CFG_TUSB_MCU e CFG_TUSB_OS vêm da biblioteca tinyusb_device do SDK.
+//===============================================
+#define CFG_TUSB_RHPORT0_MODE OPT_MODE_DEVICE
+#define CFG_TUD_ENABLED 1
+#define CFG_TUD_ENDPOINT0_SIZE 64
+
+#define CFG_TUD_CDC 1
+#define CFG_TUD_MSC 1
+#define CFG_TUD_HID 0
+#define CFG_TUD_MIDI 0
+#define CFG_TUD_VENDOR 0
+
+// Mesmos buffers do stdio USB padrão do SDK
+#define CFG_TUD_CDC_RX_BUFSIZE 256
+#define CFG_TUD_CDC_TX_BUFSIZE 256
+// Oito setores por chamada de leitura: menos voltas no gerador
+#define CFG_TUD_MSC_EP_BUFSIZE 4096
+
+#endif
@@ -0,0 +1,168 @@
+#include "usb_disco_hw.h"
+#include "disco_fat.h"
+#include "pico/unique_id.h"
+#include "tusb.h"
+#include <string.h>
+
+// Par de testes dos exemplos do TinyUSB; trocar pelo VID/PID do produto
+#define USB_VID 0xCAFE
+#define USB_PID 0x4046
+
+enum { ITF_CDC = 0, ITF_CDC_DADOS, ITF_MSC, ITF_TOTAL };
+
+#define EP_CDC_NOTIFICACAO 0x81
+#define EP_CDC_SAIDA 0x02
+#define EP_CDC_ENTRADA 0x82
+#define EP_MSC_SAIDA 0x03
+#define EP_MSC_ENTRADA 0x83
+
+enum { STR_IDIOMA = 0, STR_FABRICANTE, STR_PRODUTO, STR_SERIE, STR_CDC, STR_MSC };
+
+static const historico_t *historico;
+static disco_fat_t disco;
+static bool montado = false;
+
+//===============================================
+// Descritores: dispositivo composto CDC + MSC
+//===============================================
+static const tusb_desc_device_t DISPOSITIVO = {
+    .bLength = sizeof(tusb_desc_device_t),
+    .bDescriptorType = TUSB_DESC_DEVICE,
+    .bcdUSB = 0x0200,
+    // Associação de interfaces (IAD) para o CDC dentro do composto
+    .bDeviceClass = TUSB_CLASS_MISC,
+    .bDeviceSubClass = MISC_SUBCLASS_COMMON,
+    .bDeviceProtocol = MISC_PROTOCOL_IAD,
+    .bMaxPacketSize0 = CFG_TUD_ENDPOINT0_SIZE,
+    .idVendor = USB_VID,
+    .idProduct = USB_PID,
+    .bcdDevice = 0x0100,
+    .iManufacturer = STR_FABRICANTE,
+    .iProduct = STR_PRODUTO,
+    .iSerialNumber = STR_SERIE,
+    .bNumConfigurations = 1,
+};
+
+#define TAMANHO_CONFIGURACAO (TUD_CONFIG_DESC_LEN + TUD_CDC_DESC_LEN + TUD_MSC_DESC_LEN)
+
+static const uint8_t CONFIGURACAO[] = {
+    TUD_CONFIG_DESCRIPTOR(1, ITF_TOTAL, 0, TAMANHO_CONFIGURACAO, 0, 100),
+    TUD_CDC_DESCRIPTOR(ITF_CDC, STR_CDC, EP_CDC_NOTIFICACAO, 8, EP_CDC_SAIDA, EP_CDC_ENTRADA, 64),
+    TUD_MSC_DESCRIPTOR(ITF_MSC, STR_MSC, EP_MSC_SAIDA, EP_MSC_ENTRADA, 64),
+};
+
+static const char *const TEXTOS[] = {
+    [STR_FABRICANTE] = "FruitLife",
+    [STR_PRODUTO] = "FruitLife Device",
+    [STR_CDC] = "FruitLife Serial",
+    [STR_MSC] = "FruitLife Viagem",
+};
+
+const uint8_t *tud_descriptor_device_cb(void) {
+    return (const uint8_t *)&DISPOSITIVO;
+}
+
+const uint8_t *tud_descriptor_configuration_cb(uint8_t indice) {
+    return CONFIGURACAO;
+}
+
+const uint16_t *tud_descriptor_string_cb(uint8_t indice, uint16_t idioma) {
+    static uint16_t utf16[1 + 32];
+    char serie[2 * PICO_UNIQUE_BOARD_ID_SIZE_BYTES + 1];
+    const char *texto;
+    uint8_t n;
+    if (indice == STR_IDIOMA) {
+        utf16[1] = 0x0409;   // Inglês (EUA): o único que todos os hosts pedem
+        n = 1;
+    } else {
+        if (indice == STR_SERIE) {
+            pico_get_unique_board_id_string(serie, sizeof(serie));
+            texto = serie;
+        } else if (indice < sizeof(TEXTOS) / sizeof(TEXTOS[0]) && TEXTOS[indice]) {
+            texto = TEXTOS[indice];
+        } else {
+            return NULL;
+        }
+        for (n = 0; texto[n] && n < 32; n++)
+            utf16[1 + n] = (uint8_t)texto[n];
+    }
+    utf16[0] = (uint16_t)((TUSB_DESC_STRING << 8) | (2 * n + 2));
+    return utf16;
+}
+
+//===============================================
+// Armazenamento em massa (SCSI) sobre o volume virtual
+//===============================================
+void tud_mount_cb(void) {
+    disco_fat_init(&disco, historico);
+    montado = true;
+}
+
+void tud_umount_cb(void) {
+    montado = false;
+}
+
+void tud_msc_inquiry_cb(uint8_t lun, uint8_t vendor_id[8], uint8_t product_id[16], uint8_t product_rev[4]) {
+    memcpy(vendor_id, "FrtLife ", 8);
+    memcpy(product_id, "Historico CSV   ", 16);
+    memcpy(product_rev, "1.0 ", 4);
+}
+
+bool tud_msc_test_unit_ready_cb(uint8_t lun) {
+    if (!montado) {
+        tud_msc_set_sense(lun, SCSI_SENSE_NOT_READY, 0x3A, 0x00);   // Mídia ausente
+        return false;
+    }
+    return true;
+}
+
+void tud_msc_capacity_cb(uint8_t lun, uint32_t *quantidade, uint16_t *tamanho) {
+    *quantidade = montado ? disco.setores : 0;
+    *tamanho = DISCO_FAT_SETOR;
+}
+
+bool tud_msc_start_stop_cb(uint8_t lun, uint8_t power_condition, bool start, bool load_eject) {
+    // Reinserção da mídia (ex.: após ejetar no host): novo instantâneo
+    if (load_eject && start && montado)
+        disco_fat_congelar(&disco);
+    return true;
+}
+
+int32_t tud_msc_read10_cb(uint8_t lun, uint32_t lba, uint32_t offset, void *buffer, uint32_t bufsize) {
+    // Com CFG_TUD_MSC_EP_BUFSIZE múltiplo do setor, os pedidos vêm alinhados
+    if (!montado || offset != 0 || bufsize % DISCO_FAT_SETOR != 0)
+        return -1;
+    disco_fat_ler(&disco, lba, buffer, bufsize / DISCO_FAT_SETOR);
+    return (int32_t)bufsize;
+}
+
+bool tud_msc_is_writable_cb(uint8_t lun) {
+    return false;
+}
+
+int32_t tud_msc_write10_cb(uint8_t lun, uint32_t lba, uint32_t offset, uint8_t *buffer, uint32_t bufsize) {
+    return -1;
+}
+
+int32_t tud_msc_scsi_cb(uint8_t lun, uint8_t const scsi_cmd[16], void *buffer, uint16_t bufsize) {
+    if (scsi_cmd[0] == SCSI_CMD_PREVENT_ALLOW_MEDIUM_REMOVAL)
+        return 0;
+    tud_msc_set_sense(lun, SCSI_SENSE_ILLEGAL_REQUEST, 0x20, 0x00);   // Comando inválido
+    return -1;
+}
+
+//===============================================
+// Interface
+//===============================================
+void usb_disco_hw_iniciar(const historico_t *h) {
+    historico = h;
+    tusb_init();
+}
+
+void usb_disco_hw_processar(void) {
+    tud_task();
+}
+
+bool usb_disco_hw_pendente(void) {
+    return tud_task_event_ready();
+}
@@ -0,0 +1,18 @@
+#ifndef USB_DISCO_HW_H
+#define USB_DISCO_HW_H
+
+#include <stdbool.h>
+#include "historico.h"
+
+// Volume USB somente leitura com o histórico em CSV (disco_fat.c) mais o
+// CDC do stdio. Há uma única instância, pois as callbacks do TinyUSB são
+// globais. O volume é montado a partir do histórico quando o host
+// configura o dispositivo e refeito a cada ejeção/inserção da mídia.
+// Deve ser iniciado antes de stdio_init_all, que só anexa o stdio ao CDC.
+void usb_disco_hw_iniciar(const historico_t *h);
+// Atende o TinyUSB; chamado a cada volta do laço principal
+void usb_disco_hw_processar(void);
+// Há eventos USB a atender (não dormir)
+bool usb_disco_hw_pendente(void);
+
+#endif
@@ -0,0 +1,66 @@
+#include "zonas.h"
+#include <float.h>
+#include <string.h>
+
+void zona_limites_preencher(zona_limites_t *l, const float inferior[ZONA_NUM_SENSORES],
+                            const float superior[ZONA_NUM_SENSORES]) {
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        for (int z = 0; z < NUM_ZONAS; z++) {
+            l->inferior[s][z] = inferior[s];
+            l->superior[s][z] = superior[s];
+        }
+    }
+}
+
+void zonas_init(zonas_t *z, const zona_estatisticas_t *restaurar) {
+    memset(z, 0, sizeof(*z));
+    if (restaurar) {
+        z->estatisticas = *restaurar;
+        return;
+    }
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        for (int i = 0; i < NUM_ZONAS; i++) {
+            z->estatisticas.minimo[s][i] = FLT_MAX;
+            z->estatisticas.maximo[s][i] = -FLT_MAX;
+        }
+    }
+}
+
+void zonas_processar(zonas_t *z, const zona_limites_t *l, uint8_t num_zonas) {
+    zona_estatisticas_t *e = &z->estatisticas;
+    memset(z->estado, 0, num_zonas * sizeof(z->estado[0]));
+    // Laço externo no sensor: cada vetor é percorrido uma vez, em sequência
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        const float *valor = z->valor[s];
+        const float *inferior = l->inferior[s];
+        const float *superior = l->superior[s];
+        float *soma = e->soma[s];
+        float *minimo = e->minimo[s];
+        float *maximo = e->maximo[s];
+        uint16_t abaixo = (uint16_t)ZONA_ABAIXO(s);
+        uint16_t acima = (uint16_t)ZONA_ACIMA(s);
+        for (int i = 0; i < num_zonas; i++) {
+            float v = valor[i];
+            soma[i] += v;
+            if (v < minimo[i]) minimo[i] = v;
+            if (v > maximo[i]) maximo[i] = v;
+            z->estado[i] |= (v < inferior[i] ? abaixo : 0) | (v > superior[i] ? acima : 0);
+        }
+    }
+    e->amostras++;
+}
+
+float zonas_media(const zonas_t *z, cal_canal_t sensor, uint8_t zona) {
+    if (z->estatisticas.amostras == 0)
+        return z->valor[sensor][zona];
+    return z->estatisticas.soma[sensor][zona] / (float)z->estatisticas.amostras;
+}
+
+uint32_t zonas_em_alarme(const zonas_t *z, uint8_t num_zonas) {
+    uint32_t mascara = 0;
+    for (int i = 0; i < num_zonas; i++) {
+        if (z->estado[i] & ZONA_ALARMES)
+            mascara |= 1u << i;
+    }
+    return mascara;
+}
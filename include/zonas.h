@@ -0,0 +1,61 @@
+#ifndef ZONAS_H
+#define ZONAS_H
+
+#include <stdint.h>
+#include "calibracao.h"   // cal_canal_t também indexa os sensores de cada zona
+
+//===============================================
+// Zonas monitoradas (vários compartimentos do mesmo contêiner)
+//
+// Medidas, setpoints, estatísticas e alarmes ficam em tabelas no formato
+// estrutura-de-vetores, [sensor][zona]: o processamento percorre cada
+// sensor em todas as zonas de uma vez, em acessos sequenciais, e o custo
+// por ciclo cresce linearmente com o número de zonas.
+// NUM_ZONAS é definido na compilação (FRUITLIFE_NUM_ZONAS no CMake).
+//===============================================
+#ifndef NUM_ZONAS
+#define NUM_ZONAS 1
+#endif
+#define ZONAS_MAX 32
+#if NUM_ZONAS < 1 || NUM_ZONAS > ZONAS_MAX
+#error "NUM_ZONAS deve estar entre 1 e ZONAS_MAX"
+#endif
+#define ZONA_NUM_SENSORES CAL_NUM_CANAIS
+
+// Estado por zona: dois bits por sensor (abaixo do inferior, acima do superior)
+#define ZONA_ABAIXO(s) (1u << (2 * (s)))
+#define ZONA_ACIMA(s) (1u << (2 * (s) + 1))
+// Condições que são alarme: etileno alto, temperatura fora da faixa,
+// umidade baixa e CO₂ alto (etileno abaixo do inferior é o estado normal)
+#define ZONA_ALARMES (ZONA_ACIMA(CAL_ETILENO) | ZONA_ABAIXO(CAL_TEMP) | ZONA_ACIMA(CAL_TEMP) | \
+                      ZONA_ABAIXO(CAL_UMIDADE) | ZONA_ACIMA(CAL_CO2))
+
+typedef struct {
+    float inferior[ZONA_NUM_SENSORES][NUM_ZONAS];
+    float superior[ZONA_NUM_SENSORES][NUM_ZONAS];
+} zona_limites_t;
+
+typedef struct {
+    uint32_t amostras;   // Todas as zonas são amostradas juntas
+    float soma[ZONA_NUM_SENSORES][NUM_ZONAS];
+    float minimo[ZONA_NUM_SENSORES][NUM_ZONAS];
+    float maximo[ZONA_NUM_SENSORES][NUM_ZONAS];
+} zona_estatisticas_t;
+
+typedef struct {
+    float valor[ZONA_NUM_SENSORES][NUM_ZONAS];   // Última medida
+    uint16_t estado[NUM_ZONAS];                  // Bits ZONA_ABAIXO/ZONA_ACIMA
+    zona_estatisticas_t estatisticas;
+} zonas_t;
+
+// Mesmos setpoints em todas as zonas
+void zona_limites_preencher(zona_limites_t *l, const float inferior[ZONA_NUM_SENSORES],
+                            const float superior[ZONA_NUM_SENSORES]);
+// Zera as estatísticas, ou parte de um estado salvo
+void zonas_init(zonas_t *z, const zona_estatisticas_t *restaurar);
+// Acumula estatísticas e recalcula o estado das primeiras num_zonas zonas
+void zonas_processar(zonas_t *z, const zona_limites_t *l, uint8_t num_zonas);
+float zonas_media(const zonas_t *z, cal_canal_t sensor, uint8_t zona);
+uint32_t zonas_em_alarme(const zonas_t *z, uint8_t num_zonas);   // Máscara de zonas
+
+#endif
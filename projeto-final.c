@@ -9,9 +9,9 @@
  *
  *    Comportamento:
  *      - No modo normal, o OLED mostra a leitura e a classificação; a matriz WS2812 exibe uma carinha
- *        (triste, neutra ou feliz) de acordo com o nível medido.
- *      - No modo de configuração (quando BUTTON_SET é pressionado), o sistema exibe o dígito atual
- *        (padrão digital) na matriz.
+ *        (feliz, neutra ou triste) na cor da severidade, pulsando em vermelho quando crítica.
+ *      - No modo de configuração (quando BUTTON_SET é pressionado), o valor do setpoint em edição
+ *        rola na matriz.
  *      - Os botões NEXT e BACK aumentam ou diminuem o setpoint do sensor ativo.
  *      - Para temperatura e umidade, o LED indicador (R_LED_PIN) gera um sinal PWM que simula a velocidade
  *        de um motor (por exemplo, para ajustar a refrigeração). Agora, se a temperatura estiver acima do
@@ -28,25 +28,66 @@
  #include "hardware/i2c.h"
  #include "hardware/pwm.h"
  #include "hardware/adc.h"
+ #include "hardware/clocks.h"
  #include "include/ssd1306.h"    // OLED
  #include "include/font.h"       // Fonte OLED
+ #include "include/config.h"     // Setpoints publicados (buffer duplo)
+ #include "include/botoes.h"     // Debounce, repetição e combos dos botões
+ #include "include/eventos.h"    // Fila de eventos de botão
+ #include "include/calibracao.h" // LUTs de calibração por canal
+ #include "include/bench.h"      // Contador de ciclos e benchmarks
+ #include "include/secoes.h"     // FUNCAO_RAPIDA: funções quentes em SRAM
+ #include "include/barramento_i2c.h"     // Fila de transações do i2c1 (OLED + sensores)
+ #include "include/barramento_i2c_hw.h"
+ #include "include/sht3x.h"      // Temperatura/umidade I2C (não bloqueante)
+ #include "include/scd4x.h"      // CO₂ I2C (não bloqueante)
+ #include "include/i2c_simulado.h"       // Substitutos dos sensores em nível de registrador
+ #include "include/tendencia.h"  // Tendência e previsão de cruzamento dos setpoints
+ #include "include/supervisao.h" // Watchdog e motivo do reinício
+ #include "include/persistencia.h"       // Estado preservado em RAM não inicializada
+ #include "include/energia.h"    // Baixo consumo: tela, clock e orçamento de energia
+ #include "include/modbus.h"     // Escravo Modbus RTU (núcleo independente do SDK)
+ #include "include/modbus_hw.h"  // UART0 por IRQ + resposta por DMA
+ #include "include/matriz.h"     // Sprites, animações e gama da matriz WS2812
+ #include "include/matriz_hw.h"  // Quadros por alarme + DMA para a PIO
+ #include "include/controle.h"   // Classificação, alarmes, motor e menu (sem hardware)
+ #include "include/pilha.h"      // Marcas d'água das pilhas dos núcleos e das IRQs
+ #include "include/excursoes.h"  // Grau-minuto e tempo fora da faixa (cadeia do frio)
+ #include "include/historico.h"  // Registros da viagem em anel na flash
+ #include "include/historico_hw.h"
+ #include "include/pinos.h"      // LEDs, buzzers e WS2812 + alocação de PWM/PIO
+ #include "include/recursos.h"   // Conflitos de slice de PWM e máquinas de estados
+ #include "include/tom_hw.h"     // Tons dos buzzers pela PIO1
+ #ifdef FRUITLIFE_USB_MSC
+ #include "include/usb_disco_hw.h"       // Volume USB com o histórico em CSV
+ #endif
+ #include "hardware/structs/systick.h"
  #include "ws2812.pio.h"         // WS2812 via PIO
  #include <stdio.h>
  #include <string.h>
  #include <stdlib.h>
  
- //=================================================
- // Variáveis globais para modo configuração
- //=================================================
- volatile int digito_atual = 0;           // Para exibir dígito (modo configuração)
- volatile bool atualizar_exibicao = false; // Flag para atualizar a matriz (modo configuração)
- 
  //===============================================
  // OLED
  //===============================================
  const uint8_t SDA = 14;
  const uint8_t SCL = 15;
  #define I2C_ADDR 0x3C
+ #define I2C_BAUDRATE (400 * 1000)
+ #define ORCAMENTO_BARRAMENTO_US 2000   // Tempo máximo de barramento por volta do laço
+ 
+ barramento_i2c_t barramento;
+ 
+ //===============================================
+ // Sensores I2C (SHT3x e SCD4x) no mesmo i2c1 do OLED
+ //===============================================
+ #define PERIODO_SHT3X_MS 1000
+ sht3x_t sht3x;
+ scd4x_t scd4x;
+ #ifdef FRUITLIFE_I2C_SIMULADO
+ i2c_simulado_t i2c_sim;
+ i2c_backend_t i2c_backend_real;
+ #endif
  #define SSD1306_WIDTH 128
  #define SSD1306_HEIGHT 64
  
@@ -64,18 +105,9 @@
  #define BUTTON_SET 22   // Entra/saí do modo de configuração
  
  //===============================================
- // Buzzers
- //===============================================
- #define BUZZER1_PIN 10  // Startup/alerta
- #define BUZZER2_PIN 21  // Alertas
- 
- //===============================================
- // LED RGB (PWM)
+ // LED RGB (PWM; pinos em pinos.h)
  //===============================================
- #define R_LED_PIN 13   // Também usado para indicar o "motor" em modos de Temperatura e Umidade
- #define G_LED_PIN 11
- #define B_LED_PIN 12
- #define PWM_WRAP 255
+ #define PWM_WRAP CONTROLE_PWM_MAX
      //===============================================
  // Funções para LED RGB
  //===============================================
@@ -98,145 +130,214 @@
  //===============================================
  // Matriz WS2812
  //===============================================
- #define NUM_PIXELS 25
- #define WS2812_PIN 7
  #define IS_RGBW false
- bool buffer_leds[NUM_PIXELS] = { false };
+ #define MATRIZ_ROTACAO 0               // Quartos de volta, conforme a montagem da placa
+ #define BRILHO_MATRIZ 80
+ #define PERIODO_PULSO_MS 1000          // Severidade crítica
+ #define DURACAO_TRANSICAO_MS 500       // Troca de cor entre severidades
+ #define PASSO_ROLAGEM_MS 150           // Setpoint rolando no modo de configuração
+ matriz_t matriz;
  
  //===============================================
  // Outras definições e variáveis globais
  //===============================================
  #define INTERVALO_PISCA_LED_MS 100  // ms
- const uint32_t DEBOUNCE_DELAY_MS = 200;
- 
- // Menu: 0 = Gás Etileno, 1 = Temperatura, 2 = Umidade, 3 = CO₂, 4 = Médias
- volatile int menu_index = 0;
- volatile uint32_t last_button_interrupt_time = 0;
- volatile bool in_set_mode = false;
- volatile int current_set_param = 0; // 0 = setpoint inferior, 1 = setpoint superior
- 
- // Setpoints para cada sensor
- volatile float etileno_lower = 3.0f;
- volatile float etileno_upper = 7.0f;
- volatile float temp_lower = 10.0f;
- volatile float temp_upper = 15.0f;
- volatile float umidade_set = 90.0f;
- volatile float co2_set = 800.0f;  // Exemplo
- 
- // Cores para a matriz WS2812
- #define COR_WS2812_R 0
- #define COR_WS2812_G 0
- #define COR_WS2812_B 80
+ #define INTERVALO_AMOSTRA_BOTOES_US 5000  // Amostrador dos botões (debounce = 4 amostras)
+ #define INTERVALO_RELATORIO_BENCH_MS 5000  // Relatório por estágio no modo benchmark
+ 
+ // Setpoints e estado do menu ficam em config_t (include/config.h), publicados
+ // pelo laço principal; a IRQ de botões apenas enfileira eventos.
+ volatile uint32_t irq_ciclos_max = 0;      // Pior caso do amostrador de botões (ciclos)
+ 
+ botoes_t botoes;
+ repeating_timer_t timer_botoes;
+ controle_t controle;   // Tendência, alerta precoce e edição em andamento
+ 
+ //-------------------------------------------------
+ // Calibração guiada (SET longo nos menus 0..3)
+ //-------------------------------------------------
+ typedef struct {
+     bool ativa;
+     bool ajuste;              // Ajuste fino (ganho/offset) em vez de nova curva
+     bool encerrar_pendente;   // SET passou da pressão longa; encerra ao soltar
+     cal_canal_t canal;
+     cal_tabela_t tabela;   // Pontos capturados até agora
+     float referencia;      // Valor de referência aplicado ao sensor
+ } calibracao_guiada_t;
+ 
+ calibracao_guiada_t guia;
+ uint16_t adc_atual[CAL_NUM_CANAIS];   // Última leitura bruta de cada canal
+ const float PASSO_CALIBRACAO[CAL_NUM_CANAIS] = { 0.1f, 0.5f, 1.0f, 50.0f };
+ const char *NOME_CANAL[CAL_NUM_CANAIS] = { "Etileno", "Temp", "Umidade", "CO2" };
+ 
+ // Cores da matriz WS2812 (antes da gama e do brilho)
+ static const matriz_cor_t COR_SEVERIDADE[] = {
+     [SEVERIDADE_NORMAL] = { 0, 255, 0 },
+     [SEVERIDADE_ATENCAO] = { 255, 120, 0 },
+     [SEVERIDADE_CRITICA] = { 255, 0, 0 },
+ };
+ static const matriz_cor_t COR_CONFIGURACAO = { 0, 0, 255 };
  
  //-------------------------------------------------
- // Variáveis para cálculo das médias
+ // Zonas: medidas, estatísticas (médias) e estado de alarme
+ //
+ // A zona 0 é o contêiner principal (potenciômetros e sensores I2C). As
+ // demais vêm de um multiplexador analógico externo (FRUITLIFE_MUX_ZONAS):
+ // 4 canais por zona, seleção nos GPIO 16..20 e saída no ADC2 (GPIO 28).
+ // Sem o mux, as zonas extras repetem as leituras brutas da zona 0.
  //-------------------------------------------------
- volatile uint32_t sample_count = 0;
- volatile float sum_etileno = 0.0f;
- volatile float sum_temp = 0.0f;
- volatile float sum_umidade = 0.0f;
- volatile float sum_co2 = 0.0f;
+ #define MUX_PRIMEIRO_PINO_SELECAO 16
+ #define MUX_BITS_SELECAO 5
+ #define MUX_ADC_PIN 28
+ #define MUX_ACOMODACAO_US 5            // Tempo de acomodação após trocar o canal
+ #ifdef FRUITLIFE_MUX_ZONAS
+ _Static_assert((NUM_ZONAS - 1) * ZONA_NUM_SENSORES <= (1 << MUX_BITS_SELECAO),
+                "O multiplexador atende no máximo 8 zonas extras");
+ #endif
+ zonas_t zonas;
+ excursoes_t excursoes;   // Acumuladores da cadeia do frio por sensor e zona
  absolute_time_t start_time;
+ uint64_t tempo_viagem_base_us = 0;   // Tempo de viagem acumulado antes deste boot
+ 
+ //-------------------------------------------------
+ // Reinício a quente: estado preservado e diagnóstico
+ //-------------------------------------------------
+ #define INTERVALO_SALVAR_ESTADO_MS 1000
+ motivo_reinicio_t motivo_reinicio;
+ estado_persistente_t persistente;
+ 
+ //-------------------------------------------------
+ // Histórico da viagem na flash (HISTORICO_KB no fim da flash): com
+ // 512 KB e uma zona, cerca de 11 dias a um registro por minuto
+ //-------------------------------------------------
+ #define INTERVALO_HISTORICO_S 60       // Um registro por zona a cada minuto de viagem
+ historico_t historico;
+ uint32_t proximo_historico_s = 0;
+ 
+ //-------------------------------------------------
+ // Modo de baixo consumo (bateria nos contêineres)
+ //-------------------------------------------------
+ #define TEMPO_ESCURECER_MS 30000       // Inatividade até reduzir o brilho
+ #define TEMPO_APAGAR_MS 120000         // Inatividade até apagar OLED e matriz
+ #define PERIODO_AMOSTRA_ATIVA_MS 50
+ #define PERIODO_AMOSTRA_ESCURECIDA_MS 250
+ #define PERIODO_AMOSTRA_APAGADA_MS 1000
+ #define CLOCK_PLENO_KHZ 125000
+ #define CLOCK_REDUZIDO_KHZ 48000       // clk_sys entre as amostras e com a tela apagada
+ #define ESPERA_MINIMA_CLOCK_US 2000    // Esperas mais curtas não pagam as duas trocas do PLL
+ #define CONTRASTE_PLENO 0xFF
+ #define CONTRASTE_ESCURECIDO 0x10
+ #define ESCURECIMENTO_MATRIZ 4         // Divide as cores da matriz com a tela escurecida
+ energia_t energia;
+ uint32_t clock_atual_khz = CLOCK_PLENO_KHZ;
+ uint32_t clock_trabalho_khz = CLOCK_PLENO_KHZ;   // clk_sys ao processar as amostras (depende da tela)
+ 
+ //-------------------------------------------------
+ // Escravo Modbus RTU na UART0 (GPIO 0 = TX, GPIO 1 = RX), 19200 8E1
+ //
+ // Registradores de entrada (função 04), valores inteiros escalados:
+ //   0..3  etileno (x100 ppm), temperatura (x10 °C, com sinal),
+ //         umidade (x10 %), CO₂ (ppm) - leitura atual
+ //   4..7  mesmas grandezas, médias desde o início da viagem
+ //   8     bits de alarme (ALARME_*)
+ //   9     tempo de viagem (min)       10  reinícios a quente
+ //   11    quadros Modbus atendidos    12  erros de CRC
+ //   100 + 16*z + k      registrador k (0..8) da zona z; a zona 0 repete 0..8
+ // Registradores de retenção (funções 03, 06 e 16), 8*z + k para a zona z:
+ //   k=0 etileno_lower (x100)  k=1 etileno_upper (x100)
+ //   k=2 temp_lower (x10)      k=3 temp_upper (x10)
+ //   k=4 umidade_set (x10)     k=5 co2_set (ppm)
+ //-------------------------------------------------
+ #define MODBUS_UART uart0
+ #define MODBUS_TX_PIN 0
+ #define MODBUS_RX_PIN 1
+ #define MODBUS_BAUD 19200
+ #define MODBUS_ENDERECO 1
+ 
+ enum {
+     REG_MEDIDA = 0,          // + sensor (ordem de cal_canal_t)
+     REG_MEDIA = 4,           // + sensor
+     REG_ALARMES = 8,
+     REG_TEMPO_VIAGEM_MIN, REG_REINICIOS, REG_QUADROS_MODBUS, REG_ERROS_CRC,
+     NUM_REGS_ENTRADA
+ };
+ #define REG_ZONAS_BASE 100
+ #define REGS_POR_ZONA_ENTRADA 16
+ #define REGS_ZONA_ENTRADA 9      // Medidas, médias e alarmes
+ enum {
+     REG_ETILENO_LOWER = 0, REG_ETILENO_UPPER, REG_TEMP_LOWER, REG_TEMP_UPPER,
+     REG_UMIDADE_SET, REG_CO2_SET,
+     NUM_REGS_RETENCAO
+ };
+ #define REGS_POR_ZONA_RETENCAO 8
+ #define ALARME_ETILENO_AMADURECENDO (1u << 0)   // etileno >= etileno_lower
+ #define ALARME_ETILENO_APODRECENDO  (1u << 1)   // etileno >= etileno_upper
+ #define ALARME_TEMP_BAIXA           (1u << 2)
+ #define ALARME_TEMP_ALTA            (1u << 3)
+ #define ALARME_UMIDADE_BAIXA        (1u << 4)
+ #define ALARME_CO2_ALTO             (1u << 5)
+ #define ALARME_PRECOCE              (1u << 6)   // Tendência cruza um setpoint em breve
+ 
+ modbus_t modbus;
+ bool modbus_alterou_config = false;
  
  
   
  //===============================================
- // Padrões de carinhas (5x5) – Modo normal
- // Índice 0: Neutra, 1: Feliz, 2: Triste
+ // Carinhas (5x5) – Modo normal, uma por severidade
  //===============================================
- const bool padroes_carinhas[3][5][5] = {
-     
-     { // Carinha Feliz
-       {false, true, true, true, false},
-       {false, true, false, true, false},
-       {false, false, false, false, false},
-       {false, true, false, true, false},
-       {false, true, false, true, false}
-     },
-     { // Carinha Triste
-       {false, true, false, true, false},
-       {false, true, true, true, false},
-       {false, false, false, false, false},
-       {false, true, false, true, false},
-       {false, true, false, true, false}
-    }
-
-    
-     
-};
-   
-
-   
- //===============================================
- // Função para atualizar o buffer com uma carinha (modo normal)
- //===============================================
- void atualizar_buffer_com_carinha(int tipo) {
-     // tipo: 0 = neutra, 1 = feliz, 2 = triste
-     for (int linha = 0; linha < 5; linha++) {
-         for (int coluna = 0; coluna < 5; coluna++) {
-             int indice = linha * 5 + coluna;
-             buffer_leds[indice] = padroes_carinhas[tipo][linha][coluna];
-         }
-     }
- }
-   
- //===============================================
- // Funções auxiliares para os WS2812
+ static const matriz_sprite_t CARINHAS[] = {
+     [SEVERIDADE_NORMAL] = MATRIZ_SPRITE(0b01010,
+                                         0b01010,
+                                         0b00000,
+                                         0b10001,
+                                         0b01110),
+     [SEVERIDADE_ATENCAO] = MATRIZ_SPRITE(0b01010,
+                                          0b01010,
+                                          0b00000,
+                                          0b00000,
+                                          0b11111),
+     [SEVERIDADE_CRITICA] = MATRIZ_SPRITE(0b01010,
+                                          0b01010,
+                                          0b00000,
+                                          0b01110,
+                                          0b10001),
+ };
+ 
+ // Fruta exibida na partida: 1 = casca, 2 = folha, 3 = brilho
+ static const matriz_sprite_paleta_t ICONE_FRUTA = MATRIZ_SPRITE_PALETA(
+     MATRIZ_LINHA_PALETA(0, 0, 2, 2, 0),
+     MATRIZ_LINHA_PALETA(0, 1, 1, 1, 0),
+     MATRIZ_LINHA_PALETA(1, 3, 1, 1, 1),
+     MATRIZ_LINHA_PALETA(1, 1, 1, 1, 1),
+     MATRIZ_LINHA_PALETA(0, 1, 1, 1, 0));
+ static const matriz_cor_t PALETA_FRUTA[MATRIZ_CORES_PALETA] = {
+     { 0, 0, 0 }, { 255, 0, 0 }, { 0, 255, 0 }, { 255, 255, 255 },
+ };
+ 
  //===============================================
- static inline void enviar_pixel(uint32_t pixel_grb) {
-     pio_sm_put_blocking(pio0, 0, pixel_grb << 8u);
- }
-   
- static inline uint32_t urgb_u32(uint8_t r, uint8_t g, uint8_t b) {
-     return ((uint32_t)r << 8) | ((uint32_t)g << 16) | (uint32_t)b;
- }
-   
- void definir_leds(uint8_t r, uint8_t g, uint8_t b) {
-     uint32_t cor = urgb_u32(r, g, b);
-     for (int i = 0; i < NUM_PIXELS; i++) {
-         if (buffer_leds[i])
-             enviar_pixel(cor);
-         else
-             enviar_pixel(0);
-     }
-     sleep_us(60);
- }
-   
+ // Carinha da severidade: crítica pulsa, as demais fazem a transição de cor
  //===============================================
- // Função para gerar um tom no buzzer (bloqueante)
- //===============================================
- void play_tone(uint gpio, int frequency, int duration_ms) {
-     uint slice_num = pwm_gpio_to_slice_num(gpio);
-     uint channel = pwm_gpio_to_channel(gpio);
-     gpio_set_function(gpio, GPIO_FUNC_PWM);
-     float divider = 1.0f;
-     uint32_t wrap = (uint32_t)((125000000.0f / (divider * frequency)) - 1);
-     pwm_set_clkdiv(slice_num, divider);
-     pwm_set_wrap(slice_num, wrap);
-     pwm_set_chan_level(slice_num, channel, (wrap + 1) / 2);
-     pwm_set_enabled(slice_num, true);
-     sleep_ms(duration_ms);
-     pwm_set_enabled(slice_num, false);
-     gpio_set_function(gpio, GPIO_FUNC_SIO);
-     gpio_set_dir(gpio, GPIO_OUT);
-     gpio_put(gpio, 0);
+ void mostrar_severidade(severidade_t severidade, uint32_t agora_ms) {
+     if (severidade == SEVERIDADE_CRITICA)
+         matriz_pulsar(&matriz, CARINHAS[severidade], COR_SEVERIDADE[severidade], PERIODO_PULSO_MS, agora_ms);
+     else
+         matriz_transicao(&matriz, CARINHAS[severidade], COR_SEVERIDADE[severidade], DURACAO_TRANSICAO_MS, agora_ms);
  }
    
  //===============================================
- // Função para reproduzir uma musiquinha no startup
+ // Musiquinha do startup: tabela na SRAM, tocada pela PIO via DMA. O DMA
+ // não para quando o histórico apaga ou programa a flash, e a XIP fica
+ // inacessível nesse tempo; uma tabela na flash daria leituras inválidas.
  //===============================================
+ static const tom_pedido_t __not_in_flash("melodia") MELODIA_INICIO[] = {
+     TOM_NOTA(261, 200), TOM_PAUSA(50), TOM_NOTA(293, 200), TOM_PAUSA(50), TOM_NOTA(329, 200), TOM_PAUSA(50),
+     TOM_NOTA(392, 200), TOM_PAUSA(50), TOM_NOTA(329, 200), TOM_PAUSA(50), TOM_NOTA(261, 200),
+ };
+ 
  void play_startup_music() {
-     struct {
-         int frequency;
-         int duration;
-     } notes[] = {
-         {261, 200}, {293, 200}, {329, 200}, {392, 200}, {329, 200}, {261, 200}
-     };
-     int note_count = sizeof(notes) / sizeof(notes[0]);
-     for (int i = 0; i < note_count; i++) {
-          play_tone(BUZZER1_PIN, notes[i].frequency, notes[i].duration);
-          sleep_ms(50);
-     }
+     if (tom_hw_sequencia(BUZZER_INICIO, MELODIA_INICIO, sizeof(MELODIA_INICIO) / sizeof(MELODIA_INICIO[0])))
+         energia_definir(&energia, ENERGIA_BUZZER, ENERGIA_PLENO, time_us_64());
  }
    
  //===============================================
@@ -245,20 +346,21 @@
  void splash_screen(ssd1306_t *ssd) {
      ssd1306_fill(ssd, 0);
      const char *texto = "FruitLife";
-     int char_width = 6, char_height = 8;
+     int char_width = 8, char_height = 8;   // Glifos 8x8 da font.h
      int texto_largura = strlen(texto) * char_width;
      int center_x = SSD1306_WIDTH / 2, center_y = SSD1306_HEIGHT / 2;
      int pos_x = center_x - 32;
      int baseline = (center_y + char_height) / 2;
      int margin = 3;
-     int rect_width = texto_largura + margin * 12;
+     // Moldura piscando em volta do nome
+     int rect_width = texto_largura + margin * 2;
      int rect_height = char_height + margin * 2;
-     int rect_x = center_x + 16, rect_y = center_y - 10;
+     int rect_x = pos_x - margin, rect_y = baseline - margin;
      for (int i = 0; i < 8; i++) {
           ssd1306_fill(ssd, 0);
           ssd1306_draw_string(ssd, texto, pos_x, baseline);
           if (i % 2 == 0) {
-              ssd1306_rect(ssd, rect_x, rect_y, rect_width, rect_height, true, false);
+              ssd1306_rect(ssd, rect_y, rect_x, rect_width, rect_height, true, false);
           }
           ssd1306_send_data(ssd);
           sleep_ms(500);
@@ -267,167 +369,249 @@
  }
    
  //===============================================
- // Callback para os botões (debounce e modo setpoint)
+ // Saída do motor de entrada: eventos vão para a fila do laço principal
  //===============================================
- void button_callback(uint gpio, uint32_t events) {
-     uint32_t current_time = to_ms_since_boot(get_absolute_time());
-     if (current_time - last_button_interrupt_time < DEBOUNCE_DELAY_MS) return;
-     last_button_interrupt_time = current_time;
-     
-     if ((gpio == BUTTON_SET) && (events & GPIO_IRQ_EDGE_FALL)) {
-         if (!in_set_mode) {
-             in_set_mode = true;
-             current_set_param = 0;
-         } else {
-             if (menu_index == 0 || menu_index == 1) {
-                 if (current_set_param == 0)
-                     current_set_param = 1;
-                 else
-                     in_set_mode = false;
-             } else {
-                 in_set_mode = false;
-             }
-         }
+ void FUNCAO_RAPIDA(publicar_evento_botao)(const evento_botao_t *ev) {
+     eventos_publicar(ev);
+ }
+   
+ //===============================================
+ // Amostrador periódico dos botões (IRQ de alarme)
+ //===============================================
+ bool FUNCAO_RAPIDA(amostrar_botoes_callback)(repeating_timer_t *t) {
+     // A medição inclui a amostragem da pilha: o pior caso é o real
+     uint32_t inicio = systick_hw->cvr;
+     uint32_t *sp = pilha_irq_entrar();
+     uint32_t soltos = gpio_get_all();  // Botões com pull-up: nível baixo = pressionado
+     uint8_t pressionados = (uint8_t)((((~soltos >> BUTTON_NEXT) & 1u) << BOTAO_IDX_NEXT) |
+                                      (((~soltos >> BUTTON_BACK) & 1u) << BOTAO_IDX_BACK) |
+                                      (((~soltos >> BUTTON_SET) & 1u) << BOTAO_IDX_SET));
+     botoes_amostrar(&botoes, pressionados, to_ms_since_boot(get_absolute_time()));
+     pilha_irq_sair(sp);
+     uint32_t ciclos = (inicio - systick_hw->cvr) & 0x00FFFFFFu;  // SysTick é decrescente, 24 bits
+     if (ciclos > irq_ciclos_max)
+         irq_ciclos_max = ciclos;
+     supervisao_check_in(TAREFA_BOTOES);
+     return true;
+ }
+   
+ //===============================================
+ // Calibração guiada: captura de pontos com NEXT/BACK/SET
+ //===============================================
+ void iniciar_calibracao(cal_canal_t canal) {
+     guia.ativa = true;
+     guia.ajuste = false;
+     guia.encerrar_pendente = false;
+     guia.canal = canal;
+     guia.tabela.num_pontos = 0;
+     guia.tabela.ganho = 1.0f;
+     guia.tabela.offset = 0.0f;
+     guia.referencia = calibracao_converter(canal, adc_atual[canal]);
+ }
+   
+ // Insere o ponto mantendo a ordem por ADC; mesmo ADC substitui o valor
+ void capturar_ponto_calibracao(void) {
+     cal_tabela_t *t = &guia.tabela;
+     uint16_t adc = adc_atual[guia.canal];
+     int i = 0;
+     while (i < t->num_pontos && t->pontos[i].adc < adc)
+         i++;
+     if (i < t->num_pontos && t->pontos[i].adc == adc) {
+         t->pontos[i].valor = guia.referencia;
          return;
      }
-     
-     if (in_set_mode) {
-         if ((gpio == BUTTON_NEXT) && (events & GPIO_IRQ_EDGE_FALL)) {
-             if (menu_index == 0) {
-                 if (current_set_param == 0)
-                     etileno_lower += 0.1f;
-                 else
-                     etileno_upper += 0.1f;
-             } else if (menu_index == 1) {
-                 if (current_set_param == 0)
-                     temp_lower += 0.5f;
-                 else
-                     temp_upper += 0.5f;
-             } else if (menu_index == 2) {
-                 umidade_set += 1.0f;
-             } else if (menu_index == 3) {
-                 co2_set += 50.0f;
-             }
-             return;
-         }
-         if ((gpio == BUTTON_BACK) && (events & GPIO_IRQ_EDGE_FALL)) {
-             if (menu_index == 0) {
-                 if (current_set_param == 0)
-                     etileno_lower -= 0.1f;
-                 else
-                     etileno_upper -= 0.1f;
-             } else if (menu_index == 1) {
-                 if (current_set_param == 0)
-                     temp_lower -= 0.5f;
-                 else
-                     temp_upper -= 0.5f;
-             } else if (menu_index == 2) {
-                 umidade_set -= 1.0f;
-             } else if (menu_index == 3) {
-                 co2_set -= 50.0f;
-             }
-             return;
-         }
-         
-         if ((gpio == BUTTON_NEXT) && (events & GPIO_IRQ_EDGE_FALL)) {
-             menu_index = (menu_index + 1) % 5;
-             return;
-         }
-         if ((gpio == BUTTON_BACK) && (events & GPIO_IRQ_EDGE_FALL)) {
-             menu_index = (menu_index + 4) % 5;
-             return;
-         }
-     } else {
-         if ((gpio == BUTTON_NEXT) && (events & GPIO_IRQ_EDGE_FALL)) {
-             menu_index = (menu_index + 1) % 5;
-             return;
-         }
-         if ((gpio == BUTTON_BACK) && (events & GPIO_IRQ_EDGE_FALL)) {
-             menu_index = (menu_index + 4) % 5;
-             return;
+     if (t->num_pontos >= (guia.ajuste ? 2 : CAL_MAX_PONTOS))
+         return;
+     for (int j = t->num_pontos; j > i; j--)
+         t->pontos[j] = t->pontos[j - 1];
+     t->pontos[i].adc = adc;
+     t->pontos[i].valor = guia.referencia;
+     t->num_pontos++;
+ }
+   
+ // Encerra a calibração guiada aplicando o que foi capturado
+ void encerrar_calibracao(void) {
+     if (guia.ajuste) {
+         // 1 ponto corrige o offset, 2 pontos ganho e offset, sobre a curva carregada
+         if (guia.tabela.num_pontos >= 1)
+             calibracao_ajustar(guia.canal, guia.tabela.pontos, guia.tabela.num_pontos);
+     } else if (guia.tabela.num_pontos >= 2) {
+         // Nova curva, sem ajuste; com menos de 2 pontos (ou pontos
+         // inválidos) mantém a tabela anterior
+         calibracao_carregar(guia.canal, &guia.tabela);
+     }
+     guia.ativa = false;
+ }
+   
+ void aplicar_evento_calibracao(const evento_botao_t *ev) {
+     if (ev->tipo == BOTAO_EV_COMBO) {
+         uint8_t cancelar = BOTAO_BIT(BOTAO_IDX_NEXT) | BOTAO_BIT(BOTAO_IDX_BACK);
+         if ((ev->mascara & cancelar) == cancelar) {
+             guia.ativa = false;   // Cancela: a tabela anterior continua carregada
+         } else if ((ev->mascara & BOTAO_BIT(BOTAO_IDX_SET)) && ev->botao != BOTAO_IDX_SET) {
+             // SET segurado + NEXT/BACK alterna entre nova curva e ajuste
+             // fino; os pontos capturados no outro modo são descartados
+             guia.ajuste = !guia.ajuste;
+             guia.encerrar_pendente = false;
+             guia.tabela.num_pontos = 0;
          }
+         return;
+     }
+     if (ev->botao == BOTAO_IDX_SET) {
+         // Como no menu, a pressão longa só arma o encerramento: ele ocorre
+         // ao soltar SET, se NEXT/BACK não foram tocados no meio (troca de modo)
+         if (ev->tipo == BOTAO_EV_PRESSIONADO)
+             guia.encerrar_pendente = false;
+         else if (ev->tipo == BOTAO_EV_CLIQUE)
+             capturar_ponto_calibracao();
+         else if (ev->tipo == BOTAO_EV_LONGO)
+             guia.encerrar_pendente = true;
+         else if (ev->tipo == BOTAO_EV_SOLTO && guia.encerrar_pendente)
+             encerrar_calibracao();
+         return;
      }
+     float sinal = (ev->botao == BOTAO_IDX_NEXT) ? 1.0f : -1.0f;
+     if (ev->tipo == BOTAO_EV_PRESSIONADO)
+         guia.referencia += sinal * PASSO_CALIBRACAO[guia.canal];
+     else if (ev->tipo == BOTAO_EV_REPETICAO)
+         guia.referencia += sinal * PASSO_CALIBRACAO[guia.canal] * (ev->repeticoes >= 20 ? 10.0f : 1.0f);
  }
    
  //===============================================
- // Callback para parar o tom (não bloqueante)
+ // Aplica um evento de botão: calibração guiada em andamento ou menu
  //===============================================
- int64_t stop_tone_callback(alarm_id_t id, void *user_data) {
-     uint gpio = *(uint*)user_data;
-     uint slice_num = pwm_gpio_to_slice_num(gpio);
-     pwm_set_enabled(slice_num, false);
-     gpio_set_function(gpio, GPIO_FUNC_SIO);
-     gpio_set_dir(gpio, GPIO_OUT);
-     gpio_put(gpio, 0);
-     free(user_data);
-     return 0;
+ void aplicar_evento_botao(config_t *cfg, const evento_botao_t *ev) {
+     if (guia.ativa)
+         aplicar_evento_calibracao(ev);
+     else if (controle_aplicar_evento(&controle, cfg, ev) == CONTROLE_INICIAR_CALIBRACAO)
+         iniciar_calibracao((cal_canal_t)cfg->menu_index);
  }
    
  //===============================================
- // Função auxiliar: inicia um tom de forma não bloqueante
- //===============================================
- void play_tone_non_blocking(uint gpio, int frequency, int duration_ms) {
-     uint slice_num = pwm_gpio_to_slice_num(gpio);
-     uint channel = pwm_gpio_to_channel(gpio);
-     gpio_set_function(gpio, GPIO_FUNC_PWM);
-     float divider = 1.0f;
-     uint32_t wrap = (uint32_t)((125000000.0f / (divider * frequency)) - 1);
-     pwm_set_clkdiv(slice_num, divider);
-     pwm_set_wrap(slice_num, wrap);
-     pwm_set_chan_level(slice_num, channel, (wrap + 1) / 2);
-     pwm_set_enabled(slice_num, true);
-     uint *gpio_ptr = malloc(sizeof(uint));
-     *gpio_ptr = gpio;
-     add_alarm_in_ms(duration_ms, stop_tone_callback, gpio_ptr, false);
+ // Drena a fila de eventos e publica a nova configuração, se mudou.
+ // Qualquer botão conta como atividade e acorda a tela.
+ //===============================================
+ bool processar_eventos_botoes(config_t *cfg) {
+     evento_botao_t ev;
+     bool alterou = false;
+     while (eventos_retirar(&ev)) {
+         aplicar_evento_botao(cfg, &ev);
+         alterou = true;
+     }
+     if (alterou) {
+         config_publicar(cfg);
+         energia_atividade(&energia, time_us_64());
+     }
+     return alterou;
+ }
+   
+ //===============================================
+ // Função auxiliar: enfileira um tom na PIO (não bloqueante; a própria
+ // máquina de estados encerra a nota)
+ //===============================================
+ void play_tone_non_blocking(uint buzzer, uint32_t frequency, uint32_t duration_ms) {
+     if (tom_hw_tocar(buzzer, frequency, duration_ms))
+         energia_definir(&energia, ENERGIA_BUZZER, ENERGIA_PLENO, time_us_64());
  }
    
  //===============================================
  // Função beep não bloqueante (usa BUZZER2)
  //===============================================
  void beep() {
-     play_tone_non_blocking(BUZZER2_PIN, 392, 200);
+     energia_atividade(&energia, time_us_64());   // Alarme acorda a tela
+     play_tone_non_blocking(BUZZER_ALERTA, 392, 200);
+ }
+   
+ //===============================================
+ // Beep curto e mais agudo do alerta precoce (tendência)
+ //===============================================
+ void beep_alerta_precoce() {
+     energia_atividade(&energia, time_us_64());
+     play_tone_non_blocking(BUZZER_ALERTA, 523, 100);
+ }
+   
+ //===============================================
+ // Linha de previsão: setpoint que a tendência vai cruzar e em quanto tempo
+ //===============================================
+ void formatar_previsao(char *linha, const char *prefixo, const tendencia_t *t, float lower, float upper) {
+     float limite, segundos, atual, inclinacao;
+     const char *marca = controle.alerta_precoce ? "!" : "";
+     if (controle_prever_cruzamento(t, lower, upper, &limite, &segundos) && tendencia_valor_atual(t, &atual)) {
+         unsigned long minutos = (unsigned long)(segundos / 60.0f + 0.5f);
+         char sentido = (limite > atual) ? '>' : '<';
+         if (minutos < 1000)
+             sprintf(linha, "%s%s%c%.1f %lum", marca, prefixo, sentido, limite, minutos);
+         else
+             sprintf(linha, "%s%s%c%.1f %luh", marca, prefixo, sentido, limite, minutos / 60);
+     } else if (tendencia_inclinacao(t, &inclinacao)) {
+         sprintf(linha, "%sTend %+.2f/min", marca, inclinacao * 60.0f);
+     } else {
+         sprintf(linha, "Tend: --");
+     }
  }
    
  //===============================================
  // Função para atualizar o display OLED (modo normal e de setpoint)
  //===============================================
- void update_display(ssd1306_t *ssd, float value, const char *unit, const char *status, const char *sensor_name) {
+ void update_display(ssd1306_t *ssd, const config_t *cfg, float value, const char *unit, const char *status, const char *sensor_name, const char *previsao) {
      char line1[32], line2[32], line3[32];
-     if (in_set_mode) {
-         if (menu_index == 0) {
-             if (current_set_param == 0)
+     if (cfg->in_set_mode) {
+         if (cfg->menu_index == 0) {
+             if (cfg->current_set_param == 0)
                  sprintf(line1, "Set Etileno LOW");
              else
                  sprintf(line1, "Set Etileno HIGH");
-             sprintf(line2, "Valor: %.2f ppm", (current_set_param == 0 ? etileno_lower : etileno_upper));
-         } else if (menu_index == 1) {
-             if (current_set_param == 0)
+             sprintf(line2, "Valor: %.2f ppm", controle_setpoint_em_edicao(cfg));
+         } else if (cfg->menu_index == 1) {
+             if (cfg->current_set_param == 0)
                  sprintf(line1, "Set Temp LOW");
              else
                  sprintf(line1, "Set Temp HIGH");
-             sprintf(line2, "Valor: %.2f C", (current_set_param == 0 ? temp_lower : temp_upper));
-         } else if (menu_index == 2) {
+             sprintf(line2, "Valor: %.2f C", controle_setpoint_em_edicao(cfg));
+         } else if (cfg->menu_index == 2) {
              sprintf(line1, "Set Umidade");
-             sprintf(line2, "Valor: %.2f %%", umidade_set);
-         } else if (menu_index == 3) {
-             if (current_set_param == 0)
+             sprintf(line2, "Valor: %.2f %%", controle_setpoint_em_edicao(cfg));
+         } else if (cfg->menu_index == 3) {
+             if (cfg->current_set_param == 0)
                  sprintf(line1, "Set CO2 BAIXO");
              else
                  sprintf(line1, "Set CO2 ALTO");
-             sprintf(line2, "Valor: %.2f ppm", (current_set_param == 0 ? 400.0f : co2_set));
+             sprintf(line2, "Valor: %.2f ppm", controle_setpoint_em_edicao(cfg));
          }
          sprintf(line3, "Pressione SET para salvar");
      } else {
-         sprintf(line1, "%s", sensor_name);
+         if (NUM_ZONAS > 1)
+             sprintf(line1, "%s Z%d", sensor_name, cfg->zona_atual + 1);
+         else
+             sprintf(line1, "%s", sensor_name);
          sprintf(line2, "Valor: %.2f %s", value, unit);
          sprintf(line3, "Status: %s", status);
      }
      
+     ssd1306_fill(ssd, 0);
+     ssd1306_draw_string(ssd, line1, 0, 0);
+     if (!cfg->in_set_mode && previsao)
+         ssd1306_draw_string(ssd, previsao, 0, 10);
+     ssd1306_draw_string(ssd, line2, 0, 20);
+     ssd1306_draw_string(ssd, line3, 0, 40);
+     ssd1306_send_data_async(ssd, &barramento);
+ }
+   
+ //===============================================
+ // Função para atualizar o display OLED na calibração guiada
+ //===============================================
+ void update_display_calibracao(ssd1306_t *ssd) {
+     char line1[32], line2[32], line3[32], line4[32];
+     sprintf(line1, "%s %s P%d", guia.ajuste ? "AJ" : "CAL", NOME_CANAL[guia.canal], guia.tabela.num_pontos + 1);
+     sprintf(line2, "Ref: %.2f", guia.referencia);
+     sprintf(line3, "ADC: %u", adc_atual[guia.canal]);
+     sprintf(line4, "SET ok Longo fim");
      ssd1306_fill(ssd, 0);
      ssd1306_draw_string(ssd, line1, 0, 0);
      ssd1306_draw_string(ssd, line2, 0, 20);
      ssd1306_draw_string(ssd, line3, 0, 40);
-     ssd1306_send_data(ssd);
+     ssd1306_draw_string(ssd, line4, 0, 48);
+     ssd1306_send_data_async(ssd, &barramento);
  }
    
  //===============================================
@@ -442,17 +626,363 @@
      ssd1306_draw_string(ssd, line1, 0, 0);
      ssd1306_draw_string(ssd, line2, 0, 20);
      ssd1306_draw_string(ssd, line3, 0, 40);
-     ssd1306_send_data(ssd);
+     ssd1306_send_data_async(ssd, &barramento);
  }
    
+ //===============================================
+ // Função para atualizar o display OLED no modo Diagnóstico
+ //===============================================
+ void update_display_diagnostico(ssd1306_t *ssd) {
+     char line1[32], line2[32], line3[32], line4[32], line5[32];
+     sprintf(line1, "Reset:%s", supervisao_nome_motivo(motivo_reinicio));
+     sprintf(line2, "Reinicios:%lu", (unsigned long)persistente.reinicios);
+     sprintf(line3, "IRQ:%lu Lat:%lums", (unsigned long)irq_ciclos_max, (unsigned long)botoes.latencia_max_ms);
+     uint32_t corrente_ua = energia_corrente_media_ua(&energia);
+     sprintf(line4, "I2C:%lu %lu.%lumA", (unsigned long)barramento.erros,
+             (unsigned long)(corrente_ua / 1000), (unsigned long)(corrente_ua % 1000 / 100));
+     // Pico de uso das pilhas em bytes: núcleo 0, núcleo 1 e maior rotina de IRQ
+     pilha_uso_t pilha;
+     pilha_medir(&pilha);
+     sprintf(line5, "Pil:%lu/%lu I:%lu", (unsigned long)pilha.pico[0], (unsigned long)pilha.pico[1],
+             (unsigned long)pilha.irq);
+     ssd1306_fill(ssd, 0);
+     ssd1306_draw_string(ssd, "DIAGNOSTICO", 0, 0);
+     ssd1306_draw_string(ssd, line1, 0, 10);
+     ssd1306_draw_string(ssd, line2, 0, 20);
+     ssd1306_draw_string(ssd, line3, 0, 30);
+     ssd1306_draw_string(ssd, line4, 0, 40);
+     ssd1306_draw_string(ssd, line5, 0, 50);
+     ssd1306_send_data_async(ssd, &barramento);
+ }
+   
+ //===============================================
+ // Resumo das excursões da zona exibida: tempo fora, quantidade e pico
+ //===============================================
+ // Minutos até 99, depois horas
+ void formatar_duracao(char *s, uint64_t ms) {
+     uint64_t minutos = ms / 60000u;
+     if (minutos < 100)
+         sprintf(s, "%lum", (unsigned long)minutos);
+     else
+         sprintf(s, "%luh", (unsigned long)(minutos / 60u));
+ }
+ 
+ void update_display_excursoes(ssd1306_t *ssd, uint8_t zona) {
+     char titulo[32], line1[32], line2[32], line3[32], line4[32], line5[32];
+     char fora[8], maior[8];
+     if (NUM_ZONAS > 1)
+         sprintf(titulo, "EXCURSOES Z%d", zona + 1);
+     else
+         sprintf(titulo, "EXCURSOES");
+     // Temperatura: grau-minuto, quantidade, mais longa e pico
+     sprintf(line1, "T %.0fCm n%u", excursoes_unidade_minuto(&excursoes, CAL_TEMP, zona),
+             excursoes.contagem[CAL_TEMP][zona]);
+     formatar_duracao(maior, excursoes.maior_ms[CAL_TEMP][zona]);
+     sprintf(line2, "T max%s P%.1f", maior, excursoes.pico[CAL_TEMP][zona]);
+     // Demais sensores: tempo fora da faixa, quantidade e pico
+     formatar_duracao(fora, excursoes.tempo_fora_ms[CAL_ETILENO][zona]);
+     sprintf(line3, "Et %s n%u P%.1f", fora, excursoes.contagem[CAL_ETILENO][zona], excursoes.pico[CAL_ETILENO][zona]);
+     formatar_duracao(fora, excursoes.tempo_fora_ms[CAL_CO2][zona]);
+     sprintf(line4, "CO2 %s n%u P%.0f", fora, excursoes.contagem[CAL_CO2][zona], excursoes.pico[CAL_CO2][zona]);
+     formatar_duracao(fora, excursoes.tempo_fora_ms[CAL_UMIDADE][zona]);
+     sprintf(line5, "Um %s n%u P%.0f", fora, excursoes.contagem[CAL_UMIDADE][zona], excursoes.pico[CAL_UMIDADE][zona]);
+     ssd1306_fill(ssd, 0);
+     ssd1306_draw_string(ssd, titulo, 0, 0);
+     ssd1306_draw_string(ssd, line1, 0, 10);
+     ssd1306_draw_string(ssd, line2, 0, 20);
+     ssd1306_draw_string(ssd, line3, 0, 30);
+     ssd1306_draw_string(ssd, line4, 0, 40);
+     ssd1306_draw_string(ssd, line5, 0, 50);
+     ssd1306_send_data_async(ssd, &barramento);
+ }
+   
+ //===============================================
+ // Registradores Modbus. Valores em ponto fixo com sinal (int16), saturados.
+ //===============================================
+ uint16_t registro_escalado(float valor, float escala) {
+     float v = valor * escala;
+     if (v > 32767.0f) v = 32767.0f;
+     if (v < -32768.0f) v = -32768.0f;
+     return (uint16_t)(int16_t)(v < 0.0f ? v - 0.5f : v + 0.5f);
+ }
+ 
+ static const float ESCALA_REGISTRO[ZONA_NUM_SENSORES] = {
+     [CAL_ETILENO] = 100.0f, [CAL_TEMP] = 10.0f, [CAL_UMIDADE] = 10.0f, [CAL_CO2] = 1.0f,
+ };
+ 
+ // Bits de alarme no formato do registrador 8, a partir do estado da zona
+ uint16_t alarmes_modbus(uint8_t zona) {
+     uint16_t estado = zonas.estado[zona];
+     uint16_t alarmes = 0;
+     if (!(estado & ZONA_ABAIXO(CAL_ETILENO))) alarmes |= ALARME_ETILENO_AMADURECENDO;
+     if (estado & ZONA_ACIMA(CAL_ETILENO)) alarmes |= ALARME_ETILENO_APODRECENDO;
+     if (estado & ZONA_ABAIXO(CAL_TEMP)) alarmes |= ALARME_TEMP_BAIXA;
+     if (estado & ZONA_ACIMA(CAL_TEMP)) alarmes |= ALARME_TEMP_ALTA;
+     if (estado & ZONA_ABAIXO(CAL_UMIDADE)) alarmes |= ALARME_UMIDADE_BAIXA;
+     if (estado & ZONA_ACIMA(CAL_CO2)) alarmes |= ALARME_CO2_ALTO;
+     if (zona == 0 && controle.alerta_precoce) alarmes |= ALARME_PRECOCE;   // Tendência só da zona 0
+     return alarmes;
+ }
+ 
+ // Registradores 0..8 de uma zona, lidos direto das tabelas de zonas
+ uint16_t registro_zona(uint8_t zona, uint16_t k) {
+     if (k < REG_MEDIA)
+         return registro_escalado(zonas.valor[k][zona], ESCALA_REGISTRO[k]);
+     if (k < REG_ALARMES)
+         return registro_escalado(zonas_media(&zonas, (cal_canal_t)(k - REG_MEDIA), zona), ESCALA_REGISTRO[k - REG_MEDIA]);
+     return alarmes_modbus(zona);
+ }
+ 
+ bool modbus_ler_entrada(void *ctx, uint16_t reg, uint16_t *valor) {
+     if (reg >= REG_ZONAS_BASE) {
+         uint16_t zona = (reg - REG_ZONAS_BASE) / REGS_POR_ZONA_ENTRADA;
+         uint16_t k = (reg - REG_ZONAS_BASE) % REGS_POR_ZONA_ENTRADA;
+         if (zona >= NUM_ZONAS || k >= REGS_ZONA_ENTRADA)
+             return false;
+         *valor = registro_zona((uint8_t)zona, k);
+         return true;
+     }
+     switch (reg) {
+     case REG_TEMPO_VIAGEM_MIN: {
+         uint64_t viagem_us = tempo_viagem_base_us + absolute_time_diff_us(start_time, get_absolute_time());
+         *valor = (uint16_t)(viagem_us / 60000000u);
+         return true;
+     }
+     case REG_REINICIOS:      *valor = (uint16_t)persistente.reinicios; return true;
+     case REG_QUADROS_MODBUS: *valor = (uint16_t)modbus.quadros; return true;
+     case REG_ERROS_CRC:      *valor = (uint16_t)modbus.erros_crc; return true;
+     default:
+         if (reg > REG_ALARMES)
+             return false;
+         *valor = registro_zona(0, reg);
+         return true;
+     }
+ }
+ 
+ // Setpoint k da zona: ponteiro para o limite, escala e faixa aceita
+ float *setpoint_modbus(config_t *cfg, uint16_t reg, float *escala, int16_t *minimo, int16_t *maximo) {
+     uint16_t zona = reg / REGS_POR_ZONA_RETENCAO;
+     uint16_t k = reg % REGS_POR_ZONA_RETENCAO;
+     if (zona >= NUM_ZONAS || k >= NUM_REGS_RETENCAO)
+         return NULL;
+     zona_limites_t *l = &cfg->limites;
+     switch (k) {
+     case REG_ETILENO_LOWER: *escala = 100.0f; *minimo = 0; *maximo = 1000; return &l->inferior[CAL_ETILENO][zona];
+     case REG_ETILENO_UPPER: *escala = 100.0f; *minimo = 0; *maximo = 1000; return &l->superior[CAL_ETILENO][zona];
+     case REG_TEMP_LOWER:    *escala = 10.0f; *minimo = -200; *maximo = 600; return &l->inferior[CAL_TEMP][zona];
+     case REG_TEMP_UPPER:    *escala = 10.0f; *minimo = -200; *maximo = 600; return &l->superior[CAL_TEMP][zona];
+     case REG_UMIDADE_SET:   *escala = 10.0f; *minimo = 0; *maximo = 1000; return &l->inferior[CAL_UMIDADE][zona];
+     default:                *escala = 1.0f; *minimo = 0; *maximo = 5000; return &l->superior[CAL_CO2][zona];
+     }
+ }
+ 
+ bool modbus_ler_retencao(void *ctx, uint16_t reg, uint16_t *valor) {
+     float escala;
+     int16_t minimo, maximo;
+     float *setpoint = setpoint_modbus(ctx, reg, &escala, &minimo, &maximo);
+     if (!setpoint)
+         return false;
+     *valor = registro_escalado(*setpoint, escala);
+     return true;
+ }
+ 
+ // Escreve na cópia do escritor; o laço publica a configuração em seguida
+ uint8_t modbus_escrever_retencao(void *ctx, uint16_t reg, uint16_t valor, bool aplicar) {
+     float escala;
+     int16_t minimo, maximo;
+     float *setpoint = setpoint_modbus(ctx, reg, &escala, &minimo, &maximo);
+     if (!setpoint)
+         return MODBUS_EXC_ENDERECO;
+     int16_t v = (int16_t)valor;
+     if (v < minimo || v > maximo)
+         return MODBUS_EXC_VALOR;
+     if (aplicar) {
+         *setpoint = (float)v / escala;
+         modbus_alterou_config = true;
+     }
+     return 0;
+ }
+ 
+ //===============================================
+ // Troca o clk_sys. O clk_peri acompanha o clk_sys, então o baud do I2C
+ // e da UART do Modbus e os divisores da PIO (WS2812 e tons) são refeitos;
+ // os temporizadores usam o clk_ref, que não muda.
+ //===============================================
+ void ajustar_clock(uint32_t khz) {
+     if (khz == clock_atual_khz || !set_sys_clock_khz(khz, false))
+         return;
+     clock_atual_khz = khz;
+     i2c_set_baudrate(i2c1, I2C_BAUDRATE);
+     modbus_hw_ajustar_baud();
+     pio_sm_set_clkdiv(pio0, WS2812_SM, clock_get_hz(clk_sys) / (800000.0f * (ws2812_T1 + ws2812_T2 + ws2812_T3)));
+     tom_hw_ajustar_clock();
+     energia_definir(&energia, ENERGIA_CPU, khz == CLOCK_PLENO_KHZ ? ENERGIA_PLENO : ENERGIA_REDUZIDO, time_us_64());
+ }
+ 
+ //===============================================
+ // Só troca o clk_sys com os periféricos que dependem dele parados: um
+ // byte do Modbus, um pedaço do I2C, um tom ou um quadro da matriz em
+ // andamento sairiam com o divisor errado no meio da troca.
+ //===============================================
+ bool pode_trocar_clock(void) {
+     return modbus_hw_ocioso() && barramento_i2c_ocioso(&barramento) && !tom_hw_tocando() && !matriz_hw_ocupada();
+ }
+   
+ //===============================================
+ // Aplica o estado da tela: contraste/painel do OLED, matriz e clock
+ // de trabalho (trocado na próxima espera, ver esperar_proxima_amostra).
+ // Retorna false se o comando do OLED não coube na fila (tenta de novo).
+ //===============================================
+ bool aplicar_tela(ssd1306_t *ssd, energia_tela_t tela) {
+     bool ligado = tela != TELA_APAGADA;
+     uint8_t contraste = tela == TELA_ATIVA ? CONTRASTE_PLENO : CONTRASTE_ESCURECIDO;
+     if (!ssd1306_energia_async(ssd, &barramento, ligado, contraste))
+         return false;
+     if (tela == TELA_APAGADA) {
+         matriz_apagar(&matriz, to_ms_since_boot(get_absolute_time()));
+         clock_trabalho_khz = CLOCK_REDUZIDO_KHZ;
+     } else {
+         uint8_t div = (tela == TELA_ESCURECIDA) ? ESCURECIMENTO_MATRIZ : 1;
+         matriz_definir_brilho(&matriz, BRILHO_MATRIZ / div);
+         clock_trabalho_khz = CLOCK_PLENO_KHZ;
+     }
+     return true;
+ }
+ 
+ uint32_t periodo_amostra_ms(energia_tela_t tela) {
+     if (tela == TELA_APAGADA)
+         return PERIODO_AMOSTRA_APAGADA_MS;
+     if (tela == TELA_ESCURECIDA)
+         return PERIODO_AMOSTRA_ESCURECIDA_MS;
+     return PERIODO_AMOSTRA_ATIVA_MS;
+ }
+ 
+ //===============================================
+ // Dorme em __wfi até a próxima amostra. O amostrador dos botões (5 ms),
+ // e a USB acordam a CPU; um evento de botão encerra a
+ // espera, assim como um quadro Modbus recebido. Um evento publicado entre
+ // o teste e o __wfi espera no máximo uma volta do amostrador.
+ //
+ // Durante a espera o clk_sys cai para CLOCK_REDUZIDO_KHZ (as IRQs e o
+ // Modbus atendido fora de hora rodam nele) e volta ao clock de trabalho
+ // na saída. Cada troca refaz o baud do I2C e do Modbus e os divisores da
+ // PIO (ajustar_clock), por isso só ocorre com esses periféricos parados;
+ // se não estiverem, o clock atual continua até a próxima oportunidade.
+ //===============================================
+ void esperar_proxima_amostra(absolute_time_t prazo) {
+     if (absolute_time_diff_us(get_absolute_time(), prazo) >= ESPERA_MINIMA_CLOCK_US && pode_trocar_clock())
+         ajustar_clock(CLOCK_REDUZIDO_KHZ);
+     energia_definir(&energia, ENERGIA_CPU, ENERGIA_DESLIGADO, time_us_64());
+     while (absolute_time_diff_us(get_absolute_time(), prazo) > 0 && !eventos_pendentes() &&
+            !modbus_pendente(&modbus)
+ #ifdef FRUITLIFE_USB_MSC
+            && !usb_disco_hw_pendente()
+ #endif
+            )
+         __wfi();
+     if (pode_trocar_clock())
+         ajustar_clock(clock_trabalho_khz);
+     energia_definir(&energia, ENERGIA_CPU, clock_atual_khz == CLOCK_PLENO_KHZ ? ENERGIA_PLENO : ENERGIA_REDUZIDO,
+                     time_us_64());
+ }
+ 
+ //===============================================
+ // Lê as zonas 1..NUM_ZONAS-1. Com o multiplexador, o canal (z-1)*4 + s
+ // traz o sensor s da zona z; sem ele, as zonas repetem a leitura bruta
+ // da zona 0 pela calibração (útil para ensaiar o processamento em lote).
+ //===============================================
+ void ler_zonas_extras(void) {
+     for (uint8_t z = 1; z < NUM_ZONAS; z++) {
+         for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+ #ifdef FRUITLIFE_MUX_ZONAS
+             uint32_t canal = (uint32_t)(z - 1) * ZONA_NUM_SENSORES + s;
+             gpio_put_masked(((1u << MUX_BITS_SELECAO) - 1) << MUX_PRIMEIRO_PINO_SELECAO,
+                             canal << MUX_PRIMEIRO_PINO_SELECAO);
+             busy_wait_us_32(MUX_ACOMODACAO_US);
+             adc_select_input(MUX_ADC_PIN - 26);
+             uint16_t bruto = adc_read();
+ #else
+             uint16_t bruto = adc_atual[s];
+ #endif
+             zonas.valor[s][z] = calibracao_converter((cal_canal_t)s, bruto);
+         }
+     }
+ }
+ 
+ //===============================================
+ // Copia o estado de execução para a RAM não inicializada
+ //===============================================
+ void salvar_estado(const config_t *cfg) {
+     persistente.estatisticas = zonas.estatisticas;
+     persistente.excursoes = excursoes;
+     persistente.tempo_viagem_us = tempo_viagem_base_us + absolute_time_diff_us(start_time, get_absolute_time());
+     persistente.config = *cfg;
+     persistente.config.in_set_mode = false;
+     for (int c = 0; c < CAL_NUM_CANAIS; c++)
+         persistente.calibracao[c] = *calibracao_tabela((cal_canal_t)c);
+     persistencia_salvar(&persistente);
+ }
+   
+ //===============================================
+ // Grava um registro por zona no histórico da flash
+ //===============================================
+ int32_t arredondar_limitado(float v, int32_t minimo, int32_t maximo) {
+     if (v <= (float)minimo)
+         return minimo;
+     if (v >= (float)maximo)
+         return maximo;
+     return (int32_t)(v < 0.0f ? v - 0.5f : v + 0.5f);
+ }
+ 
+ void gravar_historico(uint32_t tempo_s) {
+     for (uint8_t z = 0; z < NUM_ZONAS; z++) {
+         historico_registro_t r = {
+             .tempo_s = tempo_s,
+             .zona = z,
+             .estado = (uint8_t)zonas.estado[z],
+             .temp_cc = (int16_t)arredondar_limitado(zonas.valor[CAL_TEMP][z] * 100.0f, INT16_MIN, INT16_MAX),
+             .umidade_dm = (uint16_t)arredondar_limitado(zonas.valor[CAL_UMIDADE][z] * 10.0f, 0, UINT16_MAX),
+             .etileno_dm = (uint16_t)arredondar_limitado(zonas.valor[CAL_ETILENO][z] * 10.0f, 0, UINT16_MAX),
+             .co2_ppm = (uint16_t)arredondar_limitado(zonas.valor[CAL_CO2][z], 0, UINT16_MAX),
+             .grau_minuto_dm = (uint32_t)arredondar_limitado(excursoes_unidade_minuto(&excursoes, CAL_TEMP, z) * 10.0f,
+                                                            0, INT32_MAX),
+             .fora_s = (uint32_t)(excursoes.tempo_fora_ms[CAL_TEMP][z] / 1000u),
+         };
+         historico_gravar(&historico, &r);
+     }
+ }
+ 
  //===============================================
  // Função principal
  //===============================================
  int main() {
+     pilha_pintar();   // Antes de qualquer inicialização, para medir o pico real
+ #ifdef FRUITLIFE_USB_MSC
+     usb_disco_hw_iniciar(&historico);   // O TinyUSB é da aplicação: antes do stdio
+ #endif
      stdio_init_all();
      
+     // Reinício a quente (watchdog ou soft reset com estado íntegro): retoma
+     // médias, tempo de viagem, setpoints e calibração e pula a tela inicial
+     motivo_reinicio = supervisao_motivo_reinicio();
+     bool reinicio_quente = (motivo_reinicio == REINICIO_WATCHDOG || motivo_reinicio == REINICIO_SOFT) &&
+                            persistencia_restaurar(&persistente);
+     if (reinicio_quente) {
+         persistente.reinicios++;
+     } else {
+         memset(&persistente, 0, sizeof(persistente));
+         controle_config_padrao(&persistente.config);
+     }
+     printf("FruitLife: reinicio por %s (%s), %lu reinicio(s) a quente\n",
+            supervisao_nome_motivo(motivo_reinicio), reinicio_quente ? "quente" : "frio",
+            (unsigned long)persistente.reinicios);
+     // Continua depois do registro mais novo; partida a frio é uma nova viagem
+     historico_init(&historico, historico_flash_hw(), !reinicio_quente);
+     printf("FruitLife: historico viagem %u, %lu registro(s) gravado(s)\n", historico.viagem,
+            (unsigned long)historico.sequencia);
+     
      // Inicializa OLED
-     i2c_init(i2c1, 400 * 1000);
+     i2c_init(i2c1, I2C_BAUDRATE);
      gpio_set_function(SDA, GPIO_FUNC_I2C);
      gpio_set_function(SCL, GPIO_FUNC_I2C);
      gpio_pull_up(SDA);
@@ -464,6 +994,14 @@
      adc_gpio_init(POT_UMIDADE_PIN);
      // Inicializa sensor CO2 (simulado; você deve definir POT_CO2_PIN no seu hardware)
      adc_gpio_init(POT_ETILENO_PIN);  // Reutiliza POT_ETILENO_PIN para simulação de CO₂
+ #ifdef FRUITLIFE_MUX_ZONAS
+     adc_gpio_init(MUX_ADC_PIN);
+     for (uint pino = MUX_PRIMEIRO_PINO_SELECAO; pino < MUX_PRIMEIRO_PINO_SELECAO + MUX_BITS_SELECAO; pino++) {
+         gpio_init(pino);
+         gpio_set_dir(pino, GPIO_OUT);
+         gpio_put(pino, 0);
+     }
+ #endif
      
      // Inicializa botões
      gpio_init(BUTTON_NEXT);
@@ -478,18 +1016,60 @@
      gpio_set_dir(BUTTON_SET, GPIO_IN);
      gpio_pull_up(BUTTON_SET);
      
-     gpio_set_irq_enabled_with_callback(BUTTON_NEXT, GPIO_IRQ_EDGE_FALL, true, button_callback);
-     gpio_set_irq_enabled(BUTTON_BACK, GPIO_IRQ_EDGE_FALL, true);
-     gpio_set_irq_enabled(BUTTON_SET, GPIO_IRQ_EDGE_FALL, true);
+     // SysTick livre (clk_sys, 24 bits) para medir a duração do amostrador de botões
+     systick_hw->rvr = 0x00FFFFFF;
+     systick_hw->cvr = 0;
+     systick_hw->csr = 0x5;
+     
+     config_t cfg_edicao = persistente.config;   // Cópia privada do escritor (laço principal)
+     config_init(&cfg_edicao);
+     calibracao_init();
+     if (reinicio_quente) {
+         for (int c = 0; c < CAL_NUM_CANAIS; c++)
+             calibracao_carregar((cal_canal_t)c, &persistente.calibracao[c]);
+     }
+     
+     // Gerenciador do barramento: o OLED usa envio assíncrono em pedaços e os
+     // sensores I2C (quando habilitados) furam a fila com prioridade alta
+ #ifdef FRUITLIFE_I2C_SIMULADO
+     i2c_backend_real = barramento_i2c_backend_hw(i2c1);
+     i2c_simulado_init(&i2c_sim, &i2c_backend_real, barramento_i2c_relogio_hw);
+     barramento_i2c_init(&barramento, i2c_simulado_backend(&i2c_sim), I2C_BAUDRATE, barramento_i2c_relogio_hw);
+ #else
+     barramento_i2c_init(&barramento, barramento_i2c_backend_hw(i2c1), I2C_BAUDRATE, barramento_i2c_relogio_hw);
+ #endif
+     sht3x_init(&sht3x, &barramento, PERIODO_SHT3X_MS);
+     scd4x_init(&scd4x, &barramento);
+     
+     // Modbus: leitura de setpoints e escrita atuam sobre a cópia do escritor
+     modbus_mapa_t mapa_modbus = {
+         .ler_entrada = modbus_ler_entrada,
+         .ler_retencao = modbus_ler_retencao,
+         .escrever_retencao = modbus_escrever_retencao,
+         .ctx = &cfg_edicao,
+     };
+     modbus_hw_iniciar(&modbus, MODBUS_UART, MODBUS_BAUD, MODBUS_TX_PIN, MODBUS_RX_PIN, MODBUS_ENDERECO, mapa_modbus);
      
-     // Inicializa buzzers
-     gpio_init(BUZZER1_PIN);
-     gpio_set_dir(BUZZER1_PIN, GPIO_OUT);
-     gpio_put(BUZZER1_PIN, 0);
+ #ifdef FRUITLIFE_BENCH
+     sleep_ms(2000);   // Dá tempo ao host de abrir a porta serial USB
+     bench_calibracao();
+     bench_zonas();
+ #endif
      
-     gpio_init(BUZZER2_PIN);
-     gpio_set_dir(BUZZER2_PIN, GPIO_OUT);
-     gpio_put(BUZZER2_PIN, 0);
+     // Amostrador periódico: debounce por botão, repetição acelerada em NEXT/BACK
+     botoes_init(&botoes, 3, BOTAO_BIT(BOTAO_IDX_NEXT) | BOTAO_BIT(BOTAO_IDX_BACK), publicar_evento_botao);
+     add_repeating_timer_us(-INTERVALO_AMOSTRA_BOTOES_US, amostrar_botoes_callback, NULL, &timer_botoes);
+     
+     // Confere a tabela de PWM/PIO antes de configurar os pinos
+     recurso_conflito_t conflitos[4];
+     uint32_t num_conflitos = recursos_verificar(ALOCACAO_RECURSOS, NUM_ALOCACOES, conflitos, 4);
+     for (uint32_t i = 0; i < num_conflitos && i < 4; i++)
+         printf("Conflito de recursos: %s x %s (%s)\n", ALOCACAO_RECURSOS[conflitos[i].a].dono,
+                ALOCACAO_RECURSOS[conflitos[i].b].dono, recursos_nome_motivo(conflitos[i].motivo));
+     
+     // Inicializa buzzers (PIO1, uma máquina de estados por buzzer)
+     const uint pinos_buzzer[NUM_BUZZERS] = {[BUZZER_INICIO] = BUZZER1_PIN, [BUZZER_ALERTA] = BUZZER2_PIN};
+     tom_hw_iniciar(pio1, pinos_buzzer, NUM_BUZZERS);
      
      init_rgb_led();
      
@@ -500,34 +1080,63 @@
      ssd1306_fill(&ssd, 0);
      ssd1306_send_data(&ssd);
      
-     splash_screen(&ssd);
-     
-     // Inicializa os WS2812 via PIO (pino 7)
+     // Inicializa os WS2812 via PIO (pino 7); os quadros saem por DMA
      PIO pio = pio0;
-     uint sm = 0;
+     uint sm = WS2812_SM;
      uint offset = pio_add_program(pio, &ws2812_program);
      ws2812_program_init(pio, sm, offset, WS2812_PIN, 800000, IS_RGBW);
+     matriz_init(&matriz, MATRIZ_ROTACAO, BRILHO_MATRIZ);
+     matriz_hw_iniciar(&matriz, pio, sm);
      
-     // Em modo de configuração, exibe o dígito atual (padrão digital)
-
-     definir_leds(COR_WS2812_R, COR_WS2812_G, COR_WS2812_B);
+     if (!reinicio_quente) {
+         matriz_paleta(&matriz, ICONE_FRUTA, PALETA_FRUTA, to_ms_since_boot(get_absolute_time()));
+         splash_screen(&ssd);
+     }
      
-     // Inicializa acumuladores para médias e registra o tempo inicial
-     sample_count = 0;
-     sum_etileno = 0.0f;
-     sum_temp = 0.0f;
-     sum_umidade = 0.0f;
-     sum_co2 = 0.0f;
+     // Inicializa as estatísticas das zonas (zeradas ou restauradas) e o tempo inicial
+     zonas_init(&zonas, reinicio_quente ? &persistente.estatisticas : NULL);
+     excursoes_init(&excursoes, reinicio_quente ? &persistente.excursoes : NULL);
+     tempo_viagem_base_us = persistente.tempo_viagem_us;
      start_time = get_absolute_time();
+     controle_init(&controle);
      
      absolute_time_t proximo_toggle = get_absolute_time();
      bool estado_led = false;
+     absolute_time_t proximo_salvamento = get_absolute_time();
+     uint32_t geracao_salva = config_geracao();
+     uint32_t transacoes_i2c = barramento.transacoes;
+     
+     energia_init(&energia, time_us_64(), TEMPO_ESCURECER_MS, TEMPO_APAGAR_MS);
+     energia_tela_t tela_aplicada = TELA_ATIVA;
+     absolute_time_t proxima_amostra = get_absolute_time();
+     
+     supervisao_iniciar(SUPERVISAO_TIMEOUT_MS);
+ #ifdef FRUITLIFE_BENCH
+     absolute_time_t proximo_relatorio = make_timeout_time_ms(INTERVALO_RELATORIO_BENCH_MS);
+ #endif
      
      while (true) {
          absolute_time_t agora = get_absolute_time();
          
+         // Aplica os eventos pendentes e tira um único instantâneo por ciclo
+         bool houve_eventos = processar_eventos_botoes(&cfg_edicao);
+         // Quadro Modbus completo: atende (resposta sai por DMA) e publica
+         // os setpoints escritos pelo mestre
+         modbus_alterou_config = false;
+         modbus_processar(&modbus, time_us_32());
+         if (modbus_alterou_config)
+             config_publicar(&cfg_edicao);
+         config_t cfg;
+         config_snapshot(&cfg);
+         
+         // Escurece/apaga a tela por inatividade (botões e alarmes acordam)
+         uint64_t agora_us = to_us_since_boot(agora);
+         energia_tela_t tela = energia_avaliar_tela(&energia, agora_us);
+         if (tela != tela_aplicada && aplicar_tela(&ssd, tela))
+             tela_aplicada = tela;
+         
          // Para os modos 0 (Gás Etileno) e 3 (CO₂), usamos LED piscante
-         if (menu_index != 1 && menu_index != 2 && menu_index != 4) {
+         if (cfg.menu_index == 0 || cfg.menu_index == 3) {
              if (absolute_time_diff_us(proximo_toggle, agora) >= (INTERVALO_PISCA_LED_MS * 1000)) {
                  estado_led = !estado_led;
                  gpio_put(R_LED_PIN, estado_led);
@@ -535,198 +1144,163 @@
              }
          }
          
-         if (atualizar_exibicao) {
-             // Modo de configuração: exibe o dígito (padrão digital)
-
-             definir_leds(COR_WS2812_R, COR_WS2812_G, COR_WS2812_B);
-             atualizar_exibicao = false;
-         } else {
+         if (houve_eventos || absolute_time_diff_us(proxima_amostra, agora) >= 0) {
              // Modo normal: realiza leituras para todos os sensores
+             proxima_amostra = delayed_by_ms(agora, periodo_amostra_ms(tela_aplicada));
+             BENCH_INICIO(ESTAGIO_LEITURA);
+             // Conversão ADC -> unidade pelas LUTs de calibração de cada canal
              adc_select_input(POT_ETILENO_PIN - 26);
-             int adc_etileno = adc_read();
-             float medida_etileno = (adc_etileno / 4095.0f) * 10.0f;
+             adc_atual[CAL_ETILENO] = adc_read();
+             float medida_etileno = calibracao_converter(CAL_ETILENO, adc_atual[CAL_ETILENO]);
              
              adc_select_input(POT_UMIDADE_PIN - 26);
-             int adc_umidade = adc_read();
-             float medida_temp = (adc_umidade / 4095.0f) * 40.0f;  // Temperatura simulada
-             float medida_umidade = (adc_umidade / 4095.0f) * 100.0f; // Umidade simulada
+             uint16_t adc_umidade = adc_read();
+             adc_atual[CAL_TEMP] = adc_umidade;
+             adc_atual[CAL_UMIDADE] = adc_umidade;
+             float medida_temp = calibracao_converter(CAL_TEMP, adc_umidade);        // Temperatura simulada
+             float medida_umidade = calibracao_converter(CAL_UMIDADE, adc_umidade);  // Umidade simulada
              
              adc_select_input(POT_ETILENO_PIN - 26);
-             int adc_co2 = adc_read();
-             float medida_co2 = (adc_co2 / 4095.0f) * 1000.0f;
+             adc_atual[CAL_CO2] = adc_read();
+             float medida_co2 = calibracao_converter(CAL_CO2, adc_atual[CAL_CO2]);
              
-             // Atualiza acumuladores para médias
-             sample_count++;
-             sum_etileno += medida_etileno;
-             sum_temp += medida_temp;
-             sum_umidade += medida_umidade;
-             sum_co2 += medida_co2;
+ #ifdef FRUITLIFE_SENSORES_I2C
+ #ifdef FRUITLIFE_I2C_SIMULADO
+             // Os substitutos dos sensores respondem com os valores dos potenciômetros
+             i2c_simulado_definir_sht3x(&i2c_sim, medida_temp, medida_umidade);
+             i2c_simulado_definir_scd4x(&i2c_sim, medida_co2, medida_temp, medida_umidade);
+ #endif
+             // Sensores I2C substituem os potenciômetros assim que houver leitura válida
+             if (sht3x.valido) {
+                 medida_temp = sht3x.temperatura;
+                 medida_umidade = sht3x.umidade;
+             }
+             if (scd4x.valido)
+                 medida_co2 = scd4x.co2;
+ #endif
              
-             float valor_medido = 0.0f;
-             char status[32];
-             char unidade[8];
+             zonas.valor[CAL_ETILENO][0] = medida_etileno;
+             zonas.valor[CAL_TEMP][0] = medida_temp;
+             zonas.valor[CAL_UMIDADE][0] = medida_umidade;
+             zonas.valor[CAL_CO2][0] = medida_co2;
+             ler_zonas_extras();
+             BENCH_FIM(ESTAGIO_LEITURA);
              
-             if (menu_index == 0) { // Gás Etileno
-                 valor_medido = medida_etileno;
-                 strcpy(unidade, "ppm");
-                 if (valor_medido < etileno_lower)
-                     strcpy(status, "Normal");
-                 else if (valor_medido < etileno_upper)
-                     strcpy(status, "Amadurec. rapido");
-                 else
-                     strcpy(status, "Apodrecendo");
-             } else if (menu_index == 1) { // Temperatura
-                 valor_medido = medida_temp;
-                 strcpy(unidade, "°C");
-                 if (valor_medido >= temp_lower && valor_medido <= temp_upper)
-                     strcpy(status, "Ideal");
-                 else if (valor_medido > temp_upper && valor_medido <= (temp_upper + 5))
-                     strcpy(status, "Levemente alto");
-                 else if (valor_medido < temp_lower)
-                     strcpy(status, "Frio");
-                 else
-                     strcpy(status, "Critico");
-             } else if (menu_index == 2) { // Umidade
-                 valor_medido = medida_umidade;
-                 strcpy(unidade, "%");
-                 if (valor_medido >= umidade_set)
-                     strcpy(status, "Ideal");
-                 else
-                     strcpy(status, "Baixa");
-             } else if (menu_index == 3) { // CO₂
-                 valor_medido = medida_co2;
-                 strcpy(unidade, "ppm");
-                 if (valor_medido <= co2_set)
-                     strcpy(status, "Ideal");
-                 else
-                     strcpy(status, "Alto");
+             // Estatísticas, alarmes e excursões de todas as zonas numa só passada
+             uint32_t agora_ms = to_ms_since_boot(agora);
+             zonas_processar(&zonas, &cfg.limites, NUM_ZONAS);
+             excursoes_processar(&excursoes, &zonas, &cfg.limites, NUM_ZONAS, agora_ms);
+             uint32_t tempo_viagem_s = (uint32_t)((tempo_viagem_base_us + absolute_time_diff_us(start_time, agora)) / 1000000u);
+             // Grava com o Modbus ocioso: a flash desliga as IRQs (ver historico_hw.h)
+             if (tempo_viagem_s >= proximo_historico_s && !modbus_pendente(&modbus)) {
+                 gravar_historico(tempo_viagem_s);
+                 proximo_historico_s = (tempo_viagem_s / INTERVALO_HISTORICO_S + 1) * INTERVALO_HISTORICO_S;
              }
+             supervisao_check_in(TAREFA_MEDICAO);
              
-             // Atualiza o OLED
-             if (menu_index == 0)
-                 update_display(&ssd, valor_medido, unidade, status, "GAS ETILENO");
-             else if (menu_index == 1)
-                 update_display(&ssd, valor_medido, unidade, status, "TEMPERATURA");
-             else if (menu_index == 2)
-                 update_display(&ssd, valor_medido, unidade, status, "UMIDADE");
-             else if (menu_index == 3)
-                 update_display(&ssd, valor_medido, unidade, status, "CO2");
-             else if (menu_index == 4) {
-                 float media_etileno = sum_etileno / sample_count;
-                 float media_temp = sum_temp / sample_count;
-                 float media_umidade = sum_umidade / sample_count;
-                 float media_co2 = sum_co2 / sample_count;
-                 float tempo = absolute_time_diff_us(start_time, get_absolute_time()) / 1000000.0f;
-                 update_display_medias(&ssd, media_etileno, media_temp, media_umidade, media_co2, tempo);
-             }
+             // Classificação da leitura exibida, alarmes e atuadores
+             BENCH_INICIO(ESTAGIO_CLASSIFICACAO);
+             controle_saida_t saida;
+             controle_amostrar(&controle, &cfg, &zonas, agora_ms, &saida);
+             BENCH_FIM(ESTAGIO_CLASSIFICACAO);
+             if (saida.beep_alerta_precoce)
+                 beep_alerta_precoce();
+             char previsao[32];
              
-             // Atualiza o LED indicador
-             if (menu_index == 0) { // Gás Etileno
-                 if (valor_medido < etileno_lower)
-                     set_rgb_color(0, 255, 0);
-                 else if (valor_medido < etileno_upper)
-                     set_rgb_color(255, 165, 0);
-                 else
-                     set_rgb_color(255, 0, 0);
-             } else if (menu_index == 3) { // CO₂
-                 if (strcmp(status, "Ideal") == 0)
-                     set_rgb_color(0, 255, 0);
-                 else
-                     set_rgb_color(255, 0, 0);
-             }
-             // Para Temperatura, simula o motor com PWM:
-             if (menu_index == 1) {
-                 // Se a temperatura estiver na faixa ideal, motor parado: PWM = 0 em ambas as cores (vermelho e azul)
-                 if (valor_medido >= temp_lower && valor_medido <= temp_upper) {
-                     uint slice_r = pwm_gpio_to_slice_num(R_LED_PIN);
-                     uint channel_r = pwm_gpio_to_channel(R_LED_PIN);
-                     pwm_set_chan_level(slice_r, channel_r, 0);
-                     uint slice_b = pwm_gpio_to_slice_num(B_LED_PIN);
-                     uint channel_b = pwm_gpio_to_channel(B_LED_PIN);
-                     pwm_set_chan_level(slice_b, channel_b, 0);
-                 }
-                 else if (valor_medido < temp_lower) {
-                     // Temperatura baixa: motor acelerando em vermelho
-                     float erro = temp_lower - valor_medido;
-                     float max_error = temp_lower; // Exemplo
-                     float motor_pwm = (erro / max_error) * PWM_WRAP;
-                     if (motor_pwm > PWM_WRAP) motor_pwm = PWM_WRAP;
-                     uint slice_r = pwm_gpio_to_slice_num(R_LED_PIN);
-                     uint channel_r = pwm_gpio_to_channel(R_LED_PIN);
-                     pwm_set_chan_level(slice_r, channel_r, (uint16_t)motor_pwm);
-                     // Garante que o LED azul esteja desligado
-                     uint slice_b = pwm_gpio_to_slice_num(B_LED_PIN);
-                     uint channel_b = pwm_gpio_to_channel(B_LED_PIN);
-                     pwm_set_chan_level(slice_b, channel_b, 0);
-                 }
-                 else { // valor_medido > temp_upper
-                     // Temperatura alta: motor acelerando em azul
-                     float erro = valor_medido - temp_upper;
-                     float max_error = 10.0f;  // Ajustável: consideramos 10°C acima de temp_upper como máximo
-                     float motor_pwm = (erro / max_error) * PWM_WRAP;
-                     if (motor_pwm > PWM_WRAP) motor_pwm = PWM_WRAP;
-                     uint slice_b = pwm_gpio_to_slice_num(B_LED_PIN);
-                     uint channel_b = pwm_gpio_to_channel(B_LED_PIN);
-                     pwm_set_chan_level(slice_b, channel_b, (uint16_t)motor_pwm);
-                     // Garante que o LED vermelho esteja desligado
-                     uint slice_r = pwm_gpio_to_slice_num(R_LED_PIN);
-                     uint channel_r = pwm_gpio_to_channel(R_LED_PIN);
-                     pwm_set_chan_level(slice_r, channel_r, 0);
-                 }
-             }
-             // Para Umidade, o LED indicador (R_LED_PIN) recebe PWM proporcional
-             else if (menu_index == 2) {
-                 float motor_pwm;
-                 if (valor_medido >= umidade_set)
-                     motor_pwm = 0;  // Ideal: motor parado
-                 else {
-                     float erro = umidade_set - valor_medido;
-                     float max_error = 50.0f;  // Ajustável
-                     motor_pwm = (erro / max_error) * PWM_WRAP;
-                     if (motor_pwm > PWM_WRAP) motor_pwm = PWM_WRAP;
+             // Atualiza o OLED
+             BENCH_INICIO(ESTAGIO_DESENHO);
+             if (tela_aplicada != TELA_APAGADA) {   // Painel desligado: não desenha nem ocupa o barramento
+                 if (guia.ativa)
+                     update_display_calibracao(&ssd);
+                 else if (cfg.menu_index == 0) {
+                     formatar_previsao(previsao, "Et", &controle.tendencia_etileno, LIMITE_INFERIOR(cfg, CAL_ETILENO), LIMITE_SUPERIOR(cfg, CAL_ETILENO));
+                     update_display(&ssd, &cfg, saida.valor, saida.unidade, saida.status, "GAS ETILENO", previsao);
+                 } else if (cfg.menu_index == 1) {
+                     formatar_previsao(previsao, "T", &controle.tendencia_temp, LIMITE_INFERIOR(cfg, CAL_TEMP), LIMITE_SUPERIOR(cfg, CAL_TEMP));
+                     update_display(&ssd, &cfg, saida.valor, saida.unidade, saida.status, "TEMPERATURA", previsao);
+                 } else if (cfg.menu_index == 2)
+                     update_display(&ssd, &cfg, saida.valor, saida.unidade, saida.status, "UMIDADE", NULL);
+                 else if (cfg.menu_index == 3)
+                     update_display(&ssd, &cfg, saida.valor, saida.unidade, saida.status, "CO2", NULL);
+                 else if (cfg.menu_index == MENU_DIAGNOSTICO)
+                     update_display_diagnostico(&ssd);
+                 else if (cfg.menu_index == MENU_EXCURSOES)
+                     update_display_excursoes(&ssd, cfg.zona_atual);
+                 else if (cfg.menu_index == MENU_MEDIAS) {
+                     float media_etileno = zonas_media(&zonas, CAL_ETILENO, cfg.zona_atual);
+                     float media_temp = zonas_media(&zonas, CAL_TEMP, cfg.zona_atual);
+                     float media_umidade = zonas_media(&zonas, CAL_UMIDADE, cfg.zona_atual);
+                     float media_co2 = zonas_media(&zonas, CAL_CO2, cfg.zona_atual);
+                     float tempo = (tempo_viagem_base_us + absolute_time_diff_us(start_time, get_absolute_time())) / 1000000.0f;
+                     update_display_medias(&ssd, media_etileno, media_temp, media_umidade, media_co2, tempo);
                  }
-                 uint slice = pwm_gpio_to_slice_num(R_LED_PIN);
-                 uint channel = pwm_gpio_to_channel(R_LED_PIN);
-                 pwm_set_chan_level(slice, channel, (uint16_t)motor_pwm);
              }
              
-             // Atualiza a matriz WS2812 com a carinha apropriada
-             if (menu_index == 0) {
-                 if (valor_medido < etileno_lower)
-                     atualizar_buffer_com_carinha(0); // Neutra ou Feliz (conforme lógica desejada)
-                 else if (valor_medido >= etileno_upper)
-                     atualizar_buffer_com_carinha(1); // Triste
-                 else
-                     atualizar_buffer_com_carinha(0);
-                 if (valor_medido >= etileno_upper)
-                     beep();
-             } else if (menu_index == 1) {
-                 if (valor_medido >= temp_lower && valor_medido <= temp_upper)
-                     atualizar_buffer_com_carinha(0);
-                 else
-                     atualizar_buffer_com_carinha(1);
-                 if (strcmp(status, "Ideal") != 0)
-                     beep();
-             } else if (menu_index == 2) {
-                 if (valor_medido >= umidade_set)
-                     atualizar_buffer_com_carinha(0);
-                 else
-                     atualizar_buffer_com_carinha(1);
-                 if (strcmp(status, "Ideal") != 0)
-                     beep();
-             } else if (menu_index == 3) {
-                 if (valor_medido <= co2_set)
-                     atualizar_buffer_com_carinha(0);
-                 else
-                     atualizar_buffer_com_carinha(1);
-                 if (strcmp(status, "Ideal") != 0)
-                     beep();
-             }
-             if (menu_index != 4) { // Nos modos normais, atualiza a matriz WS2812
-                 definir_leds(COR_WS2812_R, COR_WS2812_G, COR_WS2812_B);
+             BENCH_FIM(ESTAGIO_DESENHO);
+             
+             // LED indicador e "motor" (PWM no vermelho/azul)
+             if (saida.rgb)
+                 set_rgb_color(saida.r, saida.g, saida.b);
+             if (saida.motor_r != CONTROLE_PWM_INALTERADO)
+                 pwm_set_chan_level(pwm_gpio_to_slice_num(R_LED_PIN), pwm_gpio_to_channel(R_LED_PIN), (uint16_t)saida.motor_r);
+             if (saida.motor_b != CONTROLE_PWM_INALTERADO)
+                 pwm_set_chan_level(pwm_gpio_to_slice_num(B_LED_PIN), pwm_gpio_to_channel(B_LED_PIN), (uint16_t)saida.motor_b);
+             if (saida.beep)
+                 beep();
+             
+             if (cfg.menu_index < MENU_MEDIAS && tela_aplicada != TELA_APAGADA) { // Nos modos normais, atualiza a matriz WS2812
+                 BENCH_INICIO(ESTAGIO_MATRIZ);
+                 if (cfg.in_set_mode) {
+                     char texto[12];
+                     snprintf(texto, sizeof(texto), cfg.menu_index <= 1 ? "%.1f" : "%.0f", controle_setpoint_em_edicao(&cfg));
+                     matriz_rolar(&matriz, texto, COR_CONFIGURACAO, PASSO_ROLAGEM_MS, agora_ms);
+                 } else {
+                     mostrar_severidade(saida.severidade, agora_ms);
+                 }
+                 BENCH_FIM(ESTAGIO_MATRIZ);
              }
          }
-         tight_loop_contents();
+         
+ #ifdef FRUITLIFE_SENSORES_I2C
+         agora_us = to_us_since_boot(get_absolute_time());
+         sht3x_poll(&sht3x, agora_us);
+         scd4x_poll(&scd4x, agora_us);
+ #endif
+         BENCH_INICIO(ESTAGIO_BARRAMENTO);
+         barramento_i2c_processar(&barramento, ORCAMENTO_BARRAMENTO_US);
+         BENCH_FIM(ESTAGIO_BARRAMENTO);
+         if (barramento.transacoes != transacoes_i2c || barramento_i2c_ocioso(&barramento)) {
+             transacoes_i2c = barramento.transacoes;
+             supervisao_check_in(TAREFA_BARRAMENTO);
+         }
+         
+         // Salva o estado a cada segundo ou quando os setpoints mudam
+         if (absolute_time_diff_us(proximo_salvamento, agora) >= 0 || config_geracao() != geracao_salva) {
+             salvar_estado(&cfg);
+             geracao_salva = config_geracao();
+             proximo_salvamento = delayed_by_ms(agora, INTERVALO_SALVAR_ESTADO_MS);
+         }
+         supervisao_alimentar();
+ #ifdef FRUITLIFE_USB_MSC
+         usb_disco_hw_processar();
+ #endif
+         
+ #ifdef FRUITLIFE_BENCH
+         if (absolute_time_diff_us(proximo_relatorio, agora) >= 0) {
+             bench_relatorio(irq_ciclos_max);
+             proximo_relatorio = delayed_by_ms(agora, INTERVALO_RELATORIO_BENCH_MS);
+         }
+ #endif
+         if (!tom_hw_tocando())
+             energia_definir(&energia, ENERGIA_BUZZER, ENERGIA_DESLIGADO, time_us_64());
+         energia_contabilizar(&energia, time_us_64());
+         
+         // Com o barramento livre, dorme até a próxima amostra; senão
+         // continua girando para escoar os pedaços do quadro do OLED
+         if (barramento_i2c_ocioso(&barramento))
+             esperar_proxima_amostra(proxima_amostra);
+         else
+             tight_loop_contents();
      }
      
      return 0;
@@ -0,0 +1,171 @@
+//===============================================
+// Conferência da alocação de PWM/PIO e do gerador de tons (host)
+//
+// Imprime a tabela de pinos.h (GPIO, dono, slice/canal do PWM ou
+// PIO/máquina de estados) e exige zero conflitos. Também confere que
+// recursos_verificar pega a alocação antiga (buzzer 1 no PWM do GPIO 10,
+// slice 5 junto com o LED verde) e os outros motivos, e passa os pedidos
+// de tom.h por um modelo ciclo a ciclo do tom.pio: frequência com erro
+// abaixo de 0,5% de 50 Hz a 5 kHz, duração dentro de meio período e o
+// pino em 0 ao fim de cada pedido.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o alocacao tools/alocacao.c include/recursos.c
+//
+// Uso: alocacao   (código 1 se alguma verificação falhar)
+//===============================================
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "pinos.h"
+#include "recursos.h"
+#include "tom.h"
+
+#define PERFIL_PWM_TOM 1   // Wrap/divisor por nota do gerador antigo
+#define MAX_CONFLITOS 16
+
+static int falhas;
+
+static void conferir(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+static void imprimir_alocacao(void) {
+    printf("GPIO  dono            recurso\n");
+    for (uint32_t i = 0; i < NUM_ALOCACOES; i++) {
+        const recurso_pedido_t *p = &ALOCACAO_RECURSOS[i];
+        if (p->tipo == RECURSO_PWM)
+            printf("%4u  %-14s  PWM slice %u canal %c (perfil %u)\n", p->gpio, p->dono, RECURSO_PWM_SLICE(p->gpio),
+                   RECURSO_PWM_CANAL(p->gpio) ? 'B' : 'A', p->perfil);
+        else
+            printf("%4u  %-14s  PIO%u SM%u\n", p->gpio, p->dono, p->pio, p->sm);
+    }
+}
+
+// Verdadeiro se entre os conflitos há 'motivo' envolvendo os donos a e b
+static bool tem_conflito(const recurso_pedido_t *pedidos, uint32_t n, uint8_t motivo, const char *a,
+                         const char *b) {
+    recurso_conflito_t c[MAX_CONFLITOS];
+    uint32_t total = recursos_verificar(pedidos, n, c, MAX_CONFLITOS);
+    for (uint32_t i = 0; i < total && i < MAX_CONFLITOS; i++) {
+        const char *x = pedidos[c[i].a].dono, *y = pedidos[c[i].b].dono;
+        if (c[i].motivo == motivo && ((x == a && y == b) || (x == b && y == a)))
+            return true;
+    }
+    return false;
+}
+
+static void conferir_alocacao(void) {
+    recurso_conflito_t c[MAX_CONFLITOS];
+    uint32_t total = recursos_verificar(ALOCACAO_RECURSOS, NUM_ALOCACOES, c, MAX_CONFLITOS);
+    for (uint32_t i = 0; i < total && i < MAX_CONFLITOS; i++)
+        printf("  conflito: %s x %s (%s)\n", ALOCACAO_RECURSOS[c[i].a].dono, ALOCACAO_RECURSOS[c[i].b].dono,
+               recursos_nome_motivo(c[i].motivo));
+    conferir("alocacao da placa sem conflitos", total == 0);
+
+    // Regressão: buzzer 1 no PWM, com wrap e divisor por nota
+    recurso_pedido_t antiga[NUM_ALOCACOES];
+    for (uint32_t i = 0; i < NUM_ALOCACOES; i++) {
+        antiga[i] = ALOCACAO_RECURSOS[i];
+        if (antiga[i].gpio == BUZZER1_PIN)
+            antiga[i] = (recurso_pedido_t){"buzzer 1", RECURSO_PWM, BUZZER1_PIN, 0, 0, PERFIL_PWM_TOM};
+    }
+    conferir("alocacao antiga: buzzer 1 x LED verde no slice 5",
+             tem_conflito(antiga, NUM_ALOCACOES, CONFLITO_SLICE_PWM, "buzzer 1", "LED verde"));
+
+    static const char *A = "a", *B = "b";
+    recurso_pedido_t canal[] = {{A, RECURSO_PWM, 4, 0, 0, 0}, {B, RECURSO_PWM, 20, 0, 0, 0}};
+    conferir("GPIO 4 e 20 no mesmo canal de PWM", tem_conflito(canal, 2, CONFLITO_CANAL_PWM, A, B));
+    recurso_pedido_t mesmo_perfil[] = {{A, RECURSO_PWM, 4, 0, 0, 0}, {B, RECURSO_PWM, 5, 0, 0, 0}};
+    conferir("GPIO 4 e 5 com o mesmo perfil convivem", recursos_verificar(mesmo_perfil, 2, c, MAX_CONFLITOS) == 0);
+    recurso_pedido_t sm[] = {{A, RECURSO_PIO, 2, 1, 3, 0}, {B, RECURSO_PIO, 3, 1, 3, 0}};
+    conferir("mesma maquina de estados", tem_conflito(sm, 2, CONFLITO_PIO_SM, A, B));
+    recurso_pedido_t gpio[] = {{A, RECURSO_PIO, 9, 0, 1, 0}, {B, RECURSO_PWM, 9, 0, 0, 0}};
+    conferir("mesmo GPIO em PIO e PWM", tem_conflito(gpio, 2, CONFLITO_GPIO, A, B));
+    recurso_pedido_t invalido[] = {{A, RECURSO_PIO, 30, 2, 0, 0}};
+    conferir("GPIO e PIO inexistentes", tem_conflito(invalido, 1, CONFLITO_INVALIDO, A, A));
+}
+
+//-------------------------------------------------
+// Modelo do tom.pio: executa um pedido, uma instrução por tick
+//-------------------------------------------------
+typedef struct {
+    uint64_t ticks;        // Do primeiro pull até voltar a ele
+    uint64_t alto;         // Ticks com o pino em 1
+    uint32_t subidas;
+    bool pino_final;
+} execucao_t;
+
+static execucao_t executar(tom_pedido_t p) {
+    execucao_t e = {0};
+    bool pino = false;
+    e.ticks = 4;   // pull, mov isr, pull, out y
+    uint32_t isr = p.meio_periodo, y = p.periodos & ~TOM_NOTA_BIT, osr = p.periodos >> 31;
+    for (;;) {
+        bool novo = osr & 1u;   // mov pins, osr
+        e.subidas += novo && !pino;
+        pino = novo;
+        // mov pins + mov x + (x + 1) jmps: o pino fica no nível novo por x + 3 ticks
+        e.ticks += isr + 3u;
+        e.alto += pino ? isr + 3u : 0;
+        pino = false;           // set pins, 0; mov x; (x + 1) jmps; jmp y--
+        e.ticks += isr + 4u;
+        if (y-- == 0)
+            break;
+    }
+    e.pino_final = pino;
+    return e;
+}
+
+static void conferir_tons(void) {
+    double pior_freq = 0.0, pior_duracao_ms = 0.0;
+    bool pino_final_ok = true, periodo_ok = true, subidas_ok = true;
+    for (uint32_t f = 50; f <= 5000; f++) {
+        tom_pedido_t nota = TOM_NOTA(f, 200);
+        execucao_t e = executar(nota);
+        uint32_t periodos = (nota.periodos & ~TOM_NOTA_BIT) + 1u;
+        double obtida = (double)TOM_TICK_HZ / TOM_PERIODO(f);
+        double erro = (obtida - f) / f;
+        if (erro < 0)
+            erro = -erro;
+        if (erro > pior_freq)
+            pior_freq = erro;
+        periodo_ok &= e.ticks - 4u == (uint64_t)periodos * TOM_PERIODO(f);
+        subidas_ok &= e.subidas == periodos;
+        pino_final_ok &= !e.pino_final;
+        double duracao_ms = (double)e.ticks * 1000.0 / TOM_TICK_HZ;
+        double folga_ms = 0.5 * TOM_PERIODO(f) * 1000.0 / TOM_TICK_HZ;
+        double desvio = duracao_ms - 200.0;
+        if (desvio < 0)
+            desvio = -desvio;
+        if (desvio - folga_ms > pior_duracao_ms)
+            pior_duracao_ms = desvio - folga_ms;
+    }
+    printf("  pior erro de frequencia: %.3f%%\n", pior_freq * 100.0);
+    conferir("frequencia com erro < 0,5% (50 Hz a 5 kHz)", pior_freq < 0.005);
+    conferir("periodo do modelo = 2 * meio + TOM_CICLOS_FIXOS", periodo_ok);
+    conferir("uma subida por periodo", subidas_ok);
+    conferir("duracao de 200 ms dentro de meio periodo (+ 4 ticks)", pior_duracao_ms <= 0.004 + 1e-9);
+    conferir("pino em 0 ao fim da nota", pino_final_ok);
+
+    tom_pedido_t pausa = TOM_PAUSA(50);
+    execucao_t e = executar(pausa);
+    conferir("pausa sem nenhuma subida", e.subidas == 0 && e.alto == 0);
+    double pausa_ms = (double)e.ticks * 1000.0 / TOM_TICK_HZ;
+    conferir("pausa de 50 ms dentro de meio periodo", pausa_ms > 49.5 && pausa_ms < 50.5);
+    tom_pedido_t curta = TOM_NOTA(100, 1);
+    conferir("nota mais curta que um periodo toca um periodo", (curta.periodos & ~TOM_NOTA_BIT) == 0);
+}
+
+int main(void) {
+    imprimir_alocacao();
+    printf("\nRecursos:\n");
+    conferir_alocacao();
+    printf("\nTons (tick de %u Hz):\n", TOM_TICK_HZ);
+    conferir_tons();
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,306 @@
+//===============================================
+// Reprodução de formas de onda com repique nos botões (host)
+//
+// Amostra formas de onda com repique (bordas com resolução de 1 ms) no
+// mesmo período do firmware e passa a máscara por botoes_amostrar.
+// Confere a sequência de eventos (pressionado, solto, clique, longo,
+// repetição e combo), os instantes das repetições aceleradas, a
+// latência entre a borda real e o evento e o latencia_max_ms do motor.
+// Com --traco, reproduz uma captura em CSV (tempo_ms,botoes) e só
+// imprime os eventos e a latência.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o botoes_ondas tools/botoes_ondas.c include/botoes.c
+//
+// Uso: botoes_ondas [--traco captura.csv]   (código 1 se alguma verificação falhar)
+//===============================================
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "botoes.h"
+#include "controle.h"   // BOTAO_IDX_* e BOTAO_BIT, como no firmware
+
+#define PERIODO_AMOSTRA_MS 5   // INTERVALO_AMOSTRA_BOTOES_US do firmware
+#define MAX_EVENTOS 256
+#define MAX_BORDAS 4096
+// Pior latência aceitável depois do fim do repique: o debounce pede
+// BOTOES_AMOSTRAS_DEBOUNCE amostras iguais, mais uma de alinhamento
+#define LATENCIA_LIMITE_MS ((BOTOES_AMOSTRAS_DEBOUNCE + 1) * PERIODO_AMOSTRA_MS)
+
+#define NEXT BOTAO_BIT(BOTAO_IDX_NEXT)
+#define BACK BOTAO_BIT(BOTAO_IDX_BACK)
+#define SET BOTAO_BIT(BOTAO_IDX_SET)
+
+// Nível da máscara a partir de t_ms (até a próxima borda)
+typedef struct {
+    uint32_t t_ms;
+    uint8_t mascara;
+} borda_t;
+
+typedef struct {
+    uint8_t tipo;
+    uint8_t botao;
+    uint8_t mascara;
+} esperado_t;
+
+static const char *const NOMES[] = {"PRESSIONADO", "SOLTO", "CLIQUE", "LONGO", "REPETICAO", "COMBO"};
+
+static evento_botao_t eventos[MAX_EVENTOS];
+static uint32_t num_eventos;
+static int falhas;
+
+static void registrar(const evento_botao_t *ev) {
+    if (num_eventos < MAX_EVENTOS)
+        eventos[num_eventos] = *ev;
+    num_eventos++;
+}
+
+static void conferir(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+static void imprimir_eventos(void) {
+    for (uint32_t i = 0; i < num_eventos && i < MAX_EVENTOS; i++)
+        printf("    %6u ms  %-11s botao %u mascara 0x%02x rep %u\n", eventos[i].tempo_ms, NOMES[eventos[i].tipo],
+               eventos[i].botao, eventos[i].mascara, eventos[i].repeticoes);
+}
+
+// Reproduz as bordas de 0 a fim_ms no período do amostrador
+static void reproduzir(botoes_t *bt, const borda_t *bordas, uint32_t n, uint32_t fim_ms) {
+    botoes_init(bt, 3, NEXT | BACK, registrar);   // Mesma configuração do firmware
+    num_eventos = 0;
+    uint32_t k = 0;
+    uint8_t mascara = 0;
+    for (uint32_t t = 0; t <= fim_ms; t += PERIODO_AMOSTRA_MS) {
+        while (k < n && bordas[k].t_ms <= t)
+            mascara = bordas[k++].mascara;
+        botoes_amostrar(bt, mascara, t);
+    }
+}
+
+// Compara os eventos, ignorando REPETICAO e LONGO se 'so_borda'
+static bool sequencia(const esperado_t *esperados, uint32_t n, bool so_borda) {
+    uint32_t j = 0;
+    for (uint32_t i = 0; i < num_eventos && i < MAX_EVENTOS; i++) {
+        const evento_botao_t *ev = &eventos[i];
+        if (so_borda && (ev->tipo == BOTAO_EV_REPETICAO || ev->tipo == BOTAO_EV_LONGO))
+            continue;
+        if (j >= n || ev->tipo != esperados[j].tipo || ev->botao != esperados[j].botao ||
+            ev->mascara != esperados[j].mascara)
+            return false;
+        j++;
+    }
+    return j == n && num_eventos <= MAX_EVENTOS;
+}
+
+// Maior atraso entre o fim do repique (última borda antes do evento) e o evento
+static uint32_t latencia_real(const borda_t *bordas, uint32_t n) {
+    uint32_t pior = 0;
+    for (uint32_t i = 0; i < num_eventos && i < MAX_EVENTOS; i++) {
+        uint8_t tipo = eventos[i].tipo;
+        if (tipo != BOTAO_EV_PRESSIONADO && tipo != BOTAO_EV_SOLTO && tipo != BOTAO_EV_COMBO)
+            continue;
+        uint32_t ultima = 0;
+        for (uint32_t k = 0; k < n && bordas[k].t_ms <= eventos[i].tempo_ms; k++)
+            ultima = bordas[k].t_ms;
+        if (eventos[i].tempo_ms - ultima > pior)
+            pior = eventos[i].tempo_ms - ultima;
+    }
+    return pior;
+}
+
+//-------------------------------------------------
+// Formas de onda típicas de chaves táteis
+//-------------------------------------------------
+// Clique em NEXT com repique de 8 ms na descida e de 9 ms na subida
+static const borda_t CLIQUE_REPIQUE[] = {
+    {100, NEXT}, {102, 0}, {103, NEXT}, {106, 0}, {108, NEXT},
+    {400, 0}, {401, NEXT}, {404, 0}, {406, NEXT}, {409, 0},
+};
+
+// Repique longo (22 ms) com amostras caindo nos dois níveis
+static const borda_t REPIQUE_LONGO[] = {
+    {200, SET}, {204, 0}, {207, SET}, {211, 0}, {216, SET}, {219, 0}, {222, SET},
+    {700, 0}, {706, SET}, {709, 0}, {714, SET}, {718, 0},
+};
+
+// Picos isolados de uma e duas amostras: nenhum evento
+static const borda_t PICOS[] = {
+    {100, SET}, {103, 0}, {300, SET}, {310, 0}, {500, BACK}, {501, 0},
+};
+
+static void testar_cliques(void) {
+    botoes_t bt;
+    printf("Clique com repique em NEXT\n");
+    reproduzir(&bt, CLIQUE_REPIQUE, sizeof(CLIQUE_REPIQUE) / sizeof(CLIQUE_REPIQUE[0]), 1000);
+    static const esperado_t E1[] = {
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_SOLTO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_CLIQUE, BOTAO_IDX_NEXT, NEXT},
+    };
+    bool ok = sequencia(E1, 3, false);
+    if (!ok)
+        imprimir_eventos();
+    conferir("pressionado, solto, clique", ok);
+    uint32_t lat = latencia_real(CLIQUE_REPIQUE, sizeof(CLIQUE_REPIQUE) / sizeof(CLIQUE_REPIQUE[0]));
+    printf("  latencia real %u ms, latencia_max_ms %u ms\n", lat, bt.latencia_max_ms);
+    conferir("latencia apos o repique dentro do limite", lat <= LATENCIA_LIMITE_MS);
+    conferir("latencia_max_ms cobre o repique", bt.latencia_max_ms >= 15 && bt.latencia_max_ms <= 25);
+
+    printf("Repique longo em SET\n");
+    reproduzir(&bt, REPIQUE_LONGO, sizeof(REPIQUE_LONGO) / sizeof(REPIQUE_LONGO[0]), 1200);
+    static const esperado_t E2[] = {
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_SET, SET},
+        {BOTAO_EV_SOLTO, BOTAO_IDX_SET, SET},
+        {BOTAO_EV_CLIQUE, BOTAO_IDX_SET, SET},
+    };
+    ok = sequencia(E2, 3, false);
+    if (!ok)
+        imprimir_eventos();
+    conferir("um unico pressionado e um unico solto", ok);
+    lat = latencia_real(REPIQUE_LONGO, sizeof(REPIQUE_LONGO) / sizeof(REPIQUE_LONGO[0]));
+    printf("  latencia real %u ms, latencia_max_ms %u ms\n", lat, bt.latencia_max_ms);
+    conferir("latencia apos o repique dentro do limite", lat <= LATENCIA_LIMITE_MS);
+    // O motor mede a partir da primeira borda vista: inclui o repique
+    conferir("latencia_max_ms inclui o repique",
+             bt.latencia_max_ms >= 20 && bt.latencia_max_ms <= 22 + LATENCIA_LIMITE_MS);
+
+    printf("Picos isolados\n");
+    reproduzir(&bt, PICOS, sizeof(PICOS) / sizeof(PICOS[0]), 800);
+    conferir("nenhum evento", num_eventos == 0);
+}
+
+static void testar_longo(void) {
+    botoes_t bt;
+    printf("SET segurado por 1,5 s\n");
+    static const borda_t B[] = {{100, SET}, {1600, 0}};
+    reproduzir(&bt, B, 2, 2000);
+    static const esperado_t E[] = {
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_SET, SET},
+        {BOTAO_EV_LONGO, BOTAO_IDX_SET, SET},
+        {BOTAO_EV_SOLTO, BOTAO_IDX_SET, SET},
+    };
+    bool ok = sequencia(E, 3, false);
+    if (!ok)
+        imprimir_eventos();
+    conferir("pressionado, longo, solto (sem clique e sem repeticao)", ok);
+    conferir("longo BOTOES_LONGO_MS depois do pressionado",
+             num_eventos >= 2 && eventos[1].tempo_ms - eventos[0].tempo_ms == BOTOES_LONGO_MS);
+}
+
+static void testar_repeticao(void) {
+    botoes_t bt;
+    printf("NEXT segurado por 3 s (auto-repetição)\n");
+    static const borda_t B[] = {{1000, NEXT}, {4000, 0}};
+    reproduzir(&bt, B, 2, 4500);
+    // Instantes esperados: atraso inicial e intervalos encurtando 25% até o mínimo
+    uint32_t t_pressionado = num_eventos ? eventos[0].tempo_ms : 0;
+    uint32_t alvo = t_pressionado + BOTOES_REP_ATRASO_MS, intervalo = BOTOES_REP_INICIAL_MS;
+    uint32_t repeticoes = 0, fora = 0, ultimo_intervalo = 0;
+    bool longo = false;
+    for (uint32_t i = 0; i < num_eventos && i < MAX_EVENTOS; i++) {
+        const evento_botao_t *ev = &eventos[i];
+        if (ev->tipo == BOTAO_EV_LONGO)
+            longo = ev->tempo_ms - t_pressionado == BOTOES_LONGO_MS;
+        if (ev->tipo != BOTAO_EV_REPETICAO)
+            continue;
+        repeticoes++;
+        // O amostrador emite na primeira amostra a partir do alvo
+        if (ev->repeticoes != repeticoes || ev->tempo_ms < alvo || ev->tempo_ms >= alvo + PERIODO_AMOSTRA_MS)
+            fora++;
+        alvo += intervalo;
+        ultimo_intervalo = intervalo;
+        intervalo = intervalo * 3 / 4 < BOTOES_REP_MINIMO_MS ? BOTOES_REP_MINIMO_MS : intervalo * 3 / 4;
+    }
+    // Repetições até a soltura ser reconhecida (debounce depois da borda em 4000 ms)
+    uint32_t solto_ms = 4000 + (BOTOES_AMOSTRAS_DEBOUNCE - 1) * PERIODO_AMOSTRA_MS, esperadas = 0;
+    for (uint32_t a = t_pressionado + BOTOES_REP_ATRASO_MS, iv = BOTOES_REP_INICIAL_MS; a < solto_ms;
+         a += iv, iv = iv * 3 / 4 < BOTOES_REP_MINIMO_MS ? BOTOES_REP_MINIMO_MS : iv * 3 / 4)
+        esperadas++;
+    printf("  %u repeticoes (esperadas %u), %u fora do instante\n", repeticoes, esperadas, fora);
+    conferir("quantidade de repeticoes", repeticoes == esperadas);
+    conferir("cada repeticao no instante da aceleracao", fora == 0);
+    conferir("intervalo chega ao minimo", ultimo_intervalo == BOTOES_REP_MINIMO_MS);
+    conferir("longo tambem sai em botao com repeticao", longo);
+    static const esperado_t E[] = {
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_SOLTO, BOTAO_IDX_NEXT, NEXT},
+    };
+    conferir("sem clique apos a pressao longa", sequencia(E, 2, true));
+    conferir("solto informa as repeticoes",
+             num_eventos > 0 && num_eventos <= MAX_EVENTOS && eventos[num_eventos - 1].repeticoes == repeticoes);
+}
+
+static void testar_combo(void) {
+    botoes_t bt;
+    printf("NEXT + BACK (combo) com BACK ruidoso antes\n");
+    // BACK oscila a cada amostra antes do combo, sem atrasar o NEXT
+    borda_t b[64];
+    uint32_t n = 0;
+    for (uint32_t t = 0; t < 200; t += PERIODO_AMOSTRA_MS)
+        b[n++] = (borda_t){t, (uint8_t)((t / PERIODO_AMOSTRA_MS) % 2 ? BACK : 0)};
+    b[n++] = (borda_t){200, 0};
+    b[n++] = (borda_t){300, NEXT};
+    b[n++] = (borda_t){330, NEXT | BACK};
+    b[n++] = (borda_t){2000, BACK};
+    b[n++] = (borda_t){2040, 0};
+    b[n++] = (borda_t){2500, NEXT};
+    b[n++] = (borda_t){2600, 0};
+    reproduzir(&bt, b, n, 3000);
+    static const esperado_t E[] = {
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_COMBO, BOTAO_IDX_BACK, NEXT | BACK},
+        {BOTAO_EV_PRESSIONADO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_SOLTO, BOTAO_IDX_NEXT, NEXT},
+        {BOTAO_EV_CLIQUE, BOTAO_IDX_NEXT, NEXT},
+    };
+    bool ok = sequencia(E, sizeof(E) / sizeof(E[0]), false);
+    if (!ok)
+        imprimir_eventos();
+    conferir("combo suprime longo, repeticao e solturas", ok);
+    // Borda limpa em 300 ms: evento na quarta amostra igual
+    conferir("NEXT sem atraso pelo ruido em BACK",
+             num_eventos > 0 && eventos[0].tempo_ms == 300 + (BOTOES_AMOSTRAS_DEBOUNCE - 1) * PERIODO_AMOSTRA_MS);
+}
+
+// Captura em CSV: tempo_ms,botoes (linhas com '#' são comentários)
+static int reproduzir_arquivo(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f) {
+        perror(caminho);
+        return 2;
+    }
+    static borda_t bordas[MAX_BORDAS];
+    uint32_t n = 0;
+    char linha[128];
+    while (fgets(linha, sizeof(linha), f) && n < MAX_BORDAS) {
+        unsigned t, m;
+        if (linha[0] != '#' && sscanf(linha, "%u,%u", &t, &m) == 2)
+            bordas[n++] = (borda_t){t, (uint8_t)m};
+    }
+    fclose(f);
+    botoes_t bt;
+    reproduzir(&bt, bordas, n, n ? bordas[n - 1].t_ms + 1000 : 0);
+    imprimir_eventos();
+    printf("latencia real %u ms, latencia_max_ms %u ms\n", latencia_real(bordas, n), bt.latencia_max_ms);
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    if (argc == 3 && strcmp(argv[1], "--traco") == 0)
+        return reproduzir_arquivo(argv[2]);
+    if (argc != 1) {
+        fprintf(stderr, "uso: %s [--traco captura.csv]\n", argv[0]);
+        return 2;
+    }
+    testar_cliques();
+    testar_longo();
+    testar_repeticao();
+    testar_combo();
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
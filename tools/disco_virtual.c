@@ -0,0 +1,327 @@
+//===============================================
+// Verificação e medição do volume USB virtual (host)
+//
+// Monta o histórico sobre uma flash NOR simulada em RAM (apagar põe 0xFF,
+// programar só baixa bits) e confere:
+//   - partida com a região apagada e com lixo, continuação depois de um
+//     reinício e gravação interrompida por queda de energia;
+//   - anel dando várias voltas: a janela começa no registro mais antigo;
+//   - o volume gerado é um FAT16 válido (boot, FATs iguais, cadeia do
+//     arquivo, entrada no diretório) e cada linha do VIAGEM.CSV traz de
+//     volta os campos do registro correspondente;
+//   - setores lidos em qualquer ordem e em blocos de qualquer tamanho
+//     saem iguais aos da imagem inteira;
+//   - registros sobrescritos depois da montagem viram linhas em branco
+//     sem mudar o tamanho do arquivo.
+// Ao final mede a vazão do gerador com o anel cheio (512 KB), lendo em
+// blocos de 4 KB como o TinyUSB.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o disco_virtual tools/disco_virtual.c include/disco_fat.c
+//       include/historico.c include/zonas.c include/crc.c
+//
+// Uso: disco_virtual [--imagem arquivo.img]   (código 1 se alguma verificação falhar)
+// A imagem gravada pode ser conferida com fsck.fat -n ou montada com -o loop,ro.
+//===============================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "disco_fat.h"
+#include "zonas.h"
+
+#define KB 1024u
+#define REGIAO_MAX (512u * KB)
+
+static uint8_t flash[REGIAO_MAX];
+static int cortar_gravacao;   // > 0: a próxima programação grava só estes bytes
+static int falhas;
+static uint32_t estado_rng = 0x2545F491u;
+
+static uint32_t sortear(void) {
+    estado_rng ^= estado_rng << 13;
+    estado_rng ^= estado_rng >> 17;
+    estado_rng ^= estado_rng << 5;
+    return estado_rng;
+}
+
+static void conferir(bool ok, const char *o_que) {
+    if (!ok && falhas++ < 20)
+        printf("  FALHA: %s\n", o_que);
+}
+
+//===============================================
+// Flash NOR simulada
+//===============================================
+static bool apagar_sim(void *ctx, uint32_t deslocamento) {
+    (void)ctx;
+    memset(flash + deslocamento, 0xFF, HISTORICO_SETOR);
+    return true;
+}
+
+static bool programar_sim(void *ctx, uint32_t deslocamento, const void *dados, uint32_t len) {
+    (void)ctx;
+    if (cortar_gravacao > 0) {
+        len = (uint32_t)cortar_gravacao;
+        cortar_gravacao = 0;
+    }
+    for (uint32_t i = 0; i < len; i++)
+        flash[deslocamento + i] &= ((const uint8_t *)dados)[i];
+    return true;
+}
+
+static historico_flash_t flash_sim(uint32_t tamanho) {
+    historico_flash_t f = { flash, tamanho, apagar_sim, programar_sim, NULL };
+    return f;
+}
+
+// Registro com campos dentro da faixa das colunas (comparação exata)
+static historico_registro_t registro_sorteado(uint32_t tempo_s, uint8_t zona) {
+    historico_registro_t r = {
+        .tempo_s = tempo_s,
+        .zona = zona,
+        .estado = (uint8_t)sortear(),
+        .temp_cc = (int16_t)((int)(sortear() % 9000) - 3000),
+        .umidade_dm = (uint16_t)(sortear() % 1001),
+        .etileno_dm = (uint16_t)(sortear() % 10000),
+        .co2_ppm = (uint16_t)(sortear() % 65536),
+        .grau_minuto_dm = sortear() % 100000000u,
+        .fora_s = sortear() % 5000000u,
+    };
+    return r;
+}
+
+static void gravar(historico_t *h, uint32_t n) {
+    for (uint32_t i = 0; i < n; i++) {
+        historico_registro_t r = registro_sorteado(h->sequencia * 60u, (uint8_t)(h->sequencia % 3));
+        conferir(historico_gravar(h, &r), "gravação");
+    }
+}
+
+//===============================================
+// Leitura do FAT16 gerado, como faria o host
+//===============================================
+static uint16_t ler16(const uint8_t *p) {
+    return (uint16_t)(p[0] | p[1] << 8);
+}
+
+static uint32_t ler32(const uint8_t *p) {
+    return ler16(p) | (uint32_t)ler16(p + 2) << 16;
+}
+
+// Gera a imagem inteira e devolve o VIAGEM.CSV extraído pela cadeia da FAT
+static uint8_t *extrair_arquivo(const disco_fat_t *d, uint8_t **imagem_saida, uint32_t *tamanho) {
+    uint8_t *img = malloc((size_t)d->setores * DISCO_FAT_SETOR);
+    disco_fat_ler(d, 0, img, d->setores);
+    *imagem_saida = img;
+
+    const uint8_t *b = img;
+    conferir(b[510] == 0x55 && b[511] == 0xAA, "assinatura do setor de boot");
+    conferir(ler16(b + 11) == DISCO_FAT_SETOR, "bytes por setor");
+    uint32_t spc = b[13], reservados = ler16(b + 14), copias = b[16], raiz = ler16(b + 17);
+    uint32_t total = ler16(b + 19) ? ler16(b + 19) : ler32(b + 32), por_fat = ler16(b + 22);
+    conferir(total == d->setores, "total de setores");
+    conferir(memcmp(b + 54, "FAT16   ", 8) == 0, "tipo do sistema de arquivos");
+    uint32_t inicio_raiz = reservados + copias * por_fat;
+    uint32_t inicio_dados = inicio_raiz + raiz * 32 / DISCO_FAT_SETOR;
+    uint32_t clusters = (total - inicio_dados) / spc;
+    conferir(clusters >= 4085 && clusters <= 65524, "quantidade de clusters de FAT16");
+    conferir(por_fat * DISCO_FAT_SETOR / 2 >= clusters + 2, "FAT cobre todos os clusters");
+
+    const uint8_t *fat = img + reservados * DISCO_FAT_SETOR;
+    conferir(memcmp(fat, fat + por_fat * DISCO_FAT_SETOR, por_fat * DISCO_FAT_SETOR) == 0, "cópias da FAT iguais");
+    conferir(ler16(fat) == 0xFFF8 && ler16(fat + 2) == 0xFFFF, "entradas reservadas da FAT");
+
+    const uint8_t *dir = img + inicio_raiz * DISCO_FAT_SETOR;
+    conferir(dir[11] == 0x08 && memcmp(dir, "FRUITLIFE  ", 11) == 0, "rótulo do volume");
+    const uint8_t *e = dir + 32;
+    conferir(memcmp(e, "VIAGEM  CSV", 11) == 0 && e[11] == 0x01, "entrada do VIAGEM.CSV");
+    conferir(dir[64] == 0, "fim do diretório");
+    *tamanho = ler32(e + 28);
+
+    // Segue a cadeia de clusters
+    uint8_t *arquivo = malloc(*tamanho + 1);
+    uint32_t bytes_cluster = spc * DISCO_FAT_SETOR, lidos = 0, cluster = ler16(e + 26), passos = 0;
+    while (lidos < *tamanho && cluster >= 2 && cluster < clusters + 2 && passos++ <= clusters) {
+        uint32_t n = *tamanho - lidos < bytes_cluster ? *tamanho - lidos : bytes_cluster;
+        memcpy(arquivo + lidos, img + ((size_t)inicio_dados + (cluster - 2) * spc) * DISCO_FAT_SETOR, n);
+        lidos += n;
+        cluster = ler16(fat + 2 * cluster);
+    }
+    conferir(lidos == *tamanho && cluster >= 0xFFF8, "cadeia do arquivo termina no último cluster");
+    arquivo[*tamanho] = 0;
+    return arquivo;
+}
+
+// Confere cada linha contra o registro na posição correspondente do anel
+static void conferir_csv(const disco_fat_t *d, const char *csv, uint32_t tamanho, uint32_t *validas) {
+    const char *fim_cabecalho = strstr(csv, "\r\n");
+    conferir(fim_cabecalho && strncmp(csv, "registro,viagem,zona,tempo,", 27) == 0, "cabeçalho");
+    const char *p = fim_cabecalho + 2;
+    conferir((uint32_t)(csv + tamanho - p) == d->linhas * DISCO_FAT_LINHA, "tamanho do arquivo");
+    *validas = 0;
+    uint32_t anterior = 0;
+    for (uint32_t i = 0; i < d->linhas; i++, p += DISCO_FAT_LINHA) {
+        conferir(p[DISCO_FAT_LINHA - 2] == '\r' && p[DISCO_FAT_LINHA - 1] == '\n', "fim de linha");
+        const historico_registro_t *r = historico_posicao(d->historico, (d->primeiro + i) % d->historico->capacidade);
+        bool deve_ter = historico_valido(r) && r->sequencia < d->limite_sequencia;
+        unsigned seq, viagem, zona, horas, min, seg, co2;
+        double temp, umid, etileno, grau, fora;
+        char alarmes[5] = { 0 };
+        int n = sscanf(p, "%u,%u,%u,%u:%u:%u,%lf,%lf,%lf,%u,%4c,%lf,%lf", &seq, &viagem, &zona, &horas, &min, &seg,
+                       &temp, &umid, &etileno, &co2, alarmes, &grau, &fora);
+        if (!deve_ter) {
+            conferir(n <= 0, "linha em branco para posição inválida");
+            continue;
+        }
+        (*validas)++;
+        char esperado[5];
+        for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+            uint32_t a = r->estado & ZONA_ALARMES;
+            esperado[s] = (a & ZONA_ACIMA(s)) ? '+' : (a & ZONA_ABAIXO(s)) ? '-' : '.';
+        }
+        bool ok = n == 13 && seq == r->sequencia && viagem == r->viagem && zona == r->zona + 1u &&
+                  horas * 3600 + min * 60 + seg == r->tempo_s && (int)(temp * 100 + (temp < 0 ? -0.5 : 0.5)) == r->temp_cc &&
+                  (unsigned)(umid * 10 + 0.5) == r->umidade_dm && (unsigned)(etileno * 10 + 0.5) == r->etileno_dm &&
+                  co2 == r->co2_ppm && memcmp(alarmes, esperado, 4) == 0 &&
+                  (uint32_t)(grau * 10 + 0.5) == r->grau_minuto_dm && (uint32_t)(fora * 10 + 0.5) == r->fora_s / 6;
+        if (!ok && falhas < 20)
+            printf("  linha %u: %.*s", i, (int)DISCO_FAT_LINHA, p);
+        conferir(ok, "campos da linha iguais aos do registro");
+        conferir(*validas == 1 || seq > anterior, "linhas em ordem crescente de sequência");
+        anterior = seq;
+    }
+}
+
+// Setores em ordem e blocos sorteados devem sair iguais à imagem inteira
+static void conferir_acesso_aleatorio(const disco_fat_t *d, const uint8_t *img) {
+    static uint8_t bloco[16 * DISCO_FAT_SETOR];
+    for (int i = 0; i < 3000; i++) {
+        uint32_t n = 1 + sortear() % 16;
+        uint32_t setor = sortear() % (d->setores + 4);   // Inclui pedidos além do fim
+        disco_fat_ler(d, setor, bloco, n);
+        for (uint32_t k = 0; k < n; k++) {
+            const uint8_t *obtido = bloco + k * DISCO_FAT_SETOR;
+            if (setor + k < d->setores) {
+                conferir(memcmp(obtido, img + (size_t)(setor + k) * DISCO_FAT_SETOR, DISCO_FAT_SETOR) == 0,
+                         "setor lido fora de ordem igual ao da imagem");
+            } else {
+                bool zeros = true;
+                for (uint32_t j = 0; j < DISCO_FAT_SETOR; j++)
+                    zeros = zeros && obtido[j] == 0;
+                conferir(zeros, "setor além do volume zerado");
+            }
+        }
+    }
+}
+
+static void verificar_volume(const char *titulo, const disco_fat_t *d, const char *caminho) {
+    uint8_t *img;
+    uint32_t tamanho, validas;
+    char *csv = (char *)extrair_arquivo(d, &img, &tamanho);
+    conferir_csv(d, csv, tamanho, &validas);
+    conferir_acesso_aleatorio(d, img);
+    printf("%s: %u setores, %u por cluster, %u linhas (%u válidas), %u bytes\n", titulo, d->setores,
+           d->setores_por_cluster, d->linhas, validas, tamanho);
+    if (caminho) {
+        FILE *f = fopen(caminho, "wb");
+        if (!f || fwrite(img, DISCO_FAT_SETOR, d->setores, f) != d->setores)
+            conferir(false, "gravação da imagem");
+        if (f)
+            fclose(f);
+    }
+    free(csv);
+    free(img);
+}
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    const char *caminho = argc > 2 && strcmp(argv[1], "--imagem") == 0 ? argv[2] : NULL;
+    static historico_t h;
+    static disco_fat_t d;
+    const uint32_t pequena = 16 * HISTORICO_SETOR;   // 2048 registros: várias voltas em pouco tempo
+
+    // Região apagada: começa do zero, continua depois de um reinício
+    memset(flash, 0xFF, sizeof(flash));
+    historico_init(&h, flash_sim(pequena), true);
+    conferir(h.sequencia == 0 && h.proximo == 0 && h.viagem == 1, "partida com a região apagada");
+    gravar(&h, 100);
+    historico_init(&h, flash_sim(pequena), false);
+    conferir(h.sequencia == 100 && h.proximo == 100 && h.viagem == 1, "continuação após reinício a quente");
+    historico_init(&h, flash_sim(pequena), true);
+    conferir(h.viagem == 2, "partida a frio incrementa a viagem");
+    disco_fat_init(&d, &h);
+    conferir(d.primeiro == 0 && d.linhas == 100, "janela antes da primeira volta");
+    verificar_volume("Região apagada, 100 registros", &d, NULL);
+
+    // Região com lixo (ex.: firmware antigo): nada é aproveitado
+    for (uint32_t i = 0; i < pequena; i++)
+        flash[i] = (uint8_t)sortear();
+    historico_init(&h, flash_sim(pequena), true);
+    conferir(h.sequencia == 0 && h.proximo == 0, "partida com lixo na região");
+    gravar(&h, 300);
+    disco_fat_init(&d, &h);
+    conferir(d.primeiro == 0 && d.linhas == 300, "lixo à frente não entra na janela");
+    verificar_volume("Região com lixo, 300 registros", &d, NULL);
+
+    // Várias voltas no anel
+    gravar(&h, 3 * h.capacidade + 777);
+    historico_init(&h, flash_sim(pequena), false);
+    disco_fat_init(&d, &h);
+    const historico_registro_t *primeiro = historico_posicao(&h, d.primeiro);
+    conferir(d.linhas > h.capacidade - HISTORICO_POR_SETOR && d.linhas <= h.capacidade, "janela com o anel cheio");
+    conferir(historico_valido(primeiro) && primeiro->sequencia == h.sequencia - d.linhas, "janela começa no mais antigo");
+    verificar_volume("Anel após 3 voltas", &d, NULL);
+
+    // Queda de energia no meio de uma gravação: o registro falha no CRC,
+    // a partida seguinte continua depois do último válido e a gravação
+    // pula para o próximo setor
+    uint32_t seq_antes = h.sequencia;
+    cortar_gravacao = 12;
+    historico_registro_t r = registro_sorteado(0, 0);
+    historico_gravar(&h, &r);
+    historico_init(&h, flash_sim(pequena), false);
+    conferir(h.sequencia == seq_antes, "registro interrompido é descartado");
+    gravar(&h, 5);
+    conferir((h.proximo + h.capacidade - 5) % h.capacidade % HISTORICO_POR_SETOR == 0,
+             "gravação recomeça no início do setor seguinte");
+    disco_fat_init(&d, &h);
+    verificar_volume("Após gravação interrompida", &d, NULL);
+
+    // Instantâneo: o que for sobrescrito depois da montagem fica em branco
+    disco_fat_init(&d, &h);
+    uint32_t tamanho_antes = d.tamanho_arquivo;
+    gravar(&h, 2 * HISTORICO_POR_SETOR + 10);
+    conferir(d.tamanho_arquivo == tamanho_antes, "tamanho congelado");
+    verificar_volume("Instantâneo com 266 registros sobrescritos", &d, NULL);
+
+    // Anel cheio do tamanho padrão e vazão do gerador
+    memset(flash, 0xFF, sizeof(flash));
+    historico_init(&h, flash_sim(REGIAO_MAX), true);
+    gravar(&h, h.capacidade + 1000);
+    disco_fat_init(&d, &h);
+    verificar_volume("Anel de 512 KB cheio", &d, caminho);
+
+    static uint8_t bloco[4096];
+    const uint32_t por_bloco = sizeof(bloco) / DISCO_FAT_SETOR;
+    uint64_t bytes = 0;
+    double inicio = agora_s(), decorrido;
+    do {
+        for (uint32_t s = d.inicio_dados; s < d.inicio_dados + d.tamanho_arquivo / DISCO_FAT_SETOR; s += por_bloco) {
+            disco_fat_ler(&d, s, bloco, por_bloco);
+            bytes += sizeof(bloco);
+        }
+        decorrido = agora_s() - inicio;
+    } while (decorrido < 1.0);
+    printf("Gerador: %.1f MB/s (%.0f linhas/s) lendo em blocos de 4 KB\n", bytes / decorrido / 1e6,
+           bytes / (double)DISCO_FAT_LINHA / decorrido);
+
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,217 @@
+//===============================================
+// Orçamento de energia num ciclo de trabalho roteirizado (host)
+//
+// Reproduz a política do laço principal num relógio virtual: amostras a
+// cada 50/250/1000 ms conforme a tela, CPU acordada por um tempo fixo de
+// processamento por amostra (mais longo a 48 MHz) e __wfi no resto, tela
+// escurecendo e apagando por inatividade, botões e beeps roteirizados.
+// Tudo passa por energia_definir/energia_contabilizar como no firmware.
+// Confere ciclo de trabalho, corrente média, carga e autonomia contra o
+// valor calculado à parte e contra limites de orçamento: um aumento de
+// consumo (tabela de correntes, tempos da tela, períodos de amostra)
+// derruba a verificação.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o energia_orcamento tools/energia_orcamento.c include/energia.c -lm
+//
+// Uso: energia_orcamento   (código 1 se alguma verificação falhar)
+//===============================================
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+#include "energia.h"
+
+// Parâmetros do firmware (projeto-final.c)
+#define TEMPO_ESCURECER_MS 30000
+#define TEMPO_APAGAR_MS 120000
+#define PERIODO_AMOSTRA_ATIVA_MS 50
+#define PERIODO_AMOSTRA_ESCURECIDA_MS 250
+#define PERIODO_AMOSTRA_APAGADA_MS 1000
+#define CLOCK_PLENO_KHZ 125000
+#define CLOCK_REDUZIDO_KHZ 48000
+
+// Processamento por amostra a 125 MHz (leitura, controle, OLED, matriz)
+#define PROCESSAMENTO_US 3000
+#define BATERIA_MAH 2000.0f
+
+// Limites de orçamento (cerca de 3% acima do consumo atual): falham se o consumo subir
+#define LIMITE_OCIOSO_UA 22500         // Uma hora sem operador
+#define LIMITE_TURNO_UA 37500          // Turno com operador e alarmes
+#define AUTONOMIA_MIN_OCIOSO_H 88.0f
+
+#define S_US 1000000ull
+
+typedef enum { ROTEIRO_BOTAO, ROTEIRO_BEEP } roteiro_tipo_t;
+
+typedef struct {
+    uint64_t t_us;
+    uint8_t tipo;          // roteiro_tipo_t
+    uint32_t duracao_ms;   // ROTEIRO_BEEP
+} roteiro_t;
+
+static int falhas;
+static uint32_t corrente[ENERGIA_NUM_SUBSISTEMAS][ENERGIA_NUM_NIVEIS];   // Tabela lida pela API
+
+static void conferir(const char *nome, double obtido, double esperado, double tolerancia) {
+    bool ok = fabs(obtido - esperado) <= tolerancia;
+    printf("  %-34s %12.3f %12.3f  %s\n", nome, obtido, esperado, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+static void limite(const char *nome, double obtido, double maximo) {
+    bool ok = obtido <= maximo;
+    printf("  %-34s %12.3f <= %9.3f  %s\n", nome, obtido, maximo, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+// Corrente de cada nível, medida pela própria API (um segundo em cada)
+static void ler_tabela(void) {
+    for (int n = 0; n < ENERGIA_NUM_NIVEIS; n++) {
+        energia_t e;
+        energia_init(&e, 0, TEMPO_ESCURECER_MS, TEMPO_APAGAR_MS);
+        for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+            energia_definir(&e, (energia_subsistema_t)s, (energia_nivel_t)n, 0);
+        energia_contabilizar(&e, S_US);
+        for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+            corrente[s][n] = energia_corrente_subsistema_ua(&e, (energia_subsistema_t)s);
+    }
+}
+
+static uint32_t periodo_ms(energia_tela_t tela) {
+    if (tela == TELA_APAGADA)
+        return PERIODO_AMOSTRA_APAGADA_MS;
+    if (tela == TELA_ESCURECIDA)
+        return PERIODO_AMOSTRA_ESCURECIDA_MS;
+    return PERIODO_AMOSTRA_ATIVA_MS;
+}
+
+// Executa o roteiro por 'duracao_us' a partir de t = 0
+static void executar(energia_t *e, const roteiro_t *roteiro, uint32_t n, uint64_t duracao_us) {
+    energia_init(e, 0, TEMPO_ESCURECER_MS, TEMPO_APAGAR_MS);
+    uint32_t clock_khz = CLOCK_PLENO_KHZ, k = 0;
+    uint64_t fim_beep = 0;
+    bool beep = false;
+    for (uint64_t t = 0; t < duracao_us;) {
+        // Botões e alarmes do roteiro até esta amostra
+        for (; k < n && roteiro[k].t_us <= t; k++) {
+            energia_atividade(e, t);
+            if (roteiro[k].tipo == ROTEIRO_BEEP) {
+                energia_definir(e, ENERGIA_BUZZER, ENERGIA_PLENO, t);
+                fim_beep = t + roteiro[k].duracao_ms * 1000ull;
+                beep = true;
+            }
+        }
+        energia_tela_t tela = energia_avaliar_tela(e, t);
+        uint32_t khz = tela == TELA_APAGADA ? CLOCK_REDUZIDO_KHZ : CLOCK_PLENO_KHZ;
+        if (khz != clock_khz) {
+            clock_khz = khz;
+            energia_definir(e, ENERGIA_CPU, khz == CLOCK_PLENO_KHZ ? ENERGIA_PLENO : ENERGIA_REDUZIDO, t);
+        }
+        // O laço desliga o buzzer na primeira volta depois do fim do tom
+        if (beep && t >= fim_beep) {
+            energia_definir(e, ENERGIA_BUZZER, ENERGIA_DESLIGADO, t);
+            beep = false;
+        }
+        uint64_t acordado = (uint64_t)PROCESSAMENTO_US * CLOCK_PLENO_KHZ / clock_khz;
+        uint64_t prazo = t + periodo_ms(tela) * 1000ull;
+        if (prazo > duracao_us)
+            prazo = duracao_us;
+        energia_contabilizar(e, t + acordado);
+        energia_definir(e, ENERGIA_CPU, ENERGIA_DESLIGADO, t + acordado);
+        energia_definir(e, ENERGIA_CPU, clock_khz == CLOCK_PLENO_KHZ ? ENERGIA_PLENO : ENERGIA_REDUZIDO, prazo);
+        energia_contabilizar(e, prazo);
+        t = prazo;
+    }
+}
+
+// Uma hora sem operador depois de um botão: tempos calculados à parte
+static void hora_ociosa(void) {
+    printf("Hora ociosa (botao em t = 0)\n");
+    energia_t e;
+    static const roteiro_t ROTEIRO[] = {{0, ROTEIRO_BOTAO, 0}};
+    executar(&e, ROTEIRO, 1, 3600 * S_US);
+
+    // Tela ativa 30 s, escurecida 90 s e apagada 3480 s
+    double ativa_s = TEMPO_ESCURECER_MS / 1000.0, escura_s = (TEMPO_APAGAR_MS - TEMPO_ESCURECER_MS) / 1000.0;
+    double apagada_s = 3600.0 - ativa_s - escura_s;
+    double amostras_plenas =
+        ativa_s * 1000.0 / PERIODO_AMOSTRA_ATIVA_MS + escura_s * 1000.0 / PERIODO_AMOSTRA_ESCURECIDA_MS;
+    double amostras_reduzidas = apagada_s * 1000.0 / PERIODO_AMOSTRA_APAGADA_MS;
+    double pleno_s = amostras_plenas * PROCESSAMENTO_US / 1e6;
+    double reduzido_s =
+        amostras_reduzidas * PROCESSAMENTO_US * ((double)CLOCK_PLENO_KHZ / CLOCK_REDUZIDO_KHZ) / 1e6;
+    double dormindo_s = 3600.0 - pleno_s - reduzido_s;
+
+    conferir("ciclo CPU (milesimos)", energia_ciclo_trabalho(&e, ENERGIA_CPU),
+             (pleno_s + reduzido_s) / 3.6, 1.0);
+    conferir("ciclo OLED (milesimos)", energia_ciclo_trabalho(&e, ENERGIA_OLED), (ativa_s + escura_s) / 3.6, 1.0);
+    conferir("ciclo matriz (milesimos)", energia_ciclo_trabalho(&e, ENERGIA_MATRIZ), (ativa_s + escura_s) / 3.6,
+             1.0);
+    conferir("ciclo buzzer (milesimos)", energia_ciclo_trabalho(&e, ENERGIA_BUZZER), 0.0, 0.0);
+
+    double cpu_ua = (pleno_s * corrente[ENERGIA_CPU][ENERGIA_PLENO] +
+                     reduzido_s * corrente[ENERGIA_CPU][ENERGIA_REDUZIDO] +
+                     dormindo_s * corrente[ENERGIA_CPU][ENERGIA_DESLIGADO]) / 3600.0;
+    double tela_ua = 0.0;
+    for (int s = ENERGIA_OLED; s <= ENERGIA_MATRIZ; s++)
+        tela_ua += (ativa_s * corrente[s][ENERGIA_PLENO] + escura_s * corrente[s][ENERGIA_REDUZIDO] +
+                    apagada_s * corrente[s][ENERGIA_DESLIGADO]) / 3600.0;
+    double media_ua = cpu_ua + tela_ua + corrente[ENERGIA_BUZZER][ENERGIA_DESLIGADO];
+    double media = energia_corrente_media_ua(&e);
+    // A API trunca cada subsistema para µA inteiros
+    conferir("corrente media (uA)", media, media_ua, ENERGIA_NUM_SUBSISTEMAS);
+    conferir("carga (mAh)", energia_carga_mah(&e), media_ua / 1000.0, 0.01);
+    conferir("autonomia (h)", energia_autonomia_h(&e, BATERIA_MAH), BATERIA_MAH / (media_ua / 1000.0), 0.1);
+    limite("corrente media (uA)", media, LIMITE_OCIOSO_UA);
+    double autonomia = energia_autonomia_h(&e, BATERIA_MAH);
+    bool ok = autonomia >= AUTONOMIA_MIN_OCIOSO_H;
+    printf("  %-34s %12.3f >= %9.3f  %s\n", "autonomia (h)", autonomia, (double)AUTONOMIA_MIN_OCIOSO_H,
+           ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+// Turno de 8 h: botão a cada 5 min e beep de alarme de 200 ms a cada 10 min
+static void turno(void) {
+    printf("Turno de 8 h com operador e alarmes\n");
+    static roteiro_t roteiro[8 * 12 + 8 * 6];
+    uint32_t n = 0;
+    for (uint64_t t = 0; t < 8 * 3600 * S_US; t += 300 * S_US)
+        roteiro[n++] = (roteiro_t){t, ROTEIRO_BOTAO, 0};
+    for (uint64_t t = 150 * S_US; t < 8 * 3600 * S_US; t += 600 * S_US)
+        roteiro[n++] = (roteiro_t){t, ROTEIRO_BEEP, 200};
+    // Ordena por instante (inserção: a lista é pequena)
+    for (uint32_t i = 1; i < n; i++)
+        for (uint32_t j = i; j > 0 && roteiro[j].t_us < roteiro[j - 1].t_us; j--) {
+            roteiro_t x = roteiro[j];
+            roteiro[j] = roteiro[j - 1];
+            roteiro[j - 1] = x;
+        }
+    energia_t e;
+    executar(&e, roteiro, n, 8 * 3600 * S_US);
+
+    // Cada botão ou beep dá 120 s de tela; a cada 10 min há três (0, 150 e
+    // 300 s). O roteiro é atendido na amostra seguinte: até 1 s de atraso
+    // com a tela apagada
+    conferir("ciclo OLED (milesimos)", energia_ciclo_trabalho(&e, ENERGIA_OLED), 3 * 120.0 / 600.0 * 1000.0, 3.0);
+    // 48 beeps de 200 ms; o laço desliga o buzzer numa amostra de 50 ms
+    double beep_s = e.tempo_us[ENERGIA_BUZZER][ENERGIA_PLENO] / 1e6;
+    conferir("buzzer ligado (s)", beep_s, 48 * 0.2, 48 * PERIODO_AMOSTRA_ATIVA_MS / 1000.0);
+    limite("corrente media (uA)", energia_corrente_media_ua(&e), LIMITE_TURNO_UA);
+    conferir("carga (mAh)", energia_carga_mah(&e), energia_corrente_media_ua(&e) / 1000.0 * 8.0, 0.05);
+}
+
+int main(void) {
+    ler_tabela();
+    printf("Correntes por nivel (uA): desligado / reduzido / pleno\n");
+    static const char *const NOMES[] = {"CPU", "OLED", "matriz", "buzzer"};
+    for (int s = 0; s < ENERGIA_NUM_SUBSISTEMAS; s++)
+        printf("  %-8s %6u %6u %6u\n", NOMES[s], corrente[s][0], corrente[s][1], corrente[s][2]);
+    hora_ociosa();
+    turno();
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
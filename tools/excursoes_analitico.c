@@ -0,0 +1,136 @@
+//===============================================
+// Verificação das integrais de excursão contra traços analíticos (host)
+//
+// Alimenta excursoes.c com sinais de integral conhecida (triângulo,
+// senoide e degrau), amostrados com períodos de 50 ms a vários segundos
+// e com intervalos irregulares, e confere grau-minuto, tempo fora,
+// quantidade, excursão mais longa e pico. Também interrompe uma
+// execução no meio, como num reinício a quente, e confere que o estado
+// restaurado continua a contagem.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o excursoes_analitico tools/excursoes_analitico.c
+//       include/excursoes.c include/zonas.c -lm
+//
+// Uso: excursoes_analitico   (código 1 se alguma verificação falhar)
+//===============================================
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "excursoes.h"
+
+#define MINUTO_MS 60000u
+
+typedef double (*sinal_t)(double minutos);
+
+static int falhas;
+static uint32_t estado_rng = 0x9e3779b9u;
+
+static uint32_t sortear(void) {
+    estado_rng ^= estado_rng << 13;
+    estado_rng ^= estado_rng >> 17;
+    estado_rng ^= estado_rng << 5;
+    return estado_rng;
+}
+
+static void conferir(const char *nome, double obtido, double esperado, double tolerancia) {
+    bool ok = fabs(obtido - esperado) <= tolerancia;
+    printf("  %-34s %12.3f %12.3f  %s\n", nome, obtido, esperado, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+// Triângulo de 10 a 20 °C e de volta em 20 min
+static double triangulo(double m) {
+    return m <= 10.0 ? 10.0 + m : 30.0 - m;
+}
+
+// Senoide de 12,5 ± 5 °C com período de 60 min
+static double senoide(double m) {
+    return 12.5 + 5.0 * sin(2.0 * M_PI * m / 60.0);
+}
+
+// Degrau: 8 ppm entre 5 e 35 min, 2 ppm fora disso
+static double degrau(double m) {
+    return (m >= 5.0 && m < 35.0) ? 8.0 : 2.0;
+}
+
+// Amostra o sinal de 0 a 'duracao' minutos; periodo_ms = 0 sorteia de 20 a 1500 ms.
+// Com 'reiniciar', salva e restaura o estado na metade, com o relógio recomeçando.
+static void amostrar(excursoes_t *e, cal_canal_t sensor, sinal_t sinal, double duracao, uint32_t periodo_ms,
+                     bool reiniciar) {
+    static zonas_t z;
+    zona_limites_t l;
+    const float inferior[ZONA_NUM_SENSORES] = { 3.0f, 10.0f, 90.0f, 0.0f };
+    const float superior[ZONA_NUM_SENSORES] = { 7.0f, 15.0f, 100.0f, 800.0f };
+    zona_limites_preencher(&l, inferior, superior);
+    zonas_init(&z, NULL);
+    // Sensores fora do teste ficam dentro da faixa
+    const float neutro[ZONA_NUM_SENSORES] = { 1.0f, 12.0f, 95.0f, 400.0f };
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++)
+        z.valor[s][0] = neutro[s];
+
+    excursoes_init(e, NULL);
+    uint32_t fim_ms = (uint32_t)(duracao * MINUTO_MS);
+    uint32_t base_ms = 5000;   // Relógio do boot não começa em 0
+    bool reiniciado = false;
+    for (uint32_t t = 0;;) {
+        if (reiniciar && !reiniciado && t >= fim_ms / 2) {
+            excursoes_t salvo = *e;
+            excursoes_init(e, &salvo);
+            base_ms = 1000u - t;   // Novo boot: relógio volta perto de zero
+            reiniciado = true;
+        }
+        z.valor[sensor][0] = (float)sinal(t / (double)MINUTO_MS);
+        zonas_processar(&z, &l, 1);
+        excursoes_processar(e, &z, &l, 1, base_ms + t);
+        if (t == fim_ms)
+            break;
+        uint32_t passo = periodo_ms ? periodo_ms : 20 + sortear() % 1481;
+        t = t + passo > fim_ms ? fim_ms : t + passo;
+    }
+}
+
+static void verificar(const char *titulo, cal_canal_t sensor, sinal_t sinal, double duracao, double integral,
+                      double fora_min, unsigned contagem, double maior_min, double desvio_pico, bool reiniciar) {
+    static const uint32_t PERIODOS[] = { 50, 1000, 7000, 0 };
+    for (unsigned i = 0; i < sizeof(PERIODOS) / sizeof(PERIODOS[0]); i++) {
+        excursoes_t e;
+        amostrar(&e, sensor, sinal, duracao, PERIODOS[i], reiniciar);
+        if (PERIODOS[i])
+            printf("%s, amostras a cada %u ms%s\n", titulo, PERIODOS[i], reiniciar ? ", com reinício" : "");
+        else
+            printf("%s, amostras irregulares%s\n", titulo, reiniciar ? ", com reinício" : "");
+        // Amostras espaçadas cortam os vértices: tolerância proporcional ao período
+        double passo_min = (PERIODOS[i] ? PERIODOS[i] : 1500) / (double)MINUTO_MS;
+        conferir("unidade x minuto", excursoes_unidade_minuto(&e, sensor, 0), integral,
+                 0.002 * integral + 2.0 * passo_min);
+        conferir("minutos fora da faixa", e.tempo_fora_ms[sensor][0] / (double)MINUTO_MS, fora_min,
+                 0.002 * fora_min + (reiniciar ? 2.0 : 1.0) * passo_min);
+        conferir("excursões", e.contagem[sensor][0], contagem, 0);
+        conferir("mais longa (min)", e.maior_ms[sensor][0] / (double)MINUTO_MS, maior_min,
+                 0.002 * maior_min + (reiniciar ? 2.0 : 1.0) * passo_min);
+        conferir("desvio no pico", e.pico_desvio[sensor][0], desvio_pico, 0.05 + 10.0 * passo_min);
+    }
+}
+
+int main(void) {
+    // Triângulo acima de 15 °C entre 5 e 15 min: base 10 min, altura 5 °C
+    verificar("Triângulo de temperatura", CAL_TEMP, triangulo, 20.0, 25.0, 10.0, 1, 10.0, 5.0, false);
+
+    // Senoide: em cada período, 20 min acima de 15 °C e 20 min abaixo de 10 °C.
+    // Área de cada lóbulo: (5·√3 − 2,5·2π/3) · 60 / 2π grau-minuto
+    double lobulo = (5.0 * sqrt(3.0) - 2.5 * 2.0 * M_PI / 3.0) * 60.0 / (2.0 * M_PI);
+    verificar("Senoide de temperatura (3 períodos)", CAL_TEMP, senoide, 180.0, 6.0 * lobulo, 120.0, 6, 20.0, 2.5,
+              false);
+    verificar("Senoide de temperatura (3 períodos)", CAL_TEMP, senoide, 180.0, 6.0 * lobulo, 120.0, 6, 20.0, 2.5,
+              true);
+
+    // Degrau de etileno 1 ppm acima do limite por 30 min (borda vertical:
+    // a interpolação entre amostras espalha meio período em cada borda)
+    verificar("Degrau de etileno", CAL_ETILENO, degrau, 40.0, 30.0, 30.0, 1, 30.0, 1.0, false);
+
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,266 @@
+//===============================================
+// Fuzz da camada de rasterização (host)
+//
+// Sorteia primitivas com coordenadas dentro e muito fora da tela e
+// confere, contra uma referência ingênua que testa cada pixel:
+//   - nenhum byte fora do quadro é escrito (guardas antes e depois, e
+//     AddressSanitizer/UBSan se compilado com -fsanitize);
+//   - pixels, trechos, retângulos e glifos produzem exatamente o mesmo
+//     quadro, assim como linhas inteiramente dentro da tela;
+//   - linhas recortadas só acendem pixels a no máximo 1 pixel da linha
+//     de referência (o recorte arredonda as extremidades para a borda).
+// Ao final mede o custo das duas versões.
+//
+// Compilação:
+//   gcc -O2 -g -fsanitize=address,undefined -Iinclude -o fuzz_raster
+//       tools/fuzz_raster.c include/raster.c
+//
+// Uso: fuzz_raster [iterações] [semente]
+//===============================================
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "raster.h"
+
+#define LARGURA 128
+#define ALTURA 64
+#define PAGINAS (ALTURA / 8)
+#define TAMANHO (LARGURA * PAGINAS)
+#define GUARDA 64
+#define GUARDA_VALOR 0xA5
+#define FAIXA 400   // Coordenadas sorteadas em [-FAIXA, LARGURA + FAIXA)
+
+static uint8_t memoria[GUARDA + TAMANHO + GUARDA];
+static uint8_t esperado[TAMANHO];
+static uint32_t estado_rng;
+
+static uint32_t sortear(void) {
+    // xorshift32: determinístico para a mesma semente
+    estado_rng ^= estado_rng << 13;
+    estado_rng ^= estado_rng >> 17;
+    estado_rng ^= estado_rng << 5;
+    return estado_rng;
+}
+
+static int coordenada(void) {
+    // Metade das vezes perto da tela, para exercitar as bordas
+    if (sortear() & 1)
+        return (int)(sortear() % (LARGURA + 16)) - 8;
+    return (int)(sortear() % (2 * FAIXA + LARGURA)) - FAIXA;
+}
+
+//===============================================
+// Referência: Bresenham e laços com teste por pixel
+//===============================================
+static void ref_pixel(uint8_t *q, int x, int y, bool v) {
+    if (x < 0 || x >= LARGURA || y < 0 || y >= ALTURA)
+        return;
+    uint8_t bit = (uint8_t)(1u << (y & 7));
+    if (v)
+        q[x * PAGINAS + y / 8] |= bit;
+    else
+        q[x * PAGINAS + y / 8] &= (uint8_t)~bit;
+}
+
+static bool ref_ligado(const uint8_t *q, int x, int y) {
+    return q[x * PAGINAS + y / 8] & (1u << (y & 7));
+}
+
+static void ref_hspan(uint8_t *q, int x0, int x1, int y, bool v) {
+    if (x0 > x1) { int t = x0; x0 = x1; x1 = t; }
+    for (int x = x0; x <= x1; x++)
+        ref_pixel(q, x, y, v);
+}
+
+static void ref_vspan(uint8_t *q, int x, int y0, int y1, bool v) {
+    if (y0 > y1) { int t = y0; y0 = y1; y1 = t; }
+    for (int y = y0; y <= y1; y++)
+        ref_pixel(q, x, y, v);
+}
+
+static void ref_retangulo(uint8_t *q, int x, int y, int l, int a, bool v, bool cheio) {
+    if (l <= 0 || a <= 0)
+        return;
+    if (cheio) {
+        for (int c = x; c < x + l; c++)
+            ref_vspan(q, c, y, y + a - 1, v);
+        return;
+    }
+    ref_hspan(q, x, x + l - 1, y, v);
+    ref_hspan(q, x, x + l - 1, y + a - 1, v);
+    ref_vspan(q, x, y, y + a - 1, v);
+    ref_vspan(q, x + l - 1, y, y + a - 1, v);
+}
+
+static void ref_linha(uint8_t *q, int x0, int y0, int x1, int y1, bool v) {
+    int dx = abs(x1 - x0), dy = abs(y1 - y0);
+    int sx = x0 < x1 ? 1 : -1, sy = y0 < y1 ? 1 : -1;
+    int err = dx - dy;
+    for (;;) {
+        ref_pixel(q, x0, y0, v);
+        if (x0 == x1 && y0 == y1)
+            break;
+        int e2 = 2 * err;
+        if (e2 > -dy) { err -= dy; x0 += sx; }
+        if (e2 < dx) { err += dx; y0 += sy; }
+    }
+}
+
+static void ref_glifo(uint8_t *q, const uint8_t g[8], int x, int y) {
+    for (int i = 0; i < 8; i++)
+        for (int j = 0; j < 8; j++)
+            ref_pixel(q, x + i, y + j, g[i] & (1u << j));
+}
+
+//===============================================
+// Verificações
+//===============================================
+static unsigned long falhas;
+
+static void falhar(unsigned long it, const char *prim, const char *motivo) {
+    if (falhas++ < 10)
+        fprintf(stderr, "iteração %lu (%s): %s\n", it, prim, motivo);
+}
+
+static void conferir_guardas(unsigned long it, const char *prim) {
+    for (int i = 0; i < GUARDA; i++) {
+        if (memoria[i] != GUARDA_VALOR || memoria[GUARDA + TAMANHO + i] != GUARDA_VALOR) {
+            falhar(it, prim, "escrita fora do quadro");
+            memset(memoria, GUARDA_VALOR, GUARDA);
+            memset(memoria + GUARDA + TAMANHO, GUARDA_VALOR, GUARDA);
+            return;
+        }
+    }
+}
+
+// Linha recortada: cada pixel alterado deve estar a até 1 pixel da linha de referência
+static bool linha_proxima(const uint8_t *antes, const uint8_t *obtido, const uint8_t *mascara) {
+    for (int x = 0; x < LARGURA; x++) {
+        for (int y = 0; y < ALTURA; y++) {
+            if (ref_ligado(obtido, x, y) == ref_ligado(antes, x, y))
+                continue;
+            bool perto = false;
+            for (int a = -1; a <= 1 && !perto; a++)
+                for (int b = -1; b <= 1 && !perto; b++) {
+                    int xx = x + a, yy = y + b;
+                    perto = xx >= 0 && xx < LARGURA && yy >= 0 && yy < ALTURA && ref_ligado(mascara, xx, yy);
+                }
+            if (!perto)
+                return false;
+        }
+    }
+    return true;
+}
+
+static double agora_s(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    unsigned long iteracoes = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    estado_rng = argc > 2 ? (uint32_t)strtoul(argv[2], NULL, 0) : 0x12345678u;
+    if (estado_rng == 0)
+        estado_rng = 1;
+
+    memset(memoria, GUARDA_VALOR, sizeof(memoria));
+    uint8_t *quadro = memoria + GUARDA;
+    memset(quadro, 0, TAMANHO);
+    const raster_t r = { quadro, LARGURA, ALTURA, PAGINAS };
+    static const char *NOMES[] = { "pixel", "hspan", "vspan", "retangulo", "linha", "glifo", "preencher" };
+
+    for (unsigned long it = 0; it < iteracoes; it++) {
+        int tipo = (int)(sortear() % 7);
+        if (tipo == 6 && (sortear() % 16))
+            tipo = (int)(sortear() % 6);   // Preencher raramente, para o quadro acumular desenhos
+        bool v = sortear() & 1;
+        int x0 = coordenada(), y0 = coordenada() / 2, x1 = coordenada(), y1 = coordenada() / 2;
+        uint8_t antes[TAMANHO], mascara[TAMANHO];
+        unsigned long falhas_antes = falhas;
+        memcpy(antes, quadro, TAMANHO);
+        memcpy(esperado, quadro, TAMANHO);
+        bool exato = true;
+        switch (tipo) {
+        case 0:
+            raster_pixel(&r, x0, y0, v);
+            ref_pixel(esperado, x0, y0, v);
+            break;
+        case 1:
+            raster_hspan(&r, x0, x1, y0, v);
+            ref_hspan(esperado, x0, x1, y0, v);
+            break;
+        case 2:
+            raster_vspan(&r, x0, y0, y1, v);
+            ref_vspan(esperado, x0, y0, y1, v);
+            break;
+        case 3: {
+            int l = (int)(sortear() % 160) - 8, a = (int)(sortear() % 90) - 8;
+            bool cheio = sortear() & 1;
+            raster_retangulo(&r, x0, y0, l, a, v, cheio);
+            ref_retangulo(esperado, x0, y0, l, a, v, cheio);
+            break;
+        }
+        case 4:
+            raster_linha(&r, x0, y0, x1, y1, v);
+            ref_linha(esperado, x0, y0, x1, y1, v);
+            memset(mascara, 0, TAMANHO);
+            ref_linha(mascara, x0, y0, x1, y1, true);
+            exato = x0 >= 0 && x0 < LARGURA && y0 >= 0 && y0 < ALTURA && x1 >= 0 && x1 < LARGURA && y1 >= 0 &&
+                    y1 < ALTURA;
+            break;
+        case 5: {
+            uint8_t g[8];
+            for (int i = 0; i < 8; i++)
+                g[i] = (uint8_t)sortear();
+            raster_glifo(&r, g, x0, y0);
+            ref_glifo(esperado, g, x0, y0);
+            break;
+        }
+        default:
+            raster_preencher(&r, v);
+            memset(esperado, v ? 0xFF : 0x00, TAMANHO);
+            break;
+        }
+        conferir_guardas(it, NOMES[tipo]);
+        if (exato ? memcmp(quadro, esperado, TAMANHO) != 0 : !linha_proxima(antes, quadro, mascara))
+            falhar(it, NOMES[tipo], "quadro diferente da referência");
+        if (falhas != falhas_antes)
+            memcpy(quadro, esperado, TAMANHO);   // Segue a partir do quadro correto
+    }
+
+    // Custo: mesma sequência de primitivas nas duas versões
+    enum { MEDIDAS = 200000 };
+    static int coords[MEDIDAS][4];
+    for (int i = 0; i < MEDIDAS; i++)
+        for (int k = 0; k < 4; k++)
+            coords[i][k] = k & 1 ? coordenada() / 2 : coordenada();
+    static const uint8_t g[8] = { 0x3e, 0x41, 0x41, 0x49, 0x41, 0x41, 0x3e, 0x00 };
+    const char *rotulos[] = { "linha", "retangulo cheio", "glifo" };
+    printf("%-16s %10s %10s\n", "primitiva", "raster ns", "ingenua ns");
+    for (int p = 0; p < 3; p++) {
+        double t[2];
+        for (int versao = 0; versao < 2; versao++) {
+            double inicio = agora_s();
+            for (int i = 0; i < MEDIDAS; i++) {
+                int *c = coords[i];
+                if (p == 0)
+                    versao ? ref_linha(quadro, c[0], c[1], c[2], c[3], i & 1)
+                           : raster_linha(&r, c[0], c[1], c[2], c[3], i & 1);
+                else if (p == 1)
+                    versao ? ref_retangulo(quadro, c[0], c[1], abs(c[2]) % 64, abs(c[3]) % 32, i & 1, true)
+                           : raster_retangulo(&r, c[0], c[1], abs(c[2]) % 64, abs(c[3]) % 32, i & 1, true);
+                else
+                    versao ? ref_glifo(quadro, g, c[0], c[1]) : raster_glifo(&r, g, c[0], c[1]);
+            }
+            t[versao] = (agora_s() - inicio) * 1e9 / MEDIDAS;
+        }
+        printf("%-16s %10.1f %10.1f\n", rotulos[p], t[0], t[1]);
+    }
+    conferir_guardas(iteracoes, "medição");
+
+    printf("%lu iterações, %lu falhas\n", iteracoes, falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,304 @@
+//===============================================
+// Barramento I2C, sensores simulados e drivers no host
+//
+// Monta a mesma pilha do firmware com FRUITLIFE_I2C_SIMULADO: drivers
+// sht3x.c e scd4x.c sobre o gerenciador barramento_i2c.c, com os
+// substitutos de i2c_simulado.c como backend. Um backend intermediário
+// avança o relógio virtual pela duração de cada transferência a 400 kHz
+// e injeta falhas (leitura perdida, bit trocado). O OLED é representado
+// por quadros de 1 KB em pedaços de baixa prioridade. Confere:
+//   - valores lidos pelos dois drivers, dentro da resolução do sensor;
+//   - prioridade e ordem FIFO da fila;
+//   - sensores passando à frente do quadro do OLED na fila;
+//   - NACK do SHT3x durante a conversão;
+//   - recuperação depois de uma leitura perdida e de um CRC errado.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o i2c_sensores tools/i2c_sensores.c include/barramento_i2c.c
+//       include/i2c_simulado.c include/sht3x.c include/scd4x.c include/crc.c -lm
+//
+// Uso: i2c_sensores   (código 1 se alguma verificação falhar)
+//===============================================
+#include <math.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "barramento_i2c.h"
+#include "i2c_simulado.h"
+#include "scd4x.h"
+#include "sht3x.h"
+
+#define BAUDRATE (400 * 1000)
+#define ORCAMENTO_US 2000         // ORCAMENTO_BARRAMENTO_US do firmware
+#define PERIODO_SHT3X_MS 1000
+#define VOLTA_US 1000             // Uma volta do laço principal por ms
+#define ENDERECO_OLED 0x3C
+#define QUADRO_OLED 1024
+#define PEDACO_OLED 32            // SSD1306_PEDACO (ssd1306.h depende do SDK)
+
+static uint64_t agora_us;
+static int falhas;
+
+static uint64_t relogio(void) {
+    return agora_us;
+}
+
+static void conferir(const char *nome, bool ok) {
+    printf("  %-58s %s\n", nome, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+//-------------------------------------------------
+// Fio: tempo de transferência e falhas injetadas
+//-------------------------------------------------
+typedef struct {
+    i2c_backend_t sensores;      // i2c_simulado
+    uint32_t bytes_oled;
+    bool perder_leitura_sht;     // Próxima leitura do SHT3x não chega ao sensor
+    bool corromper_leitura_sht;  // Próxima leitura do SHT3x chega com um bit trocado
+} fio_t;
+
+static uint64_t inicio_sht_us;   // Início da última transferência com o SHT3x
+
+static void transferir(size_t len) {
+    agora_us += (uint64_t)(len + 1) * 9u * 1000000u / BAUDRATE;   // Endereço + dados, 9 bits cada
+}
+
+static int escrever_oled(void *ctx, uint8_t endereco, const uint8_t *dados, size_t len, uint32_t timeout_us) {
+    (void)dados;
+    (void)timeout_us;
+    fio_t *f = ctx;
+    if (endereco == ENDERECO_OLED)
+        f->bytes_oled += (uint32_t)len;
+    return (int)len;
+}
+
+static int ler_oled(void *ctx, uint8_t endereco, uint8_t *dados, size_t len, uint32_t timeout_us) {
+    (void)ctx;
+    (void)endereco;
+    (void)timeout_us;
+    memset(dados, 0, len);
+    return (int)len;
+}
+
+static int escrever_fio(void *ctx, uint8_t endereco, const uint8_t *dados, size_t len, uint32_t timeout_us) {
+    fio_t *f = ctx;
+    if (endereco == SHT3X_ENDERECO)
+        inicio_sht_us = agora_us;
+    transferir(len);
+    return f->sensores.escrever(f->sensores.ctx, endereco, dados, len, timeout_us);
+}
+
+static int ler_fio(void *ctx, uint8_t endereco, uint8_t *dados, size_t len, uint32_t timeout_us) {
+    fio_t *f = ctx;
+    if (endereco == SHT3X_ENDERECO)
+        inicio_sht_us = agora_us;
+    transferir(len);
+    if (endereco == SHT3X_ENDERECO && f->perder_leitura_sht) {
+        f->perder_leitura_sht = false;
+        return -1;   // A leitura nem chega ao sensor (ex.: ruído no cabeçalho)
+    }
+    int r = f->sensores.ler(f->sensores.ctx, endereco, dados, len, timeout_us);
+    if (endereco == SHT3X_ENDERECO && r > 0) {
+        if (f->corromper_leitura_sht) {
+            f->corromper_leitura_sht = false;
+            dados[1] ^= 0x04;
+        }
+    }
+    return r;
+}
+
+//-------------------------------------------------
+// Pilha completa, como no firmware
+//-------------------------------------------------
+static fio_t fio;
+static i2c_backend_t backend_oled;
+static i2c_simulado_t sim;
+static barramento_i2c_t barramento;
+static sht3x_t sht;
+static scd4x_t scd;
+static uint8_t quadro[QUADRO_OLED / PEDACO_OLED][PEDACO_OLED + 1];
+static uint32_t pedacos_pendentes;
+static uint32_t maior_espera_sht_us;
+
+static void pedaco_enviado(void *ctx, int resultado, uint64_t instante_us) {
+    (void)ctx;
+    (void)resultado;
+    (void)instante_us;
+    pedacos_pendentes--;
+}
+
+static void enviar_quadro(void) {
+    for (uint32_t i = 0; i < QUADRO_OLED / PEDACO_OLED; i++) {
+        quadro[i][0] = 0x40;   // Byte de controle: dados
+        i2c_transacao_t t = {
+            .endereco = ENDERECO_OLED,
+            .prioridade = I2C_PRIO_BAIXA,
+            .dados = quadro[i],
+            .len = sizeof(quadro[i]),
+            .concluido = pedaco_enviado,
+        };
+        if (barramento_i2c_enfileirar(&barramento, &t))
+            pedacos_pendentes++;
+    }
+}
+
+static void montar(void) {
+    agora_us = 1000;
+    memset(&fio, 0, sizeof(fio));
+    backend_oled = (i2c_backend_t){escrever_oled, ler_oled, &fio};
+    i2c_simulado_init(&sim, &backend_oled, relogio);
+    fio.sensores = i2c_simulado_backend(&sim);
+    barramento_i2c_init(&barramento, (i2c_backend_t){escrever_fio, ler_fio, &fio}, BAUDRATE, relogio);
+    sht3x_init(&sht, &barramento, PERIODO_SHT3X_MS);
+    scd4x_init(&scd, &barramento);
+    pedacos_pendentes = 0;
+    maior_espera_sht_us = 0;
+}
+
+// Laço principal por 'duracao_us'; com 'oled', um quadro novo sempre que o anterior termina
+static void rodar(uint64_t duracao_us, bool oled) {
+    uint64_t fim = agora_us + duracao_us;
+    while (agora_us < fim) {
+        uint64_t volta = agora_us;
+        uint8_t antes = sht.estado;
+        sht3x_poll(&sht, agora_us);
+        scd4x_poll(&scd, agora_us);
+        if (oled && pedacos_pendentes == 0)
+            enviar_quadro();
+        // Espera do SHT3x: do enfileiramento até a transação ir para o fio
+        uint64_t enfileirado = agora_us;
+        bool pediu = antes != sht.estado && (sht.estado == SHT3X_ENVIANDO || sht.estado == SHT3X_LENDO);
+        inicio_sht_us = 0;
+        barramento_i2c_processar(&barramento, ORCAMENTO_US);
+        if (pediu && inicio_sht_us) {
+            uint32_t espera = (uint32_t)(inicio_sht_us - enfileirado);
+            if (espera > maior_espera_sht_us)
+                maior_espera_sht_us = espera;
+        }
+        if (agora_us < volta + VOLTA_US)
+            agora_us = volta + VOLTA_US;
+    }
+}
+
+//-------------------------------------------------
+// Verificações
+//-------------------------------------------------
+static uint8_t executadas[8];
+static uint32_t num_executadas;
+
+static void registrar_execucao(void *ctx) {
+    if (num_executadas < sizeof(executadas))
+        executadas[num_executadas] = *(const uint8_t *)ctx;
+    num_executadas++;
+}
+
+static void testar_fila(void) {
+    printf("Fila de prioridades\n");
+    montar();
+    static uint8_t dados[4];
+    static const uint8_t PRIORIDADES[] = {I2C_PRIO_BAIXA, I2C_PRIO_NORMAL, I2C_PRIO_BAIXA,
+                                          I2C_PRIO_ALTA,  I2C_PRIO_NORMAL, I2C_PRIO_ALTA};
+    static const uint8_t IDS[] = {1, 2, 3, 4, 5, 6};
+    num_executadas = 0;
+    for (uint32_t i = 0; i < sizeof(IDS); i++) {
+        i2c_transacao_t t = {
+            .endereco = ENDERECO_OLED,
+            .prioridade = PRIORIDADES[i],
+            .dados = dados,
+            .len = sizeof(dados),
+            .preparar = registrar_execucao,
+            .ctx = (void *)&IDS[i],
+        };
+        barramento_i2c_enfileirar(&barramento, &t);
+    }
+    while (barramento_i2c_executar_proxima(&barramento))
+        ;
+    uint32_t n = num_executadas;
+    static const uint8_t ESPERADA[] = {4, 6, 2, 5, 1, 3};
+    conferir("alta, normal, baixa; FIFO dentro da prioridade", n == 6 && memcmp(executadas, ESPERADA, 6) == 0);
+    conferir("contagem de transacoes", barramento.transacoes == 6 && barramento.erros == 0);
+
+    i2c_transacao_t t = {.endereco = ENDERECO_OLED, .prioridade = I2C_PRIO_BAIXA, .dados = dados, .len = 1};
+    uint32_t aceitas = 0;
+    for (uint32_t i = 0; i < BARRAMENTO_MAX_TRANSACOES + 4; i++)
+        aceitas += barramento_i2c_enfileirar(&barramento, &t);
+    conferir("fila cheia recusa sem sobrescrever", aceitas == BARRAMENTO_MAX_TRANSACOES);
+}
+
+static void testar_protocolo(void) {
+    printf("Protocolo do SHT3x simulado\n");
+    montar();
+    i2c_backend_t b = i2c_simulado_backend(&sim);
+    uint8_t cmd[2] = {SHT3X_CMD_MEDIR_ALTA >> 8, SHT3X_CMD_MEDIR_ALTA & 0xFF}, r[6];
+    conferir("comando aceito", b.escrever(b.ctx, SHT3X_ENDERECO, cmd, 2, 0) == 2);
+    conferir("NACK na leitura durante a conversao", b.ler(b.ctx, SHT3X_ENDERECO, r, 6, 0) < 0);
+    conferir("NACK em novo comando durante a conversao", b.escrever(b.ctx, SHT3X_ENDERECO, cmd, 2, 0) < 0);
+    agora_us += SHT3X_TEMPO_CONVERSAO_US;
+    // Resultado não lido: o sensor aceita a próxima medida
+    conferir("comando aceito depois da conversao, sem leitura", b.escrever(b.ctx, SHT3X_ENDERECO, cmd, 2, 0) == 2);
+    agora_us += SHT3X_TEMPO_CONVERSAO_US;
+    conferir("leitura depois da conversao", b.ler(b.ctx, SHT3X_ENDERECO, r, 6, 0) == 6);
+    conferir("segunda leitura sem nova medida recebe NACK", b.ler(b.ctx, SHT3X_ENDERECO, r, 6, 0) < 0);
+}
+
+static void testar_leituras(void) {
+    printf("Drivers com o OLED ocupando o barramento (12 s)\n");
+    montar();
+    i2c_simulado_definir_sht3x(&sim, 23.45f, 61.2f);
+    i2c_simulado_definir_scd4x(&sim, 812.0f, 24.1f, 58.7f);
+    rodar(12000000, true);
+    printf("  SHT3x %.2f C %.2f %%, SCD4x %.0f ppm %.2f C %.2f %%\n", sht.temperatura, sht.umidade, scd.co2,
+           scd.temperatura, scd.umidade);
+    conferir("SHT3x valido", sht.valido && sht.erros == 0);
+    conferir("SHT3x dentro da resolucao",
+             fabsf(sht.temperatura - 23.45f) < 0.01f && fabsf(sht.umidade - 61.2f) < 0.01f);
+    conferir("SCD4x valido", scd.valido && scd.erros == 0);
+    conferir("SCD4x dentro da resolucao", fabsf(scd.co2 - 812.0f) < 0.5f &&
+                                              fabsf(scd.temperatura - 24.1f) < 0.01f &&
+                                              fabsf(scd.umidade - 58.7f) < 0.01f);
+    conferir("OLED recebeu quadros", fio.bytes_oled >= 100u * (QUADRO_OLED + QUADRO_OLED / PEDACO_OLED));
+    // Os pedaços do OLED já na fila não passam à frente: a espera é no
+    // máximo a de uma transação do SCD4x, menor que um pedaço
+    uint32_t pedaco_us = (PEDACO_OLED + 2) * 9u * 1000000u / BAUDRATE;
+    printf("  maior espera do SHT3x %u us (pedaco do OLED %u us), maior transacao %u us\n", maior_espera_sht_us,
+           pedaco_us, barramento.maior_transacao_us);
+    conferir("SHT3x passa a frente do quadro do OLED", maior_espera_sht_us <= pedaco_us);
+    conferir("nenhum erro no barramento", barramento.erros == 0);
+}
+
+static void testar_falhas(void) {
+    printf("Falhas no fio\n");
+    montar();
+    i2c_simulado_definir_sht3x(&sim, 5.0f, 90.0f);
+    rodar(1500000, false);
+    conferir("primeira leitura", sht.valido && fabsf(sht.temperatura - 5.0f) < 0.01f);
+
+    // Leitura perdida: o driver desiste e recomeça no próximo período
+    i2c_simulado_definir_sht3x(&sim, 8.0f, 85.0f);
+    fio.perder_leitura_sht = true;
+    rodar(1000000, false);
+    conferir("leitura perdida conta um erro", sht.erros == 1 && fabsf(sht.temperatura - 5.0f) < 0.01f);
+    rodar(2000000, false);
+    conferir("sensor volta a medir depois da leitura perdida",
+             sht.erros == 1 && fabsf(sht.temperatura - 8.0f) < 0.01f);
+
+    // CRC errado: valor anterior preservado
+    i2c_simulado_definir_sht3x(&sim, 12.0f, 70.0f);
+    fio.corromper_leitura_sht = true;
+    rodar(1000000, false);
+    conferir("CRC errado descartado", sht.erros == 2 && fabsf(sht.temperatura - 8.0f) < 0.01f);
+    rodar(2000000, false);
+    conferir("proxima leitura aceita", sht.erros == 2 && fabsf(sht.temperatura - 12.0f) < 0.01f);
+}
+
+int main(void) {
+    testar_fila();
+    testar_protocolo();
+    testar_leituras();
+    testar_falhas();
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,435 @@
+//===============================================
+// Mestre Modbus RTU de bancada sobre um pseudoterminal (host)
+//
+// Abre um pty com openpty e põe o núcleo do escravo (include/modbus.c)
+// num processo filho, do lado escravo: cada byte lido entra por
+// modbus_receber_byte com a hora do relógio monotônico, como na IRQ da
+// UART, e o laço chama modbus_processar. O mapa imita o do firmware
+// (setpoints da zona 0 com as mesmas faixas, contadores de quadros e de
+// erros de CRC nos registradores de entrada 11 e 12). O processo pai faz
+// o papel do mestre e confere as funções 03, 04, 06 e 16, exceções,
+// escrita múltipla tudo-ou-nada, CRC errado, difusão, endereço de outro
+// escravo, quadro longo demais e a separação de quadros por 3,5
+// caracteres de silêncio.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o modbus_pty tools/modbus_pty.c include/modbus.c include/crc.c -lutil
+//
+// Uso: modbus_pty   (código 1 se alguma verificação falhar)
+//===============================================
+#define _DEFAULT_SOURCE
+#include <errno.h>
+#include <poll.h>
+#include <pty.h>
+#include <signal.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/wait.h>
+#include <termios.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "crc.h"
+#include "modbus.h"
+
+// 9600 baud dá t3,5 = 4010 µs, folga confortável para o escalonador do host
+#define ENDERECO 1
+#define BAUD 9600
+#define T35_US 4010
+
+#define REG_QUADROS 11
+#define REG_ERROS_CRC 12
+#define NUM_ENTRADAS 13
+#define NUM_RETENCAO 6
+
+#define ESPERA_RESPOSTA_MS 100   // Sem nenhum byte até aqui: escravo calado
+#define FIM_RESPOSTA_MS 20       // Silêncio que encerra a resposta
+
+static int falhas;
+static uint32_t quadros_esperados;   // Quadros com CRC certo para o escravo ou difusão
+static uint32_t maior_resposta_us;
+
+static uint32_t agora_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u);
+}
+
+static void dormir_us(uint32_t us) {
+    struct timespec ts = { us / 1000000u, (long)(us % 1000000u) * 1000 };
+    nanosleep(&ts, NULL);
+}
+
+//===============================================
+// Escravo (processo filho)
+//===============================================
+typedef struct {
+    modbus_t *modbus;
+    int16_t retencao[NUM_RETENCAO];
+} escravo_t;
+
+// Mesmas faixas de setpoint_modbus no firmware
+static const int16_t MINIMO[NUM_RETENCAO] = { 0, 0, -200, -200, 0, 0 };
+static const int16_t MAXIMO[NUM_RETENCAO] = { 1000, 1000, 600, 600, 1000, 5000 };
+static const int16_t INICIAL[NUM_RETENCAO] = { 50, 200, 0, 100, 900, 1000 };
+
+static uint16_t valor_entrada(uint16_t reg) {
+    return (uint16_t)(0x1000 + reg);
+}
+
+static bool ler_entrada(void *ctx, uint16_t reg, uint16_t *valor) {
+    escravo_t *e = ctx;
+    if (reg >= NUM_ENTRADAS)
+        return false;
+    if (reg == REG_QUADROS)
+        *valor = (uint16_t)e->modbus->quadros;
+    else if (reg == REG_ERROS_CRC)
+        *valor = (uint16_t)e->modbus->erros_crc;
+    else
+        *valor = valor_entrada(reg);
+    return true;
+}
+
+static bool ler_retencao(void *ctx, uint16_t reg, uint16_t *valor) {
+    escravo_t *e = ctx;
+    if (reg >= NUM_RETENCAO)
+        return false;
+    *valor = (uint16_t)e->retencao[reg];
+    return true;
+}
+
+static uint8_t escrever_retencao(void *ctx, uint16_t reg, uint16_t valor, bool aplicar) {
+    escravo_t *e = ctx;
+    if (reg >= NUM_RETENCAO)
+        return MODBUS_EXC_ENDERECO;
+    int16_t v = (int16_t)valor;
+    if (v < MINIMO[reg] || v > MAXIMO[reg])
+        return MODBUS_EXC_VALOR;
+    if (aplicar)
+        e->retencao[reg] = v;
+    return 0;
+}
+
+static void enviar(void *ctx, const uint8_t *dados, size_t len) {
+    int fd = *(int *)ctx;
+    while (len > 0) {
+        ssize_t n = write(fd, dados, len);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return;
+        dados += n;
+        len -= (size_t)n;
+    }
+}
+
+// write só retorna com os bytes entregues ao pty
+static bool transmitindo(void *ctx) {
+    (void)ctx;
+    return false;
+}
+
+static void escravo(int fd) {
+    static modbus_t modbus;
+    escravo_t e = { .modbus = &modbus };
+    memcpy(e.retencao, INICIAL, sizeof(e.retencao));
+    modbus_mapa_t mapa = { ler_entrada, ler_retencao, escrever_retencao, &e };
+    modbus_transporte_t transporte = { enviar, transmitindo, &fd };
+    modbus_init(&modbus, ENDERECO, BAUD, mapa, transporte);
+
+    for (;;) {
+        // Acorda a cada 1 ms para fechar o quadro depois do silêncio
+        struct pollfd p = { .fd = fd, .events = POLLIN };
+        int r = poll(&p, 1, 1);
+        if (r > 0) {
+            uint8_t buf[64];
+            ssize_t n = read(fd, buf, sizeof(buf));
+            if (n == 0 || (n < 0 && errno != EINTR && errno != EAGAIN))
+                _exit(0);   // Mestre fechou o pty
+            uint32_t t = agora_us();
+            for (ssize_t i = 0; i < n; i++)
+                modbus_receber_byte(&modbus, buf[i], t);
+        }
+        modbus_processar(&modbus, agora_us());
+    }
+}
+
+//===============================================
+// Mestre (processo pai)
+//===============================================
+static int fd_mestre;
+
+static void escrever(const uint8_t *dados, size_t len) {
+    enviar(&fd_mestre, dados, len);
+}
+
+static size_t fechar(uint8_t *q, size_t len) {
+    uint16_t crc = crc16_modbus(q, len);
+    q[len] = (uint8_t)crc;
+    q[len + 1] = (uint8_t)(crc >> 8);
+    return len + 2;
+}
+
+// Lê a resposta até FIM_RESPOSTA_MS de silêncio; 0 se o escravo não respondeu
+static size_t receber(uint8_t *resp, size_t max, uint32_t enviado_us) {
+    size_t len = 0;
+    int espera = ESPERA_RESPOSTA_MS;
+    for (;;) {
+        struct pollfd p = { .fd = fd_mestre, .events = POLLIN };
+        if (poll(&p, 1, espera) <= 0)
+            return len;
+        uint8_t buf[64];
+        ssize_t n = read(fd_mestre, buf, sizeof(buf));
+        if (n <= 0)
+            return len;
+        if (len == 0) {
+            uint32_t atraso = agora_us() - enviado_us;
+            if (atraso > maior_resposta_us)
+                maior_resposta_us = atraso;
+        }
+        for (ssize_t i = 0; i < n && len < max; i++)
+            resp[len++] = buf[i];
+        espera = FIM_RESPOSTA_MS;
+    }
+}
+
+// Envia a PDU com endereço e CRC e devolve o tamanho da resposta
+static size_t transacao(uint8_t endereco, const uint8_t *pdu, size_t len, uint8_t *resp) {
+    uint8_t q[MODBUS_QUADRO_MAX + 2];
+    q[0] = endereco;
+    memcpy(&q[1], pdu, len);
+    size_t n = fechar(q, len + 1);
+    if (endereco == ENDERECO || endereco == 0)
+        quadros_esperados++;
+    escrever(q, n);
+    return receber(resp, MODBUS_QUADRO_MAX, agora_us());
+}
+
+static void conferir(const char *nome, bool ok) {
+    printf("  %-52s %s\n", nome, ok ? "ok" : "FALHA");
+    if (!ok)
+        falhas++;
+}
+
+static bool crc_ok(const uint8_t *r, size_t len) {
+    return len >= 4 && crc16_modbus(r, len - 2) == (uint16_t)(r[len - 2] | (r[len - 1] << 8));
+}
+
+static uint16_t u16(const uint8_t *p) {
+    return (uint16_t)((p[0] << 8) | p[1]);
+}
+
+// Lê qtd registradores; false se a resposta não for uma leitura válida
+static bool ler(uint8_t funcao, uint16_t inicio, uint16_t qtd, uint16_t *valores) {
+    uint8_t pdu[5] = { funcao, (uint8_t)(inicio >> 8), (uint8_t)inicio, (uint8_t)(qtd >> 8), (uint8_t)qtd };
+    uint8_t r[MODBUS_QUADRO_MAX];
+    size_t n = transacao(ENDERECO, pdu, sizeof(pdu), r);
+    if (n != 5u + 2u * qtd || !crc_ok(r, n) || r[0] != ENDERECO || r[1] != funcao || r[2] != 2 * qtd)
+        return false;
+    for (uint16_t i = 0; i < qtd; i++)
+        valores[i] = u16(&r[3 + 2 * i]);
+    return true;
+}
+
+static uint16_t ler_um(uint8_t funcao, uint16_t reg) {
+    uint16_t v = 0xFFFF;
+    ler(funcao, reg, 1, &v);
+    return v;
+}
+
+// Resposta de exceção com o código esperado
+static bool excecao(const uint8_t *r, size_t n, uint8_t funcao, uint8_t codigo) {
+    return n == 5 && crc_ok(r, n) && r[0] == ENDERECO && r[1] == (funcao | 0x80) && r[2] == codigo;
+}
+
+static size_t escrever_um(uint8_t endereco, uint16_t reg, uint16_t valor, uint8_t *r) {
+    uint8_t pdu[5] = { MODBUS_FC_ESCREVER_UM, (uint8_t)(reg >> 8), (uint8_t)reg, (uint8_t)(valor >> 8), (uint8_t)valor };
+    return transacao(endereco, pdu, sizeof(pdu), r);
+}
+
+static size_t escrever_varios(uint8_t endereco, uint16_t inicio, uint16_t qtd, const int16_t *valores, uint8_t *r) {
+    uint8_t pdu[6 + 2 * NUM_RETENCAO] = { MODBUS_FC_ESCREVER_VARIOS, (uint8_t)(inicio >> 8), (uint8_t)inicio,
+                                          (uint8_t)(qtd >> 8), (uint8_t)qtd, (uint8_t)(2 * qtd) };
+    for (uint16_t i = 0; i < qtd; i++) {
+        pdu[6 + 2 * i] = (uint8_t)((uint16_t)valores[i] >> 8);
+        pdu[7 + 2 * i] = (uint8_t)valores[i];
+    }
+    return transacao(endereco, pdu, 6u + 2u * qtd, r);
+}
+
+static bool retencao_igual(const int16_t *esperado) {
+    uint16_t v[NUM_RETENCAO];
+    if (!ler(MODBUS_FC_LER_RETENCAO, 0, NUM_RETENCAO, v))
+        return false;
+    for (int i = 0; i < NUM_RETENCAO; i++)
+        if ((int16_t)v[i] != esperado[i])
+            return false;
+    return true;
+}
+
+static void testar_funcoes(void) {
+    uint8_t r[MODBUS_QUADRO_MAX];
+    size_t n;
+    int16_t esperado[NUM_RETENCAO];
+    memcpy(esperado, INICIAL, sizeof(esperado));
+
+    printf("Funções 03, 04, 06 e 16\n");
+    uint16_t v[NUM_ENTRADAS];
+    bool ok = ler(MODBUS_FC_LER_ENTRADA, 0, 11, v);
+    for (int i = 0; ok && i < 11; i++)
+        ok = v[i] == valor_entrada((uint16_t)i);
+    conferir("04: entradas 0..10", ok);
+    conferir("03: setpoints iniciais 0..5", retencao_igual(esperado));
+
+    n = escrever_um(ENDERECO, 2, (uint16_t)-50, r);
+    conferir("06: eco da requisição", n == 8 && crc_ok(r, n) && r[1] == MODBUS_FC_ESCREVER_UM &&
+                                          u16(&r[2]) == 2 && u16(&r[4]) == (uint16_t)-50);
+    esperado[2] = -50;
+    conferir("06: valor negativo relido", retencao_igual(esperado));
+
+    const int16_t novos[NUM_RETENCAO] = { 10, 300, -100, 250, 850, 1500 };
+    n = escrever_varios(ENDERECO, 0, NUM_RETENCAO, novos, r);
+    conferir("16: eco de início e quantidade", n == 8 && crc_ok(r, n) && r[1] == MODBUS_FC_ESCREVER_VARIOS &&
+                                                   u16(&r[2]) == 0 && u16(&r[4]) == NUM_RETENCAO);
+    memcpy(esperado, novos, sizeof(esperado));
+    conferir("16: valores relidos", retencao_igual(esperado));
+
+    printf("Exceções\n");
+    n = escrever_um(ENDERECO, 2, 700, r);
+    conferir("06 fora da faixa: exceção 03", excecao(r, n, MODBUS_FC_ESCREVER_UM, MODBUS_EXC_VALOR));
+    const int16_t ruins[NUM_RETENCAO] = { 0, 0, 0, 0, 0, 6000 };
+    n = escrever_varios(ENDERECO, 0, NUM_RETENCAO, ruins, r);
+    conferir("16 com o último inválido: exceção 03", excecao(r, n, MODBUS_FC_ESCREVER_VARIOS, MODBUS_EXC_VALOR));
+    conferir("16 inválido: nada aplicado", retencao_igual(esperado));
+    n = escrever_varios(ENDERECO, 4, 3, novos, r);
+    conferir("16 passando do fim: exceção 02", excecao(r, n, MODBUS_FC_ESCREVER_VARIOS, MODBUS_EXC_ENDERECO));
+    conferir("16 passando do fim: nada aplicado", retencao_igual(esperado));
+
+    uint8_t pdu[5] = { MODBUS_FC_LER_RETENCAO, 0, NUM_RETENCAO, 0, 1 };
+    n = transacao(ENDERECO, pdu, sizeof(pdu), r);
+    conferir("03 em registrador inexistente: exceção 02", excecao(r, n, MODBUS_FC_LER_RETENCAO, MODBUS_EXC_ENDERECO));
+    uint8_t pdu_entrada[5] = { MODBUS_FC_LER_ENTRADA, 0, NUM_ENTRADAS - 1, 0, 2 };
+    n = transacao(ENDERECO, pdu_entrada, sizeof(pdu_entrada), r);
+    conferir("04 passando do fim: exceção 02", excecao(r, n, MODBUS_FC_LER_ENTRADA, MODBUS_EXC_ENDERECO));
+    uint8_t pdu_zero[5] = { MODBUS_FC_LER_ENTRADA, 0, 0, 0, 0 };
+    n = transacao(ENDERECO, pdu_zero, sizeof(pdu_zero), r);
+    conferir("04 com quantidade 0: exceção 03", excecao(r, n, MODBUS_FC_LER_ENTRADA, MODBUS_EXC_VALOR));
+    uint8_t pdu_funcao[5] = { 0x2B, 0, 0, 0, 1 };
+    n = transacao(ENDERECO, pdu_funcao, sizeof(pdu_funcao), r);
+    conferir("função 0x2B: exceção 01", excecao(r, n, 0x2B, MODBUS_EXC_FUNCAO));
+
+    printf("Difusão e outros escravos\n");
+    n = escrever_um(0, 5, 4321, r);
+    conferir("06 em difusão: sem resposta", n == 0);
+    esperado[5] = 4321;
+    conferir("06 em difusão: aplicado", retencao_igual(esperado));
+    const int16_t difusao[2] = { 20, 400 };
+    n = escrever_varios(0, 0, 2, difusao, r);
+    conferir("16 em difusão: sem resposta", n == 0);
+    esperado[0] = 20;
+    esperado[1] = 400;
+    conferir("16 em difusão: aplicado", retencao_igual(esperado));
+    uint8_t pdu_leitura[5] = { MODBUS_FC_LER_ENTRADA, 0, 0, 0, 1 };
+    n = transacao(0, pdu_leitura, sizeof(pdu_leitura), r);
+    conferir("04 em difusão: sem resposta", n == 0);
+    n = escrever_um(ENDERECO + 1, 5, 1, r);
+    conferir("06 para o escravo 2: sem resposta", n == 0);
+    conferir("06 para o escravo 2: não aplicado", retencao_igual(esperado));
+}
+
+static void testar_quadros(void) {
+    uint8_t q[MODBUS_QUADRO_MAX + 64];
+    uint8_t r[MODBUS_QUADRO_MAX];
+    size_t n;
+
+    printf("CRC e separação de quadros (t3,5 = %u µs)\n", T35_US);
+    uint16_t erros = ler_um(MODBUS_FC_LER_ENTRADA, REG_ERROS_CRC);
+
+    q[0] = ENDERECO;
+    q[1] = MODBUS_FC_ESCREVER_UM;
+    q[2] = 0;
+    q[3] = 5;
+    q[4] = 0;
+    q[5] = 7;
+    n = fechar(q, 6);
+    q[n - 1] ^= 0x01;
+    escrever(q, n);
+    conferir("CRC errado: sem resposta", receber(r, sizeof(r), agora_us()) == 0);
+    conferir("CRC errado: contado", ler_um(MODBUS_FC_LER_ENTRADA, REG_ERROS_CRC) == (uint16_t)(erros + 1));
+    conferir("CRC errado: não aplicado", ler_um(MODBUS_FC_LER_RETENCAO, 5) == 4321);
+
+    // Pausa menor que t3,5 no meio do quadro: continua o mesmo quadro
+    q[n - 1] ^= 0x01;
+    quadros_esperados++;
+    escrever(q, 3);
+    dormir_us(T35_US / 8);
+    escrever(&q[3], n - 3);
+    n = receber(r, sizeof(r), agora_us());
+    conferir("pausa de t3,5/8: quadro atendido", n == 8 && crc_ok(r, n) && u16(&r[4]) == 7);
+
+    // Pausa maior que t3,5: as duas partes viram quadros separados; a
+    // primeira falha no CRC e a segunda, curta demais, é descartada
+    erros = ler_um(MODBUS_FC_LER_ENTRADA, REG_ERROS_CRC);
+    q[5] = 9;
+    n = fechar(q, 6);
+    escrever(q, 5);
+    dormir_us(3 * T35_US);
+    escrever(&q[5], n - 5);
+    conferir("pausa de 3·t3,5: quadro descartado", receber(r, sizeof(r), agora_us()) == 0);
+    conferir("pausa de 3·t3,5: primeira metade com CRC errado",
+             ler_um(MODBUS_FC_LER_ENTRADA, REG_ERROS_CRC) == (uint16_t)(erros + 1));
+    conferir("pausa de 3·t3,5: não aplicado", ler_um(MODBUS_FC_LER_RETENCAO, 5) == 7);
+
+    // Duas requisições coladas, sem silêncio entre elas, formam um quadro só
+    size_t a = fechar(q, 6);
+    memcpy(&q[a], q, a);
+    escrever(q, 2 * a);
+    conferir("requisições sem silêncio: descartadas", receber(r, sizeof(r), agora_us()) == 0);
+
+    // Quadro maior que MODBUS_QUADRO_MAX é invalidado, mesmo com CRC certo
+    memset(q, 0, sizeof(q));
+    q[0] = ENDERECO;
+    q[1] = MODBUS_FC_ESCREVER_VARIOS;
+    n = fechar(q, MODBUS_QUADRO_MAX + 10);
+    escrever(q, n);
+    conferir("quadro longo demais: sem resposta", receber(r, sizeof(r), agora_us()) == 0);
+
+    // Depois de tudo isso o escravo continua respondendo
+    conferir("ressincroniza na requisição seguinte", ler_um(MODBUS_FC_LER_RETENCAO, 5) == 7);
+    uint16_t quadros = ler_um(MODBUS_FC_LER_ENTRADA, REG_QUADROS);
+    conferir("contador de quadros atendidos", quadros == (uint16_t)quadros_esperados);
+    printf("  quadros atendidos %u, maior espera pela resposta %u µs\n", quadros, maior_resposta_us);
+}
+
+int main(void) {
+    int fd_escravo;
+    struct termios cru;
+    memset(&cru, 0, sizeof(cru));
+    cfmakeraw(&cru);
+    if (openpty(&fd_mestre, &fd_escravo, NULL, &cru, NULL) < 0) {
+        perror("openpty");
+        return 1;
+    }
+
+    pid_t filho = fork();
+    if (filho < 0) {
+        perror("fork");
+        return 1;
+    }
+    if (filho == 0) {
+        close(fd_mestre);
+        escravo(fd_escravo);
+    }
+    close(fd_escravo);
+
+    testar_funcoes();
+    testar_quadros();
+
+    kill(filho, SIGTERM);
+    waitpid(filho, NULL, 0);
+    close(fd_mestre);
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}
@@ -0,0 +1,169 @@
+#!/usr/bin/env python3
+# ===============================================
+# Orçamento de memória por subsistema a partir do mapa do linker
+#
+# Lê o projeto-final.elf.map gerado pelo SDK (pico_add_extra_outputs),
+# soma o tamanho de cada seção de entrada por subsistema (módulo do
+# firmware, biblioteca do SDK ou libc) e separa flash (código, constantes
+# e imagem de carga de .data) de RAM (.data, .bss, pilhas e heap).
+# Falha (código 1) se o total passar do orçamento e avisa se alguma
+# função de alocação sobreviveu ao --gc-sections: o firmware não usa heap.
+#
+# Uso: orcamento_memoria.py projeto-final.elf.map [--flash-kb N] [--ram-kb N]
+# ===============================================
+import argparse
+import os
+import re
+import sys
+
+# Módulos do firmware (nome do .c) -> subsistema
+SUBSISTEMAS = {
+    "projeto-final": "aplicacao",
+    "ssd1306": "oled",
+    "font": "oled",
+    "matriz": "matriz",
+    "matriz_hw": "matriz",
+    "modbus": "modbus",
+    "modbus_hw": "modbus",
+    "crc": "modbus",
+    "barramento_i2c": "i2c",
+    "barramento_i2c_hw": "i2c",
+    "sht3x": "i2c",
+    "scd4x": "i2c",
+    "i2c_simulado": "i2c",
+    "botoes": "entrada",
+    "eventos": "entrada",
+    "calibracao": "calibracao",
+    "zonas": "controle",
+    "controle": "controle",
+    "tendencia": "controle",
+    "config": "persistencia",
+    "persistencia": "persistencia",
+    "supervisao": "persistencia",
+    "energia": "energia",
+    "bench": "diagnostico",
+    "pilha": "diagnostico",
+    "historico": "historico",
+    "historico_hw": "historico",
+    "disco_fat": "usb",
+    "usb_disco_hw": "usb",
+    "tom_hw": "tons",
+    "recursos": "tons",
+}
+
+# Seções de saída que só ocupam RAM (sem imagem na flash)
+SO_RAM = (".bss", ".uninitialized_data", ".heap", ".stack_dummy", ".stack1_dummy", ".ram_vector_table")
+RESERVAS = {".heap": "heap (reservado)", ".stack_dummy": "pilha nucleo 0", ".stack1_dummy": "pilha nucleo 1"}
+
+FLASH = range(0x10000000, 0x11000000)
+RAM = range(0x20000000, 0x20042000)
+
+ENTRADA = re.compile(r"^ (\*\(|\*fill\*|[.\w])")
+ALOCACAO = re.compile(r"^\.text\.(_?malloc(_r)?|_?calloc(_r)?|_?realloc(_r)?|__wrap_(malloc|calloc|realloc))$")
+ENDERECO = re.compile(r"^\s+(0x[0-9a-fA-F]+)\s+(0x[0-9a-fA-F]+)\s+(\S.*)$")
+
+
+def subsistema(arquivo, saida):
+    if saida in RESERVAS:
+        return RESERVAS[saida]
+    if ".a(" in arquivo:
+        biblioteca = os.path.basename(arquivo.split("(")[0])
+        return "libc" if biblioteca in ("libc.a", "libc_nano.a", "libg.a", "libg_nano.a", "libm.a", "libgcc.a", "libnosys.a") else biblioteca
+    nome = os.path.basename(arquivo)
+    for sufixo in (".c.obj", ".c.o", ".S.obj", ".S.o"):
+        if nome.endswith(sufixo):
+            nome = nome[: -len(sufixo)]
+            break
+    if nome in SUBSISTEMAS and "pico-sdk" not in arquivo:
+        return SUBSISTEMAS[nome]
+    # Bibliotecas do SDK: .../pico-sdk/src/rp2_common/<biblioteca>/...
+    partes = arquivo.replace("\\", "/").split("/")
+    for i, p in enumerate(partes):
+        if p in ("rp2_common", "common", "rp2040", "host") and i + 1 < len(partes):
+            return "sdk:" + partes[i + 1]
+        if p == "tinyusb":
+            return "sdk:tinyusb"
+    return "outros"
+
+
+def ler_mapa(caminho):
+    with open(caminho, encoding="utf-8", errors="replace") as f:
+        linhas = f.read().splitlines()
+
+    malloc = []
+    inicio = next((i for i, l in enumerate(linhas) if l.startswith("Linker script and memory map")), 0)
+    uso = {}
+    saida = None
+    pendente = False
+    secao = ""
+    for linha in linhas[inicio:]:
+        if linha and not linha[0].isspace():
+            saida = linha.split()[0]   # Seção de saída (.text, .data, ...)
+            pendente = False
+            continue
+        if saida is None or linha.startswith(" *fill*"):
+            continue
+        m = ENDERECO.match(linha)
+        if ENTRADA.match(linha) and not m:
+            campos = linha.split()
+            secao = campos[0]
+            if len(campos) >= 4:
+                m = ENDERECO.match(" " + " ".join(campos[1:]))
+            else:
+                pendente = len(campos) == 1   # Nome longo: endereço na próxima linha
+                continue
+        elif m and not pendente:
+            continue   # Linha de símbolo dentro de uma seção
+        pendente = False
+        if not m:
+            continue
+        endereco, tamanho, arquivo = int(m.group(1), 16), int(m.group(2), 16), m.group(3).strip()
+        if tamanho == 0 or (endereco not in FLASH and endereco not in RAM):
+            continue
+        if ALOCACAO.match(secao):
+            malloc.append("%s (%s)" % (secao, os.path.basename(arquivo)))
+        sub = subsistema(arquivo, saida)
+        flash, ram = uso.get(sub, (0, 0))
+        if endereco in FLASH:
+            flash += tamanho
+        else:
+            ram += tamanho
+            if not saida.startswith(SO_RAM):
+                flash += tamanho   # Valor inicial copiado da flash no boot
+        uso[sub] = (flash, ram)
+    return uso, malloc
+
+
+def main():
+    ap = argparse.ArgumentParser(description="Orçamento de memória por subsistema")
+    ap.add_argument("mapa")
+    ap.add_argument("--flash-kb", type=int, default=1024)
+    ap.add_argument("--ram-kb", type=int, default=192)
+    args = ap.parse_args()
+
+    uso, malloc = ler_mapa(args.mapa)
+    total_flash = sum(f for f, _ in uso.values())
+    total_ram = sum(r for _, r in uso.values())
+
+    print("Orçamento de memória (%s)" % os.path.basename(args.mapa))
+    print("  %-24s %9s %9s" % ("subsistema", "flash", "RAM"))
+    for sub, (flash, ram) in sorted(uso.items(), key=lambda kv: -(kv[1][0] + kv[1][1])):
+        print("  %-24s %9d %9d" % (sub, flash, ram))
+    limite_flash, limite_ram = args.flash_kb * 1024, args.ram_kb * 1024
+    print("  %-24s %9d %9d" % ("total", total_flash, total_ram))
+    print("  %-24s %8.1f%% %8.1f%%" % ("do orçamento", 100.0 * total_flash / limite_flash, 100.0 * total_ram / limite_ram))
+
+    erro = False
+    if total_flash > limite_flash:
+        print("ERRO: flash acima do orçamento de %d KB" % args.flash_kb)
+        erro = True
+    if total_ram > limite_ram:
+        print("ERRO: RAM acima do orçamento de %d KB" % args.ram_kb)
+        erro = True
+    if malloc:
+        print("AVISO: funções de heap ligadas ao firmware: %s" % ", ".join(malloc))
+    return 1 if erro else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
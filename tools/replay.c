@@ -0,0 +1,340 @@
+//===============================================
+// Reprodução determinística de traços (host)
+//
+// Executa a lógica do firmware (botoes.c, calibracao.c, zonas.c,
+// excursoes.c, tendencia.c e controle.c) num relógio virtual, sem SDK nem hardware,
+// a partir de um traço CSV gravado ou de um traço sintético. Gera a linha
+// do tempo do status exibido, níveis dos atuadores e eventos de alarme, e
+// pode compará-la com um arquivo de referência (golden). A referência do
+// traço sintético de 48 h fica em tools/golden/sintetico_48h.csv.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -o replay tools/replay.c include/controle.c include/calibracao.c
+//       include/zonas.c include/excursoes.c include/tendencia.c include/botoes.c -lm
+//
+// Uso:
+//   replay [--traco arquivo.csv | --sintetico horas] [--menu n]
+//          [--intervalo s] [--saida arquivo] [--golden arquivo]
+//   replay --help
+//
+// Traço CSV (linhas com '#' são comentários), valores mantidos até a
+// próxima linha:
+//   tempo_ms,adc_etileno,adc_umidade,botoes
+// adc_* são contagens de 0 a 4095 como lidas pelo ADC (etileno/CO₂ e
+// temperatura/umidade compartilham o potenciômetro, como no firmware) e
+// botoes é a máscara bruta (bit 0 = NEXT, 1 = BACK, 2 = SET).
+//
+// Linha do tempo (CSV):
+//   T,tempo_ms,menu,zona,valor,status,motor_r,motor_b,r,g,b   (a cada --intervalo)
+//   E,tempo_ms,tipo,detalhe                                  (eventos)
+//===============================================
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "botoes.h"
+#include "calibracao.h"
+#include "controle.h"
+#include "excursoes.h"
+#include "zonas.h"
+
+#define PASSO_BOTOES_MS 5        // Mesmo período do amostrador do firmware
+#define PERIODO_AMOSTRA_MS 50    // Modo ativo (tela acesa)
+#define MAX_LINHAS_TRACO 1000000
+#define FILA_EVENTOS 32
+
+typedef struct {
+    uint32_t tempo_ms;
+    uint16_t adc_etileno;
+    uint16_t adc_umidade;
+    uint8_t botoes;
+} linha_traco_t;
+
+static linha_traco_t *traco;
+static size_t traco_n;
+
+// Eventos de botão emitidos durante uma amostra do relógio virtual
+static evento_botao_t fila[FILA_EVENTOS];
+static int fila_n;
+
+static void receber_evento(const evento_botao_t *ev) {
+    if (fila_n < FILA_EVENTOS)
+        fila[fila_n++] = *ev;
+}
+
+static void sair_erro(const char *msg, const char *arg) {
+    fprintf(stderr, "replay: %s%s%s\n", msg, arg ? ": " : "", arg ? arg : "");
+    exit(2);
+}
+
+static const char USO[] =
+    "uso: replay [--traco arquivo.csv | --sintetico horas] [--menu n]\n"
+    "            [--intervalo s] [--saida arquivo] [--golden arquivo]\n"
+    "  --traco       traço CSV tempo_ms,adc_etileno,adc_umidade,botoes\n"
+    "  --sintetico   traço sintético de câmara fria com essa duração (padrão 48 h)\n"
+    "  --menu        menu inicial (0 a 6)\n"
+    "  --intervalo   segundos entre linhas T da linha do tempo (padrão 60)\n"
+    "  --saida       grava a linha do tempo no arquivo em vez de stdout\n"
+    "  --golden      compara com a referência; código 1 na primeira divergência\n"
+    "  --help, -h    mostra esta ajuda\n";
+
+static void adicionar_linha(uint32_t t, uint16_t et, uint16_t um, uint8_t bt) {
+    if (traco_n >= MAX_LINHAS_TRACO)
+        sair_erro("traço longo demais", NULL);
+    traco[traco_n++] = (linha_traco_t){t, et, um, bt};
+}
+
+static void carregar_traco(const char *caminho) {
+    FILE *f = fopen(caminho, "r");
+    if (!f)
+        sair_erro("não foi possível abrir o traço", caminho);
+    char linha[128];
+    unsigned long n = 0;
+    uint32_t anterior = 0;
+    while (fgets(linha, sizeof(linha), f)) {
+        n++;
+        if (linha[0] == '#' || linha[0] == '\n' || linha[0] == '\r')
+            continue;
+        unsigned long t;
+        unsigned et, um, bt;
+        if (sscanf(linha, "%lu,%u,%u,%u", &t, &et, &um, &bt) != 4 || et > CAL_ADC_MAX || um > CAL_ADC_MAX ||
+            bt > 0xff || (traco_n > 0 && t < anterior)) {
+            fprintf(stderr, "replay: %s:%lu: linha inválida\n", caminho, n);
+            exit(2);
+        }
+        anterior = (uint32_t)t;
+        adicionar_linha((uint32_t)t, (uint16_t)et, (uint16_t)um, (uint8_t)bt);
+    }
+    fclose(f);
+    if (traco_n == 0)
+        sair_erro("traço vazio", caminho);
+}
+
+static uint16_t para_adc(float valor, float fundo) {
+    float c = valor / fundo * CAL_ADC_MAX;
+    if (c < 0)
+        c = 0;
+    if (c > CAL_ADC_MAX)
+        c = CAL_ADC_MAX;
+    return (uint16_t)lroundf(c);
+}
+
+// Traço sintético de câmara fria: ciclo diário de temperatura com
+// aberturas de porta, etileno subindo com o amadurecimento e uma volta
+// pelos menus de sensor a cada 6 h (pressão de NEXT de 100 ms)
+static void gerar_sintetico(double horas) {
+    const uint32_t passo_ms = 1000;
+    uint32_t fim = (uint32_t)(horas * 3600000.0);
+    uint32_t seis_horas = 6u * 3600000u;
+    for (uint32_t t = 0; t <= fim; t += passo_ms) {
+        double h = t / 3600000.0;
+        double temp = 12.5 + 3.0 * sin(2.0 * M_PI * h / 24.0);
+        if (fmod(h, 8.0) < 0.25)
+            temp += 6.0;   // Porta aberta
+        double etileno = 1.0 + 8.0 * (h / (horas > 0 ? horas : 1.0));
+        uint8_t botoes = (t % seis_horas >= 3600000u && t % seis_horas < 3600100u) ? BOTAO_BIT(BOTAO_IDX_NEXT) : 0;
+        // Fundos de escala das tabelas padrão: etileno 10 ppm, temperatura 40 °C
+        adicionar_linha(t, para_adc((float)etileno, 10.0f), para_adc((float)temp, 40.0f), botoes);
+    }
+}
+
+static double segundos_monotonicos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+int main(int argc, char **argv) {
+    const char *caminho_traco = NULL, *caminho_saida = NULL, *caminho_golden = NULL;
+    double horas_sinteticas = 0;
+    int menu_inicial = 0;
+    uint32_t intervalo_ms = 60000;
+
+    for (int i = 1; i < argc; i++) {
+        const char *a = argv[i];
+        // Opções sem valor antes de exigir argv[i + 1]
+        if (!strcmp(a, "--help") || !strcmp(a, "-h")) {
+            fputs(USO, stdout);
+            return 0;
+        }
+        if (strncmp(a, "--", 2) != 0)
+            sair_erro("opção desconhecida", a);
+        const char *v = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (!v)
+            sair_erro("argumento sem valor", a);
+        if (!strcmp(a, "--traco"))
+            caminho_traco = v;
+        else if (!strcmp(a, "--sintetico"))
+            horas_sinteticas = atof(v);
+        else if (!strcmp(a, "--menu"))
+            menu_inicial = atoi(v);
+        else if (!strcmp(a, "--intervalo"))
+            intervalo_ms = (uint32_t)(atof(v) * 1000.0);
+        else if (!strcmp(a, "--saida"))
+            caminho_saida = v;
+        else if (!strcmp(a, "--golden"))
+            caminho_golden = v;
+        else
+            sair_erro("opção desconhecida", a);
+        i++;
+    }
+    if (!caminho_traco && horas_sinteticas <= 0)
+        horas_sinteticas = 48;
+    if (menu_inicial < 0 || menu_inicial >= NUM_MENUS || intervalo_ms == 0)
+        sair_erro("--menu ou --intervalo fora da faixa", NULL);
+
+    traco = malloc(MAX_LINHAS_TRACO * sizeof(*traco));
+    if (!traco)
+        sair_erro("sem memória", NULL);
+    if (caminho_traco)
+        carregar_traco(caminho_traco);
+    else
+        gerar_sintetico(horas_sinteticas);
+
+    // Sem --saida a linha do tempo vai para stdout, ou só para a comparação
+    FILE *saida = stdout;
+    if (caminho_saida)
+        saida = fopen(caminho_saida, "w+");
+    else if (caminho_golden)
+        saida = tmpfile();
+    if (!saida)
+        sair_erro("não foi possível criar a saída", caminho_saida);
+
+    // Mesma inicialização do firmware após uma partida a frio
+    static zonas_t zonas;
+    static excursoes_t excursoes;
+    static controle_t controle;
+    static botoes_t botoes;
+    config_t cfg;
+    calibracao_init();
+    controle_config_padrao(&cfg);
+    cfg.menu_index = menu_inicial;
+    zonas_init(&zonas, NULL);
+    excursoes_init(&excursoes, NULL);
+    controle_init(&controle);
+    botoes_init(&botoes, 3, BOTAO_BIT(BOTAO_IDX_NEXT) | BOTAO_BIT(BOTAO_IDX_BACK), receber_evento);
+
+    const char *status_anterior = NULL;
+    bool alarme = false, alerta_precoce = false;
+    uint32_t inicio_alarme = 0, tempo_em_alarme = 0;
+    unsigned long amostras = 0, beeps = 0, alarmes = 0, alertas = 0;
+    size_t linha = 0;
+    uint32_t fim_ms = traco[traco_n - 1].tempo_ms;
+    uint32_t proxima_amostra = 0, proximo_registro = 0;
+
+    double inicio = segundos_monotonicos();
+    for (uint32_t t = 0; t <= fim_ms; t += PASSO_BOTOES_MS) {
+        while (linha + 1 < traco_n && traco[linha + 1].tempo_ms <= t)
+            linha++;
+        const linha_traco_t *l = &traco[linha];
+
+        // Entrada: os eventos são aplicados antes da amostra, como no laço principal
+        fila_n = 0;
+        botoes_amostrar(&botoes, l->botoes, t);
+        for (int i = 0; i < fila_n; i++) {
+            config_t antes = cfg;
+            if (controle_aplicar_evento(&controle, &cfg, &fila[i]) == CONTROLE_INICIAR_CALIBRACAO)
+                fprintf(saida, "E,%u,calibracao,%d\n", t, cfg.menu_index);
+            if (cfg.menu_index != antes.menu_index || cfg.zona_atual != antes.zona_atual)
+                fprintf(saida, "E,%u,menu,%d/%d\n", t, cfg.menu_index, cfg.zona_atual);
+            if (cfg.in_set_mode != antes.in_set_mode)
+                fprintf(saida, "E,%u,%s,%.2f\n", t, cfg.in_set_mode ? "edicao" : "fim_edicao",
+                        controle_setpoint_em_edicao(&antes));
+            else if (cfg.in_set_mode && (cfg.current_set_param != antes.current_set_param ||
+                                         memcmp(&cfg.limites, &antes.limites, sizeof(cfg.limites)) != 0))
+                fprintf(saida, "E,%u,setpoint,%.2f\n", t, controle_setpoint_em_edicao(&cfg));
+        }
+        if (t < proxima_amostra && fila_n == 0)
+            continue;
+
+        proxima_amostra = t + PERIODO_AMOSTRA_MS;
+        for (uint8_t z = 0; z < NUM_ZONAS; z++) {
+            // Zonas extras repetem a zona 0: o traço tem um só conjunto de canais
+            zonas.valor[CAL_ETILENO][z] = calibracao_converter(CAL_ETILENO, l->adc_etileno);
+            zonas.valor[CAL_TEMP][z] = calibracao_converter(CAL_TEMP, l->adc_umidade);
+            zonas.valor[CAL_UMIDADE][z] = calibracao_converter(CAL_UMIDADE, l->adc_umidade);
+            zonas.valor[CAL_CO2][z] = calibracao_converter(CAL_CO2, l->adc_etileno);
+        }
+        zonas_processar(&zonas, &cfg.limites, NUM_ZONAS);
+        excursoes_processar(&excursoes, &zonas, &cfg.limites, NUM_ZONAS, t);
+        controle_saida_t s;
+        controle_amostrar(&controle, &cfg, &zonas, t, &s);
+        amostras++;
+
+        if (controle.alerta_precoce != alerta_precoce) {
+            fprintf(saida, "E,%u,alerta_precoce,%d\n", t, controle.alerta_precoce);
+            alerta_precoce = controle.alerta_precoce;
+            if (alerta_precoce)
+                alertas++;
+        }
+        if (status_anterior == NULL || strcmp(s.status, status_anterior) != 0)
+            fprintf(saida, "E,%u,status,%s\n", t, s.status);
+        status_anterior = s.status;
+        if (s.beep)
+            beeps++;
+        if (s.beep != alarme) {
+            fprintf(saida, "E,%u,%s,%.2f\n", t, s.beep ? "alarme_inicio" : "alarme_fim", s.valor);
+            if (s.beep) {
+                alarmes++;
+                inicio_alarme = t;
+            } else {
+                tempo_em_alarme += t - inicio_alarme;
+            }
+            alarme = s.beep;
+        }
+        if (t >= proximo_registro) {
+            proximo_registro = t + intervalo_ms;
+            fprintf(saida, "T,%u,%d,%d,%.2f,%s,%d,%d,%u,%u,%u\n", t, cfg.menu_index, cfg.zona_atual, s.valor,
+                    s.status, s.motor_r, s.motor_b, s.r, s.g, s.b);
+        }
+    }
+    if (alarme)
+        tempo_em_alarme += fim_ms - inicio_alarme;
+    double decorrido = segundos_monotonicos() - inicio;
+
+    double horas = fim_ms / 3600000.0;
+    fprintf(stderr, "simulado: %.2f h, %lu amostras em %.3f s (%.0f h/s, %.0fx tempo real)\n", horas, amostras,
+            decorrido, horas / decorrido, fim_ms / 1000.0 / decorrido);
+    fprintf(stderr, "alarmes: %lu (%.1f min, %lu amostras com beep), alertas precoces: %lu\n", alarmes,
+            tempo_em_alarme / 60000.0, beeps, alertas);
+    fprintf(stderr, "médias zona 0: etileno %.2f ppm, temp %.2f °C, umidade %.1f %%, CO2 %.0f ppm\n",
+            zonas_media(&zonas, CAL_ETILENO, 0), zonas_media(&zonas, CAL_TEMP, 0),
+            zonas_media(&zonas, CAL_UMIDADE, 0), zonas_media(&zonas, CAL_CO2, 0));
+    fprintf(stderr, "excursões zona 0: temp %.1f grau-min em %u (%.1f min fora), etileno %.1f min fora em %u\n",
+            excursoes_unidade_minuto(&excursoes, CAL_TEMP, 0), excursoes.contagem[CAL_TEMP][0],
+            excursoes.tempo_fora_ms[CAL_TEMP][0] / 60000.0, excursoes.tempo_fora_ms[CAL_ETILENO][0] / 60000.0,
+            excursoes.contagem[CAL_ETILENO][0]);
+
+    int resultado = 0;
+    if (caminho_golden) {
+        // Compara linha a linha; a primeira divergência encerra com código 1
+        FILE *g = fopen(caminho_golden, "r");
+        if (!g)
+            sair_erro("não foi possível abrir o golden", caminho_golden);
+        rewind(saida);
+        char esperado[160], obtido[160];
+        unsigned long n = 0;
+        for (;;) {
+            char *pe = fgets(esperado, sizeof(esperado), g);
+            char *po = fgets(obtido, sizeof(obtido), saida);
+            n++;
+            if (!pe && !po)
+                break;
+            if (!pe || !po || strcmp(esperado, obtido) != 0) {
+                fprintf(stderr, "golden: divergência na linha %lu\n  esperado: %s  obtido:   %s", n,
+                        pe ? esperado : "(fim)\n", po ? obtido : "(fim)\n");
+                resultado = 1;
+                break;
+            }
+        }
+        fclose(g);
+        if (resultado == 0)
+            fprintf(stderr, "golden: %lu linhas idênticas\n", n - 1);
+    }
+    if (saida != stdout)
+        fclose(saida);
+    free(traco);
+    return resultado;
+}
@@ -0,0 +1,116 @@
+//===============================================
+// Custo de zonas_processar de 1 a 32 zonas (host)
+//
+// Versão de computador do bench_zonas do firmware: compila o núcleo com
+// NUM_ZONAS = ZONAS_MAX e mede um ciclo de processamento para cada
+// número de zonas, em ns por ciclo e ns por zona (melhor de várias
+// rodadas, para descontar interrupções do sistema). As medidas alternam
+// entre abaixo, dentro e acima da faixa, como no firmware, e o estado e
+// as estatísticas resultantes são conferidos contra o valor esperado.
+//
+// Compilação:
+//   gcc -O2 -Iinclude -DNUM_ZONAS=32 -o zonas_bench tools/zonas_bench.c include/zonas.c
+//
+// Uso: zonas_bench [ciclos por rodada]   (código 1 se o resultado estiver errado)
+//===============================================
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "zonas.h"
+
+#if NUM_ZONAS != ZONAS_MAX
+#error "Compile com -DNUM_ZONAS=32 para varrer todas as zonas"
+#endif
+
+#define RODADAS 7
+#define CICLOS_CONFERENCIA 100   // Somas exatas em float
+
+static zonas_t zonas;
+static zona_limites_t limites;
+static int falhas;
+
+static double agora_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+// Mesmo padrão do firmware: 5 (abaixo), 15 (dentro) ou 25 (acima) de 10..20
+static float medida(int s, int z) {
+    return (float)((s + z) % 3) * 10.0f + 5.0f;
+}
+
+static void preparar(void) {
+    zonas_init(&zonas, NULL);
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++)
+        for (int z = 0; z < NUM_ZONAS; z++)
+            zonas.valor[s][z] = medida(s, z);
+}
+
+// Roda alguns ciclos com n zonas e confere estado e estatísticas de todas
+static void conferir(int n) {
+    preparar();
+    for (int c = 0; c < CICLOS_CONFERENCIA; c++)
+        zonas_processar(&zonas, &limites, (uint8_t)n);
+    for (int z = 0; z < NUM_ZONAS; z++) {
+        uint16_t esperado = 0;
+        for (int s = 0; s < ZONA_NUM_SENSORES && z < n; s++) {
+            float v = medida(s, z);
+            if (v < 10.0f) esperado |= ZONA_ABAIXO(s);
+            if (v > 20.0f) esperado |= ZONA_ACIMA(s);
+        }
+        // Zonas além de n não são tocadas (o estado foi zerado no início)
+        bool ok = zonas.estado[z] == esperado;
+        for (int s = 0; s < ZONA_NUM_SENSORES && ok; s++) {
+            float v = medida(s, z);
+            ok = z < n ? zonas.estatisticas.soma[s][z] == v * CICLOS_CONFERENCIA &&
+                             zonas.estatisticas.minimo[s][z] == v && zonas.estatisticas.maximo[s][z] == v
+                       : zonas.estatisticas.soma[s][z] == 0.0f;
+        }
+        if (!ok) {
+            printf("  zonas %2d: estado ou estatística errada na zona %d\n", n, z);
+            falhas++;
+            return;
+        }
+    }
+}
+
+int main(int argc, char **argv) {
+    uint32_t ciclos = argc > 1 ? (uint32_t)strtoul(argv[1], NULL, 0) : 20000;
+    if (ciclos == 0)
+        ciclos = 1;
+
+    for (int s = 0; s < ZONA_NUM_SENSORES; s++) {
+        for (int z = 0; z < NUM_ZONAS; z++) {
+            limites.inferior[s][z] = 10.0f;
+            limites.superior[s][z] = 20.0f;
+        }
+    }
+
+    printf("%5s %12s %10s\n", "zonas", "ns/ciclo", "ns/zona");
+    double primeira = 0, ultima = 0;
+    for (int n = 1; n <= NUM_ZONAS; n++) {
+        double melhor = 0;
+        for (int r = 0; r < RODADAS; r++) {
+            preparar();
+            double inicio = agora_ns();
+            for (uint32_t c = 0; c < ciclos; c++)
+                zonas_processar(&zonas, &limites, (uint8_t)n);
+            double ns = (agora_ns() - inicio) / ciclos;
+            if (r == 0 || ns < melhor)
+                melhor = ns;
+        }
+        conferir(n);
+        printf("%5d %12.1f %10.2f\n", n, melhor, melhor / n);
+        if (n == 1)
+            primeira = melhor;
+        ultima = melhor;
+    }
+    // O custo fixo (laço de sensores, memset) dilui com mais zonas
+    printf("32 zonas custam %.1fx uma zona\n", ultima / primeira);
+
+    printf("%s: %d falha(s)\n", falhas ? "FALHOU" : "OK", falhas);
+    return falhas ? 1 : 0;
+}